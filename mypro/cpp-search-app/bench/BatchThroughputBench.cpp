@@ -0,0 +1,101 @@
+// Headless batch throughput benchmark
+//
+// Builds a QueryIndex over a synthetic corpus in memory and pushes a query
+// stream through BatchSearch, the same path as CPPSearchCli / --no-gui.
+// Prints one JSON object per corpus size:
+//   {"benchmark":"batch_queries","corpus":1000000,"queries":..,"qps":..,"index_ms":..}
+//
+// The query mix is exact questions, word fragments, long queries that contain
+// a question, misses, and repeats.
+//
+// Usage: BatchThroughputBench [--sizes 100000,1000000] [--queries 1000000] [--threads 0]
+
+#include <QBuffer>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <cstdio>
+
+#include "BatchSearch.h"
+#include "QueryIndex.h"
+#include "BenchCommon.h"
+
+namespace {
+
+QByteArray syntheticQueries(int corpus, int queries) {
+    QByteArray input;
+    input.reserve(qint64(queries) * 32);
+    quint32 state = 2463534242u;
+    auto next = [&state]() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    };
+    for (int q = 0; q < queries; ++q) {
+        const int entry = int(next() % quint32(corpus));
+        switch (next() % 5) {
+        case 0: input += bench::syntheticQuestion(entry).toUtf8(); break;
+        case 1: input += QByteArray(bench::kWords[entry % bench::kWordCount]) + ' ' + QByteArray::number(entry); break;
+        case 2: input += "tell me " + bench::syntheticQuestion(entry).toUtf8() + " please"; break;
+        case 3: input += "zz no match " + QByteArray::number(entry); break;
+        default: input += "what is " + QByteArray(bench::kWords[entry % bench::kWordCount]); break;
+        }
+        input += '\n';
+    }
+    return input;
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Headless batch query throughput benchmark");
+    parser.addHelpOption();
+    QCommandLineOption sizesOption("sizes", "Comma-separated corpus sizes", "list", "100000,1000000");
+    QCommandLineOption queriesOption("queries", "Queries per run", "count", "1000000");
+    QCommandLineOption threadsOption("threads", "Worker threads (0 = one per core)", "count", "0");
+    parser.addOption(sizesOption);
+    parser.addOption(queriesOption);
+    parser.addOption(threadsOption);
+    parser.process(app);
+
+    const int queries = qMax(1, parser.value(queriesOption).toInt());
+    for (const QString& size : parser.value(sizesOption).split(',', Qt::SkipEmptyParts)) {
+        const int corpus = qMax(1, size.toInt());
+
+        QElapsedTimer timer;
+        timer.start();
+        QueryIndex index;
+        index.build(bench::syntheticCorpus(corpus));
+        const qint64 indexMs = timer.elapsed();
+
+        QByteArray inputData = syntheticQueries(corpus, queries);
+        QBuffer input(&inputData);
+        input.open(QIODevice::ReadOnly);
+        QByteArray outputData;
+        QBuffer output(&outputData);
+        output.open(QIODevice::WriteOnly);
+
+        BatchSearch batch(index);
+        batch.setThreadCount(parser.value(threadsOption).toInt());
+        batch.run(&input, &output);
+
+        QJsonObject row;
+        row["benchmark"] = "batch_queries";
+        row["corpus"] = corpus;
+        row["queries"] = double(batch.stats().queries);
+        row["unique"] = double(batch.stats().uniqueQueries);
+        row["qps"] = batch.stats().queriesPerSecond();
+        row["index_ms"] = double(indexMs);
+        row["output_mb"] = outputData.size() / 1e6;
+        std::fputs(QJsonDocument(row).toJson(QJsonDocument::Compact).constData(), stdout);
+        std::fputc('\n', stdout);
+        std::fflush(stdout);
+    }
+    return 0;
+}
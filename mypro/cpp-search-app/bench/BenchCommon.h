@@ -0,0 +1,69 @@
+#pragma once
+
+// Helpers shared by the benchmarks
+// - percentile() works on any sorted container, so the plain POSIX clients
+//   (ServeLatencyBench, HttpLoadBench) use it without Qt
+// - The synthetic corpus needs QtCore and is only there when the target
+//   links it (QT_CORE_LIB comes with Qt6::Core)
+
+#include <algorithm>
+#include <cstddef>
+
+#ifdef QT_CORE_LIB
+#include <QString>
+#include <QUrl>
+#include <QVector>
+#include "SearchResult.h"
+#endif
+
+namespace bench {
+
+// Nearest-rank percentile p (0-100) of a sorted, non-empty container
+template <typename Container>
+double percentile(const Container& sorted, double p) {
+    const size_t last = size_t(sorted.size()) - 1;
+    return double(sorted[std::min(last, size_t(p / 100.0 * double(last) + 0.5))]);
+}
+
+#ifdef QT_CORE_LIB
+
+inline constexpr const char* kWords[] = {
+    "quantum", "river", "lattice", "ember", "signal", "harbor", "cipher", "meadow",
+    "vector", "summit", "prism", "canyon", "orbit", "falcon", "glacier", "beacon"
+};
+inline constexpr int kWordCount = int(sizeof(kWords) / sizeof(kWords[0]));
+
+// "<word> <word> <i>", distinct for every i
+inline QString syntheticQuery(int i) {
+    return QString("%1 %2 %3")
+        .arg(QLatin1String(kWords[i % kWordCount]))
+        .arg(QLatin1String(kWords[(i / kWordCount) % kWordCount]))
+        .arg(i);
+}
+
+inline QString syntheticQuestion(int i) {
+    return QLatin1String("what is ") + syntheticQuery(i);
+}
+
+inline QString syntheticAnswer(int i) {
+    return QString("Synthetic answer %1 about %2.").arg(i).arg(QLatin1String(kWords[i % kWordCount]));
+}
+
+// The corpus as QueryIndex::build takes it
+inline QVector<SearchResult> syntheticCorpus(int entries) {
+    QVector<SearchResult> corpus;
+    corpus.reserve(entries);
+    for (int i = 0; i < entries; ++i) {
+        SearchResult result;
+        result.title = syntheticQuestion(i);
+        result.description = syntheticAnswer(i);
+        result.url = QUrl("offline://synthetic");
+        result.snippetLength = SearchResult::snippetBoundary(result.description);
+        corpus.append(result);
+    }
+    return corpus;
+}
+
+#endif
+
+}
@@ -0,0 +1,146 @@
+// Search history benchmark
+//
+// Fills SearchHistory with N distinct queries, then times addSearch (repeat
+// and new queries, including the log append) and getSuggestions for short
+// prefixes. History goes to a throw-away directory (QStandardPaths test mode).
+// Prints one JSON object per size:
+//   {"benchmark":"search_history","retained":100000,"add_ns":..,"suggest_us":..,"startup_ms":..}
+//
+// --store-sizes writes a history.store of N distinct queries directly (in
+// chunks, the way compaction grows it) and times a cold start and prefix
+// suggestions against it:
+//   {"benchmark":"history_store","stored":10000000,"startup_ms":..,"suggest_us":..}
+//
+// Usage: HistoryBench [--sizes 1000,100000] [--ops 100000] [--store-sizes 10000000]
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <climits>
+#include <cstdio>
+
+#include "HistoryStore.h"
+#include "SearchHistory.h"
+#include "BenchCommon.h"
+
+namespace {
+
+void printRow(const QJsonObject& row) {
+    std::fputs(QJsonDocument(row).toJson(QJsonDocument::Compact).constData(), stdout);
+    std::fputc('\n', stdout);
+    std::fflush(stdout);
+}
+
+double timeSuggestions(const SearchHistory& history, int lookups, int* found) {
+    QElapsedTimer timer;
+    timer.start();
+    *found = 0;
+    for (int i = 0; i < lookups; ++i) {
+        *found += int(history.getSuggestions(QLatin1String(bench::kWords[i % bench::kWordCount]).left(1 + i % 4)).size());
+    }
+    return double(timer.nsecsElapsed()) / lookups / 1000.0;
+}
+
+// Grows the store a million queries at a time, as repeated compactions would
+bool writeStore(const QString& path, int stored) {
+    constexpr int kChunk = 1000000;
+    const qint64 epoch = QDateTime::currentMSecsSinceEpoch() - qint64(stored);
+    for (int begin = 0; begin < stored; begin += kChunk) {
+        QVector<HistoryLog::Record> records;
+        const int end = qMin(stored, begin + kChunk);
+        records.reserve(end - begin);
+        for (int i = begin; i < end; ++i) records.append({epoch + i, 1 + i % 3, bench::syntheticQuery(i)});
+
+        HistoryStore base;
+        QSaveFile file(path);
+        if (!base.open(path) || !file.open(QIODevice::WriteOnly)
+            || !HistoryStore::write(file, base, records, 0)) {
+            return false;
+        }
+        base.close();
+        if (!file.commit()) return false;
+    }
+    return true;
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    app.setOrganizationName("Imilya");
+    app.setApplicationName("Imilya Minds History Bench");
+    QStandardPaths::setTestModeEnabled(true);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Search history add/suggest benchmark");
+    parser.addHelpOption();
+    QCommandLineOption sizesOption("sizes", "Comma-separated retained history sizes", "list", "1000,100000");
+    QCommandLineOption opsOption("ops", "Timed operations per measurement", "count", "100000");
+    QCommandLineOption storeSizesOption("store-sizes", "Comma-separated history store sizes", "list");
+    parser.addOption(sizesOption);
+    parser.addOption(opsOption);
+    parser.addOption(storeSizesOption);
+    parser.process(app);
+
+    const int ops = qMax(1, parser.value(opsOption).toInt());
+    for (const QString& size : parser.value(sizesOption).split(',', Qt::SkipEmptyParts)) {
+        const int retained = qMax(1, size.toInt());
+        QDir(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)).removeRecursively();
+
+        QJsonObject row;
+        row["benchmark"] = "search_history";
+        row["retained"] = retained;
+        {
+            SearchHistory history;
+            for (int i = 0; i < retained; ++i) history.addSearch(bench::syntheticQuery(i));
+
+            QElapsedTimer timer;
+            timer.start();
+            for (int i = 0; i < ops; ++i) history.addSearch(bench::syntheticQuery((i * 7919) % retained));
+            row["add_ns"] = double(timer.nsecsElapsed()) / ops;
+
+            const int lookups = qMax(1, ops / 100);
+            int found = 0;
+            row["suggest_us"] = timeSuggestions(history, lookups, &found);
+            row["suggestions"] = found / lookups;
+        }
+        // The destructor above committed the log; time a cold start from it
+        QElapsedTimer timer;
+        timer.start();
+        SearchHistory reloaded;
+        row["startup_ms"] = double(timer.nsecsElapsed()) / 1e6;
+        row["reloaded"] = reloaded.getRecentSearches(INT_MAX).size();
+        printRow(row);
+    }
+
+    for (const QString& size : parser.value(storeSizesOption).split(',', Qt::SkipEmptyParts)) {
+        const int stored = qMax(1, size.toInt());
+        const QString dataDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+        QDir(dataDir).removeRecursively();
+        QDir().mkpath(dataDir);
+        if (!writeStore(dataDir + "/history.store", stored)) {
+            std::fprintf(stderr, "failed to write a history store of %d queries\n", stored);
+            continue;
+        }
+
+        QJsonObject row;
+        row["benchmark"] = "history_store";
+        row["stored"] = stored;
+        QElapsedTimer timer;
+        timer.start();
+        SearchHistory history;
+        row["startup_ms"] = double(timer.nsecsElapsed()) / 1e6;
+        const int lookups = qMax(1, ops / 100);
+        int found = 0;
+        row["suggest_us"] = timeSuggestions(history, lookups, &found);
+        row["suggestions"] = found / lookups;
+        printRow(row);
+    }
+    return 0;
+}
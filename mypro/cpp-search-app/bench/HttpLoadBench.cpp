@@ -0,0 +1,157 @@
+// Closed-loop HTTP load generator for the --http endpoint
+//
+// Qt-free: POSIX sockets and std::thread. Every connection is keep-alive and
+// sends its next request as soon as the previous response is in, cycling
+// through /search, /suggest and /answer requests. Prints one JSON object:
+//   {"benchmark":"http_load","connections":64,"seconds":10,"requests":..,
+//    "qps":..,"p50_us":..,"p99_us":..,"max_us":..,"shed":..,"errors":..}
+// "shed" counts 503 responses, i.e. admission control at work.
+//
+// Usage: HttpLoadBench [--port 8080] [--connections 64] [--seconds 10]
+//                      [--path "/search?q=what+is+qt"]...
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "BenchCommon.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Worker {
+    std::vector<double> latencies;
+    long shed = 0;
+    long errors = 0;
+};
+
+int connectTo(int port) {
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(uint16_t(port));
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    const int on = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Reads one response into buffer; returns the status code, or -1
+int readResponse(int fd, std::string& buffer) {
+    char chunk[16384];
+    size_t headerEnd;
+    while ((headerEnd = buffer.find("\r\n\r\n")) == std::string::npos) {
+        const ssize_t received = ::read(fd, chunk, sizeof(chunk));
+        if (received <= 0) return -1;
+        buffer.append(chunk, size_t(received));
+    }
+    const int status = std::atoi(buffer.c_str() + std::strlen("HTTP/1.1 "));
+    size_t length = 0;
+    const size_t field = buffer.find("Content-Length: ");
+    if (field != std::string::npos && field < headerEnd) {
+        length = size_t(std::atol(buffer.c_str() + field + std::strlen("Content-Length: ")));
+    }
+    const size_t total = headerEnd + 4 + length;
+    while (buffer.size() < total) {
+        const ssize_t received = ::read(fd, chunk, sizeof(chunk));
+        if (received <= 0) return -1;
+        buffer.append(chunk, size_t(received));
+    }
+    buffer.erase(0, total);
+    return status;
+}
+
+void runConnection(int port, const std::vector<std::string>& paths, size_t first,
+                   Clock::time_point deadline, Worker& worker) {
+    int fd = connectTo(port);
+    std::string buffer;
+    for (size_t i = first; Clock::now() < deadline; ++i) {
+        if (fd < 0 && (fd = connectTo(port)) < 0) {
+            ++worker.errors;
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            continue;
+        }
+        const std::string request = "GET " + paths[i % paths.size()] + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+        const Clock::time_point start = Clock::now();
+        int status = -1;
+        if (::write(fd, request.data(), request.size()) == ssize_t(request.size())) {
+            status = readResponse(fd, buffer);
+        }
+        if (status < 0) {
+            // Server closed on us; reconnect and carry on
+            ++worker.errors;
+            ::close(fd);
+            fd = -1;
+            buffer.clear();
+            continue;
+        }
+        if (status == 503) ++worker.shed;
+        else if (status != 200) ++worker.errors;
+        else worker.latencies.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+    }
+    if (fd >= 0) ::close(fd);
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    int port = 8080;
+    int connections = 64;
+    int seconds = 10;
+    std::vector<std::string> paths;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--port") == 0) port = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--connections") == 0) connections = std::max(1, std::atoi(argv[i + 1]));
+        else if (std::strcmp(argv[i], "--seconds") == 0) seconds = std::max(1, std::atoi(argv[i + 1]));
+        else if (std::strcmp(argv[i], "--path") == 0) paths.push_back(argv[i + 1]);
+    }
+    if (paths.empty()) {
+        paths = {"/search?q=what+is+qt", "/search?q=how+to+learn+programming", "/suggest?q=what",
+                 "/search?q=tell+me+about+the+history+of+c%2B%2B", "/answer/0", "/search?q=no+such+question"};
+    }
+
+    std::vector<Worker> workers(static_cast<size_t>(connections));
+    std::vector<std::thread> threads;
+    const Clock::time_point start = Clock::now();
+    const Clock::time_point deadline = start + std::chrono::seconds(seconds);
+    for (int i = 0; i < connections; ++i) {
+        threads.emplace_back(runConnection, port, std::cref(paths), size_t(i), deadline, std::ref(workers[size_t(i)]));
+    }
+    for (std::thread& thread : threads) thread.join();
+    const double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::vector<double> latencies;
+    long shed = 0;
+    long errors = 0;
+    for (const Worker& worker : workers) {
+        latencies.insert(latencies.end(), worker.latencies.begin(), worker.latencies.end());
+        shed += worker.shed;
+        errors += worker.errors;
+    }
+    if (latencies.empty()) {
+        std::fprintf(stderr, "no successful responses from port %d\n", port);
+        return 1;
+    }
+    std::sort(latencies.begin(), latencies.end());
+    std::printf("{\"benchmark\":\"http_load\",\"connections\":%d,\"seconds\":%d,\"requests\":%zu,\"qps\":%.0f,"
+                "\"p50_us\":%.1f,\"p99_us\":%.1f,\"max_us\":%.1f,\"shed\":%ld,\"errors\":%ld}\n",
+                connections, seconds, latencies.size(), double(latencies.size()) / elapsed,
+                bench::percentile(latencies, 50), bench::percentile(latencies, 99), latencies.back(), shed, errors);
+    return 0;
+}
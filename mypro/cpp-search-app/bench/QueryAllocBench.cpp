@@ -0,0 +1,190 @@
+// Steady-state allocation check for the query path
+//
+// Builds a QueryIndex over a synthetic corpus and answers a query mix the
+// way the --serve daemon does: UTF-8 payload decoded into a reused buffer,
+// QueryIndex::normalize into a reused buffer, QueryIndex::search into a
+// reused hits vector. After a warm-up pass, every further query must not
+// touch the heap.
+//
+// Allocations are counted by interposing operator new/delete and, on glibc,
+// malloc/calloc/realloc too: Qt's containers allocate through malloc, not
+// operator new. Counting is per thread, so only the measured loop is seen.
+// Prints one JSON object per corpus size and exits 1 if any query allocated:
+//   {"benchmark":"query_allocations","corpus":100000,"queries":..,"allocations":0,"ns_per_query":..}
+//
+// Usage: QueryAllocBench [--sizes 1000,100000] [--rounds 20]
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStringDecoder>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#include "QueryIndex.h"
+#include "BenchCommon.h"
+
+#if defined(__GLIBC__)
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* pointer, size_t size);
+void __libc_free(void* pointer);
+}
+#endif
+
+namespace {
+// Plain POD thread_local: reading it never allocates, even inside malloc
+thread_local unsigned long long t_allocations = 0;
+}
+
+#if defined(__GLIBC__)
+// operator new below goes through malloc, so this counts both
+extern "C" void* malloc(size_t size) {
+    ++t_allocations;
+    return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t count, size_t size) {
+    ++t_allocations;
+    return __libc_calloc(count, size);
+}
+
+extern "C" void* realloc(void* pointer, size_t size) {
+    ++t_allocations;
+    return __libc_realloc(pointer, size);
+}
+
+extern "C" void free(void* pointer) {
+    __libc_free(pointer);
+}
+#endif
+
+void* operator new(size_t size) {
+#if !defined(__GLIBC__)
+    ++t_allocations;
+#endif
+    if (void* pointer = std::malloc(size ? size : 1)) return pointer;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+#if !defined(__GLIBC__)
+    ++t_allocations;
+#endif
+    return std::malloc(size ? size : 1);
+}
+
+void* operator new[](size_t size, const std::nothrow_t& tag) noexcept {
+    return operator new(size, tag);
+}
+
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete[](void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, size_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, size_t) noexcept { std::free(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { std::free(pointer); }
+
+namespace {
+
+// Every path of QueryIndex::search: exact, trigram, short scan, contained,
+// misses, upper case and non-ASCII input, and queries longer than any
+// inline buffer would hold
+QVector<QByteArray> queryMix(int corpus) {
+    QVector<QByteArray> queries;
+    for (int i = 0; i < 64; ++i) {
+        const int entry = (i * 7919) % corpus;
+        queries.append(bench::syntheticQuestion(entry).toUtf8());
+        queries.append(QByteArray(bench::kWords[entry % bench::kWordCount]) + ' ' + QByteArray::number(entry));
+        queries.append("  tell me " + bench::syntheticQuestion(entry).toUtf8() + " please  ");
+        queries.append("zz no match " + QByteArray::number(entry));
+        queries.append(bench::syntheticQuestion(entry).toUpper().toUtf8());
+        queries.append(QString("QuÉstion %1 Über").arg(entry).toUtf8());
+        queries.append(QByteArray(bench::kWords[i % bench::kWordCount]).left(2));
+        queries.append(QByteArray("what is ").repeated(24) + bench::kWords[entry % bench::kWordCount]);
+    }
+    return queries;
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Checks that warm queries do not allocate");
+    parser.addHelpOption();
+    QCommandLineOption sizesOption("sizes", "Comma-separated corpus sizes", "list", "1000,100000");
+    QCommandLineOption roundsOption("rounds", "Passes over the query mix after warm-up", "count", "20");
+    parser.addOption(sizesOption);
+    parser.addOption(roundsOption);
+    parser.process(app);
+
+    const int rounds = qMax(1, parser.value(roundsOption).toInt());
+    bool clean = true;
+    for (const QString& size : parser.value(sizesOption).split(',', Qt::SkipEmptyParts)) {
+        const int corpus = qMax(1, size.toInt());
+        QueryIndex index;
+        index.build(bench::syntheticCorpus(corpus));
+        const QVector<QByteArray> queries = queryMix(corpus);
+
+        // The buffers QueryServer keeps across requests
+        QString text;
+        QString normalized;
+        QVector<QueryIndex::Hit> hits;
+        double checksum = 0.0;
+        auto answer = [&](const QByteArray& payload) {
+            QStringDecoder decoder(QStringDecoder::Utf8, QStringDecoder::Flag::Stateless);
+            text.resize(payload.size());
+            const QChar* end = decoder.appendToBuffer(text.data(), payload);
+            QueryIndex::normalize(QStringView(text.constData(), end - text.constData()), normalized);
+            index.search(normalized, 10, hits);
+            for (const QueryIndex::Hit& hit : hits) checksum += hit.score + index.entry(hit.entry).title.size();
+        };
+
+        for (int pass = 0; pass < 2; ++pass) {
+            for (const QByteArray& query : queries) answer(query);
+        }
+
+        int firstOffender = -1;
+        const unsigned long long before = t_allocations;
+        QElapsedTimer timer;
+        timer.start();
+        for (int round = 0; round < rounds; ++round) {
+            for (int q = 0; q < queries.size(); ++q) {
+                const unsigned long long start = t_allocations;
+                answer(queries.at(q));
+                if (firstOffender < 0 && t_allocations != start) firstOffender = q;
+            }
+        }
+        const qint64 elapsedNs = timer.nsecsElapsed();
+        const unsigned long long allocations = t_allocations - before;
+        const double answered = double(rounds) * queries.size();
+
+        QJsonObject row;
+        row["benchmark"] = "query_allocations";
+        row["corpus"] = corpus;
+        row["queries"] = answered;
+        row["allocations"] = double(allocations);
+        row["ns_per_query"] = elapsedNs / answered;
+        row["checksum"] = checksum;
+        std::fputs(QJsonDocument(row).toJson(QJsonDocument::Compact).constData(), stdout);
+        std::fputc('\n', stdout);
+        std::fflush(stdout);
+
+        if (allocations != 0) {
+            clean = false;
+            std::fprintf(stderr, "allocated while answering \"%s\" after warm-up\n",
+                         queries.at(qMax(0, firstOffender)).constData());
+        }
+    }
+    return clean ? 0 : 1;
+}
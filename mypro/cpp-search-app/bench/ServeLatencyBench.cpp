@@ -0,0 +1,144 @@
+// Round-trip benchmark for the --serve daemon
+//
+// Deliberately Qt-free: only POSIX sockets and ServeProtocol.h, exactly what
+// a non-Qt client of the daemon needs. Start a daemon first:
+//   ./bin/CPPSearchCli --serve /tmp/imilya.sock
+// Prints one JSON object per mode:
+//   {"benchmark":"serve_round_trip","depth":1,"requests":..,"p50_us":..,"p99_us":..,"max_us":..,"qps":..}
+// depth 1 is one request in flight (pure latency); larger depths pipeline.
+//
+// Usage: ServeLatencyBench [--socket /tmp/imilya.sock] [--requests 100000]
+//                          [--depth 32] [--query "what is qt"]...
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "ServeProtocol.h"
+#include "BenchCommon.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+bool writeAll(int fd, const char* data, size_t length) {
+    while (length > 0) {
+        const ssize_t written = ::write(fd, data, length);
+        if (written <= 0) return false;
+        data += written;
+        length -= size_t(written);
+    }
+    return true;
+}
+
+bool readAll(int fd, char* data, size_t length) {
+    while (length > 0) {
+        const ssize_t received = ::read(fd, data, length);
+        if (received <= 0) return false;
+        data += received;
+        length -= size_t(received);
+    }
+    return true;
+}
+
+std::string searchFrame(uint32_t id, const std::string& query) {
+    ServeProtocol::RequestHeader header{};
+    header.length = uint32_t(sizeof(header) - sizeof(uint32_t) + query.size());
+    header.id = id;
+    header.op = ServeProtocol::Search;
+    std::string frame(reinterpret_cast<const char*>(&header), sizeof(header));
+    return frame + query;
+}
+
+// Reads one response; returns its id, or -1 on a broken stream
+long readResponse(int fd, std::vector<char>& body) {
+    ServeProtocol::ResponseHeader header;
+    if (!readAll(fd, reinterpret_cast<char*>(&header), sizeof(header))) return -1;
+    body.resize(header.length - (sizeof(header) - sizeof(uint32_t)));
+    if (!body.empty() && !readAll(fd, body.data(), body.size())) return -1;
+    return long(header.id);
+}
+
+void run(const char* socketPath, const std::vector<std::string>& queries, int requests, int depth) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, socketPath, sizeof(address.sun_path) - 1);
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        std::fprintf(stderr, "cannot connect to %s\n", socketPath);
+        if (fd >= 0) ::close(fd);
+        return;
+    }
+
+    std::vector<std::string> frames;
+    for (size_t i = 0; i < queries.size(); ++i) frames.push_back(searchFrame(0, queries[i]));
+
+    std::vector<Clock::time_point> sent(static_cast<size_t>(requests));
+    std::vector<double> latencies;
+    latencies.reserve(size_t(requests));
+    std::vector<char> body;
+
+    const Clock::time_point start = Clock::now();
+    int next = 0;
+    int done = 0;
+    while (done < requests) {
+        // Keep up to depth requests in flight, sent in one write
+        std::string batch;
+        while (next < requests && next - done < depth) {
+            std::string frame = frames[size_t(next) % frames.size()];
+            const uint32_t id = uint32_t(next);
+            std::memcpy(&frame[sizeof(uint32_t)], &id, sizeof(id));
+            batch += frame;
+            sent[size_t(next)] = Clock::now();
+            ++next;
+        }
+        if (!batch.empty() && !writeAll(fd, batch.data(), batch.size())) break;
+
+        const long id = readResponse(fd, body);
+        if (id < 0 || id >= requests) break;
+        latencies.push_back(std::chrono::duration<double, std::micro>(Clock::now() - sent[size_t(id)]).count());
+        ++done;
+    }
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    ::close(fd);
+
+    if (latencies.empty()) {
+        std::fprintf(stderr, "no responses from %s\n", socketPath);
+        return;
+    }
+    std::sort(latencies.begin(), latencies.end());
+    std::printf("{\"benchmark\":\"serve_round_trip\",\"depth\":%d,\"requests\":%zu,"
+                "\"p50_us\":%.1f,\"p99_us\":%.1f,\"max_us\":%.1f,\"qps\":%.0f}\n",
+                depth, latencies.size(), bench::percentile(latencies, 50), bench::percentile(latencies, 99), latencies.back(),
+                double(latencies.size()) / seconds);
+    std::fflush(stdout);
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    const char* socketPath = "/tmp/imilya.sock";
+    int requests = 100000;
+    int depth = 32;
+    std::vector<std::string> queries;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--socket") == 0) socketPath = argv[i + 1];
+        else if (std::strcmp(argv[i], "--requests") == 0) requests = std::max(1, std::atoi(argv[i + 1]));
+        else if (std::strcmp(argv[i], "--depth") == 0) depth = std::max(1, std::atoi(argv[i + 1]));
+        else if (std::strcmp(argv[i], "--query") == 0) queries.push_back(argv[i + 1]);
+    }
+    if (queries.empty()) {
+        queries = {"what is qt", "how to learn programming", "tell me about the history of c++", "no such question"};
+    }
+
+    run(socketPath, queries, requests, 1);
+    if (depth > 1) run(socketPath, queries, requests, depth);
+    return 0;
+}
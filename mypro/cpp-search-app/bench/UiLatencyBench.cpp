@@ -0,0 +1,198 @@
+// Headless UI latency benchmark
+//
+// Runs MainWindow on the offscreen QPA platform against synthetic corpora
+// and drives it with QTest key/mouse events. Each measurement is printed as
+// one JSON object per line:
+//   {"benchmark":"enter_to_results_painted","corpus":100000,"samples":20,
+//    "p50_ms":..,"p90_ms":..,"p99_ms":..,"max_ms":..,"mean_ms":..}
+//
+// keystroke_to_suggestion includes MainWindow's suggestion debounce interval.
+//
+// Usage: UiLatencyBench [--sizes 1000,100000,1000000] [--samples 20]
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLineEdit>
+#include <QPushButton>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QTest>
+#include <QTextStream>
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+
+#include "BenchCommon.h"
+#include "MainWindow.h"
+#include "OfflineQADatabase.h"
+#include "ResultsModel.h"
+#include "SuggestionEngine.h"
+#include "ThemeEngine.h"
+#include "UiProfiler.h"
+
+namespace {
+
+// Streams the corpus straight to disk so 1M entries never sit in one QJsonArray
+bool writeCorpus(const QString& filePath, int entries) {
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+    QTextStream out(&file);
+    out << "[\n";
+    for (int i = 0; i < entries; ++i) {
+        QJsonObject entry;
+        entry["question"] = bench::syntheticQuestion(i);
+        entry["answer"] = bench::syntheticAnswer(i);
+        entry["category"] = "Synthetic";
+        out << QJsonDocument(entry).toJson(QJsonDocument::Compact);
+        out << (i + 1 < entries ? ",\n" : "\n");
+    }
+    out << "]\n";
+    return true;
+}
+
+bool waitUntil(const std::function<bool()>& done, int timeoutMs = 30000) {
+    QElapsedTimer timer;
+    timer.start();
+    while (!done()) {
+        if (timer.elapsed() > timeoutMs) return false;
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 1);
+    }
+    return true;
+}
+
+// Blocks until the window has finished painting a frame that started after now
+bool waitForNextFrame(int timeoutMs = 30000) {
+    const quint64 frames = UiProfiler::instance()->frameTimes().count();
+    return waitUntil([frames]() { return UiProfiler::instance()->frameTimes().count() > frames; }, timeoutMs);
+}
+
+void report(const char* benchmark, int corpus, QVector<double> samples) {
+    QJsonObject row;
+    row["benchmark"] = QString::fromLatin1(benchmark);
+    row["corpus"] = corpus;
+    row["samples"] = int(samples.size());
+    if (!samples.isEmpty()) {
+        std::sort(samples.begin(), samples.end());
+        double sum = 0;
+        for (double s : samples) sum += s;
+        row["p50_ms"] = bench::percentile(samples, 50);
+        row["p90_ms"] = bench::percentile(samples, 90);
+        row["p99_ms"] = bench::percentile(samples, 99);
+        row["max_ms"] = samples.last();
+        row["mean_ms"] = sum / samples.size();
+    }
+    std::fputs(QJsonDocument(row).toJson(QJsonDocument::Compact).constData(), stdout);
+    std::fputc('\n', stdout);
+    std::fflush(stdout);
+}
+
+double elapsedMs(const QElapsedTimer& timer) {
+    return timer.nsecsElapsed() / 1e6;
+}
+
+void runCorpus(int corpusSize, int samples) {
+    QTemporaryDir dataDir;
+    if (!dataDir.isValid() || !writeCorpus(dataDir.filePath("synthetic.json"), corpusSize)) {
+        std::fprintf(stderr, "failed to write corpus of %d entries\n", corpusSize);
+        return;
+    }
+    qputenv("IMILYA_DATA_DIR", dataDir.path().toLocal8Bit());
+
+    MainWindow window;
+    window.show();
+    if (!QTest::qWaitForWindowExposed(&window)) {
+        std::fprintf(stderr, "window was never exposed\n");
+        return;
+    }
+
+    QLineEdit* input = window.findChild<QLineEdit*>("SearchInput");
+    QPushButton* clearButton = window.findChild<QPushButton*>("ClearButton");
+    QPushButton* themeButton = window.findChild<QPushButton*>("ThemeToggle");
+    SuggestionEngine* suggestions = window.findChild<SuggestionEngine*>();
+    ResultsModel* results = window.findChild<ResultsModel*>();
+    if (!input || !clearButton || !themeButton || !suggestions || !results) {
+        std::fprintf(stderr, "MainWindow is missing a benchmark hook\n");
+        return;
+    }
+    // Measure steady state, not the background corpus load
+    OfflineQADatabase* database = window.findChild<OfflineQADatabase*>();
+    if (!database || !waitUntil([database]() { return database->isLoaded(); }, 600000)) {
+        std::fprintf(stderr, "corpus of %d entries never finished loading\n", corpusSize);
+        return;
+    }
+    input->setFocus();
+
+    QVector<double> keystroke;
+    QVector<double> enter;
+    QVector<double> theme;
+
+    for (int i = 0; i < samples; ++i) {
+        const QString query = bench::syntheticQuestion((i * 7919) % corpusSize);
+
+        // Keystroke -> suggestions: type all but the last character, then time the last one
+        input->clear();
+        QTest::keyClicks(input, query.left(query.size() - 1));
+        QSignalSpy ready(suggestions, &SuggestionEngine::suggestionsReady);
+        QElapsedTimer timer;
+        timer.start();
+        QTest::keyClick(input, query.at(query.size() - 1).toLatin1());
+        if (waitUntil([&ready]() { return ready.count() > 0; })) {
+            keystroke.append(elapsedMs(timer));
+        }
+
+        // Enter -> results painted
+        clearButton->click();
+        QCoreApplication::processEvents();
+        timer.restart();
+        QTest::keyClick(input, Qt::Key_Return);
+        if (waitUntil([results]() { return results->rowCount() > 0; }) && waitForNextFrame()) {
+            enter.append(elapsedMs(timer));
+        }
+
+        // Theme toggle -> next frame
+        timer.restart();
+        QTest::mouseClick(themeButton, Qt::LeftButton);
+        if (waitForNextFrame()) {
+            theme.append(elapsedMs(timer));
+        }
+    }
+
+    report("keystroke_to_suggestion", corpusSize, keystroke);
+    report("enter_to_results_painted", corpusSize, enter);
+    report("theme_toggle", corpusSize, theme);
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    ImilyaApplication app(argc, argv);
+    app.setOrganizationName("Imilya");
+    app.setApplicationName("Imilya Minds Bench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Headless UI latency benchmark");
+    parser.addHelpOption();
+    QCommandLineOption sizesOption("sizes", "Comma-separated corpus sizes", "list", "1000,100000,1000000");
+    QCommandLineOption samplesOption("samples", "Samples per measurement", "count", "20");
+    parser.addOption(sizesOption);
+    parser.addOption(samplesOption);
+    parser.process(app);
+
+    ThemeEngine::instance()->install();
+    ThemeEngine::instance()->applyTheme("Beast");
+    UiProfiler::instance()->setEnabled(true);
+
+    const int samples = qMax(1, parser.value(samplesOption).toInt());
+    for (const QString& size : parser.value(sizesOption).split(',', Qt::SkipEmptyParts)) {
+        runCorpus(qMax(1, size.toInt()), samples);
+    }
+    return 0;
+}
@@ -0,0 +1,59 @@
+#!/bin/bash
+
+# Scatter-gather check on localhost: starts N shard daemons
+# (CPPSearchCli --serve ... --shard i/N), answers a query file through the
+# coordinator (--shards) and diffs the result against a single process.
+# Then freezes one shard to show the per-query timeout at work.
+#
+# Usage: bench/federation_test.sh [build dir] [shards] [query file]
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+BUILD_DIR="${1:-$SCRIPT_DIR/../build}"
+SHARDS="${2:-4}"
+QUERIES="$3"
+CLI="$BUILD_DIR/bin/CPPSearchCli"
+WORK_DIR="$(mktemp -d)"
+
+[ -x "$CLI" ] || { echo "Missing $CLI"; exit 1; }
+
+PIDS=()
+cleanup() {
+  for pid in "${PIDS[@]}"; do kill -CONT "$pid" 2>/dev/null; kill "$pid" 2>/dev/null; done
+  wait 2>/dev/null
+  rm -rf "$WORK_DIR"
+}
+trap cleanup EXIT
+
+if [ -z "$QUERIES" ]; then
+  QUERIES="$WORK_DIR/queries.txt"
+  printf '%s\n' "what is qt" "how to learn programming" "what" "tell me about the history of c++" \
+    "what is the meaning of life" "python" "no such question here" > "$QUERIES"
+fi
+
+SOCKETS=()
+for i in $(seq 0 $((SHARDS - 1))); do
+  socket="$WORK_DIR/shard-$i.sock"
+  "$CLI" --serve "$socket" --shard "$i/$SHARDS" &
+  PIDS+=($!)
+  SOCKETS+=("$socket")
+done
+for socket in "${SOCKETS[@]}"; do
+  for _ in $(seq 1 600); do [ -S "$socket" ] && break; sleep 0.1; done
+  [ -S "$socket" ] || { echo "Shard $socket never came up"; exit 1; }
+done
+SHARD_LIST="$(IFS=,; echo "${SOCKETS[*]}")"
+
+"$CLI" --no-gui --input "$QUERIES" > "$WORK_DIR/single.jsonl"
+"$CLI" --shards "$SHARD_LIST" --input "$QUERIES" --stats > "$WORK_DIR/federated.jsonl"
+if diff -u "$WORK_DIR/single.jsonl" "$WORK_DIR/federated.jsonl"; then
+  echo "OK: $SHARDS shards return exactly the single-process results"
+else
+  echo "FAIL: federated results differ from a single process"
+  exit 1
+fi
+
+# A stopped shard must cost at most the timeout per query, never a hang
+kill -STOP "${PIDS[0]}"
+"$CLI" --shards "$SHARD_LIST" --input "$QUERIES" --shard-timeout 20 --stats > "$WORK_DIR/partial.jsonl"
+kill -CONT "${PIDS[0]}"
+echo "With shard 0 stopped: $(grep -c '"missing_shards":1' "$WORK_DIR/partial.jsonl") of $(wc -l < "$WORK_DIR/partial.jsonl") answers were partial"
@@ -0,0 +1,33 @@
+#!/bin/bash
+
+# HTTP load test: starts CPPSearchCli --http, drives it with HttpLoadBench at
+# increasing concurrency and prints QPS / p99 per level (one JSON line each).
+# Build first with: cmake -DBUILD_BENCHMARKS=ON .. && make
+#
+# Usage: bench/http_load_test.sh [build dir] [port] [seconds per level]
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+BUILD_DIR="${1:-$SCRIPT_DIR/../build}"
+PORT="${2:-8080}"
+SECONDS_PER_LEVEL="${3:-10}"
+BIN="$BUILD_DIR/bin"
+
+for tool in CPPSearchCli HttpLoadBench; do
+  [ -x "$BIN/$tool" ] || { echo "Missing $BIN/$tool (configure with -DBUILD_BENCHMARKS=ON)"; exit 1; }
+done
+
+"$BIN/CPPSearchCli" --http "$PORT" --stats &
+SERVER_PID=$!
+trap 'kill $SERVER_PID 2>/dev/null; wait $SERVER_PID 2>/dev/null' EXIT
+
+# Wait for the database to load and the port to open
+for _ in $(seq 1 600); do
+  (exec 3<>"/dev/tcp/127.0.0.1/$PORT") 2>/dev/null && break
+  kill -0 $SERVER_PID 2>/dev/null || { echo "Server exited during start-up"; exit 1; }
+  sleep 0.1
+done
+
+for connections in 1 16 64 256; do
+  "$BIN/HttpLoadBench" --port "$PORT" --connections "$connections" --seconds "$SECONDS_PER_LEVEL" \
+    || { echo "Load run with $connections connections failed"; exit 1; }
+done
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <QFile>
+#include <QString>
+
+class QueryIndex;
+
+/**
+ * Memory-mapped file of serialized answers, one record per QueryIndex entry
+ * - Records use the ServeProtocol record layout, so the daemon can send
+ *   them straight from the mapping without copying
+ * - Layout: "IMAS", version, count, offsets[count + 1], records
+ */
+class AnswerStore {
+public:
+    AnswerStore() = default;
+    ~AnswerStore();
+
+    // Serialize every index entry to path and map the result
+    bool build(const QueryIndex& index, const QString& path);
+    bool open(const QString& path);
+
+    int count() const { return int(m_count); }
+
+    // Record of entry, pointing into the mapping; null if out of range
+    const char* record(int entry, quint32* length) const;
+
+    QString errorString() const { return m_error; }
+
+private:
+    void close();
+
+    QFile m_file;
+    const uchar* m_data = nullptr;
+    qint64 m_size = 0;
+    quint32 m_count = 0;
+    const quint64* m_offsets = nullptr;
+    QString m_error;
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+#include <QThreadPool>
+
+class QIODevice;
+class QueryIndex;
+
+/**
+ * Headless bulk query answering over a QueryIndex
+ * - Reads one query per line, writes one JSON object per line, in input order
+ * - Queries of a batch are normalized once and duplicates answered once
+ * - Unique queries of a batch are answered in parallel across cores
+ * Output: {"line":N,"query":"...","results":[{"title":..,"score":..,"url":..,"snippet":..},...]}
+ * With setExplain, each object also carries "explain": the SearchExplain JSON.
+ */
+class BatchSearch {
+public:
+    struct Stats {
+        qint64 queries = 0;
+        qint64 uniqueQueries = 0;
+        qint64 elapsedNs = 0;
+        double queriesPerSecond() const { return elapsedNs ? queries * 1e9 / elapsedNs : 0.0; }
+    };
+
+    explicit BatchSearch(const QueryIndex& index);
+
+    void setLimit(int limit) { m_limit = qMax(1, limit); }
+    // 0 uses every core
+    void setThreadCount(int threads);
+    void setBatchSize(int lines) { m_batchSize = qMax(1, lines); }
+    void setExplain(bool explain) { m_explain = explain; }
+
+    // Answer every line of input; false if reading or writing failed
+    bool run(QIODevice* input, QIODevice* output);
+
+    // JSON line (without the trailing newline) for a single query
+    QByteArray answer(const QString& query, qint64 line = 1) const;
+
+    // {"query":"...","results":[...]} for one query, plus "explain":{...}
+    // if asked; safe from any thread
+    QByteArray searchJson(const QString& query, int limit, bool explain = false) const;
+
+    const Stats& stats() const { return m_stats; }
+
+    // Appends text as a quoted, escaped JSON string
+    static void appendJsonString(QByteArray& out, QStringView text);
+
+private:
+    // The results array; with explain, followed by ,"explain":{...}
+    QByteArray resultsJson(const QString& normalizedQuery, int limit, bool explain) const;
+    bool processBatch(const QVector<QByteArray>& lines, qint64 firstLine, QIODevice* output);
+
+    const QueryIndex& m_index;
+    // Serialized result object per index entry, up to (not including) the score
+    QVector<QByteArray> m_entryJson;
+    QThreadPool m_pool;
+    int m_limit = 10;
+    int m_batchSize = 8192;
+    bool m_explain = false;
+    Stats m_stats;
+};
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <QString>
+#include "SearchResult.h"
+
+/**
+ * Built-in Q&A entries compiled into read-only tables
+ * - Question/answer text and the lookup tables are constant data; nothing
+ *   is allocated or hashed at startup
+ * - Exact lookups go through a perfect hash computed by the compiler
+ * - SearchResults are only materialized for entries that actually match
+ */
+class BuiltinCorpus {
+public:
+    struct Entry {
+        const char* question; // lower-case ASCII
+        const char* answer;   // UTF-8
+        const char* category;
+    };
+
+    static int count();
+    static const Entry& entry(int index);
+    static QLatin1String question(int index);
+
+    // Index of the entry whose question equals the lower-cased, trimmed query, or -1
+    static int find(const QString& cleanQuery);
+
+    static SearchResult result(int index);
+};
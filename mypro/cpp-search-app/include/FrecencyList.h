@@ -0,0 +1,79 @@
+#pragma once
+
+#include <QHash>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * Bounded set of past queries ordered by recency, ranked by frecency
+ * - Hash from query to slot plus an intrusive doubly linked recency list
+ *   threaded through the slot array: touch, insert and eviction are O(1)
+ * - Each slot keeps its use count, last use and a frecency rank: uses
+ *   decay with a half-life, stored as log2(decayed uses) + lastUsed / halfLife
+ *   so ranks taken at different times compare directly and never need a
+ *   refresh
+ * - Lowered queries are also kept in a sorted array, so a prefix lookup
+ *   visits only the matching entries. touch() only notes new queries
+ *   (evicted ones go stale by slot version), keeping it O(1) amortized;
+ *   the next lookup sorts the k new ones and merges them in, O(n + k log k)
+ */
+class FrecencyList {
+public:
+    struct Entry {
+        QString query;
+        QString lowered;
+        quint32 count = 0;
+        qint64 lastUsed = 0;  // msecs since epoch
+        double rank = 0.0;
+        quint32 version = 0;  // bumped when the slot is reused, invalidating index refs
+        int prev = -1;        // towards more recent
+        int next = -1;        // towards less recent
+    };
+
+    explicit FrecencyList(int capacity = 100000);
+
+    // Records count uses of query at timestamp; evicts the least recent entry when full
+    void touch(const QString& query, qint64 timestamp, quint32 count = 1);
+    void clear();
+
+    int size() const { return int(m_slots.size()); }
+    int capacity() const { return m_capacity; }
+
+    // Most recent first
+    QStringList recent(int count) const;
+
+    // Queries starting with prefix (case-insensitive), best frecency first
+    QStringList suggestions(const QString& prefix, int limit) const;
+    QVector<QPair<QString, double>> ranked(const QString& prefix, int limit) const;
+
+    // Rank of query, or kNoRank if it is not in the list
+    double rankOf(const QString& query) const;
+
+    // Rank arithmetic shared with HistoryStore
+    static constexpr double kNoRank = -1e300;
+    static double useRank(qint64 timestamp, quint32 count);
+    // Rank of the uses behind a and b together
+    static double combineRanks(double a, double b);
+
+private:
+    struct IndexRef {
+        int slot;
+        quint32 version;
+    };
+
+    void unlink(int slot);
+    void pushFront(int slot);
+    // Folds m_added into m_sorted and drops refs to reused slots
+    void mergeIndex() const;
+
+    QVector<Entry> m_entries;
+    QHash<QString, int> m_slots;
+    // Prefix index, by lowered query; kept up to date lazily by ranked()
+    mutable QVector<IndexRef> m_sorted;
+    mutable QVector<IndexRef> m_added;   // new since the last merge, unsorted
+    int m_head = -1;
+    int m_tail = -1;
+    int m_capacity;
+};
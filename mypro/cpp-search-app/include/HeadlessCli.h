@@ -0,0 +1,16 @@
+#pragma once
+
+/**
+ * Command-line front end without any GUI (--no-gui, and the CPPSearchCli tool)
+ * - One query with -s/--search, else one query per line from --input or stdin
+ * - Ranked results as JSON Lines on --output or stdout (see BatchSearch)
+ * - --serve <socket>: stay resident and answer over a Unix socket (see QueryServer)
+ * - --http [ipv4:]port: stay resident and answer HTTP/JSON (see HttpServer)
+ * - --shard i/n loads one slice of the corpus; --shards a.sock,b.sock,...
+ *   answers through those shard daemons instead (see ShardCoordinator)
+ * Needs only QtCore: creates its own QCoreApplication.
+ */
+class HeadlessCli {
+public:
+    static int run(int argc, char *argv[]);
+};
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <QMutex>
+#include <QString>
+#include <QVector>
+#include <QWaitCondition>
+
+class QLockFile;
+class QThread;
+class HistoryStore;
+
+/**
+ * Append-only search history file shared by every running instance
+ * - append() only queues the record; a writer thread commits whatever has
+ *   queued up in one write and one fsync (group commit)
+ * - Every commit opens, appends and closes under a QLockFile, so
+ *   concurrent instances interleave records instead of overwriting them;
+ *   a batch that cannot get the lock is queued again, never dropped
+ * - Past a size bounded by the store's, the writer folds the log into a new
+ *   HistoryStore and starts the log over, so a cold start replays at most
+ *   a few megabytes however long the history is
+ * Format: one "<msecs since epoch>\t<count>\t<query>\n" line per record;
+ * count 0 with an empty query clears everything before it. A torn last
+ * line (no newline) is ignored. The first line "<generation>\t-1\t" names
+ * the store generation the log continues; a log left behind by an
+ * interrupted compaction is recognised by it and trimmed, never replayed twice.
+ */
+class HistoryLog {
+public:
+    struct Record {
+        qint64 timestamp;
+        int count;          // uses of query this record stands for; 0 = clear
+        QString query;
+    };
+
+    HistoryLog(const QString& filePath, const QString& storePath);
+    // Commits everything still queued
+    ~HistoryLog();
+
+    // Maps the current store into store and returns the log records not yet
+    // folded into it, in order, as written by every instance
+    QVector<Record> load(HistoryStore& store) const;
+
+    // Cheap and callable from any thread; the disk write happens later
+    void append(const QString& query, qint64 timestamp, int count = 1);
+    void appendClear(qint64 timestamp);
+
+    // Commits everything queued so far on the calling thread
+    void flush();
+
+    QString filePath() const { return m_filePath; }
+    QString storePath() const { return m_storePath; }
+
+private:
+    void writerLoop();
+    // False if the file lock could not be taken within timeoutMs (-1 waits
+    // for it); nothing was written then
+    bool commit(const QVector<Record>& records, int timeoutMs);
+    // Puts records that failed to commit back in front of the queue
+    void requeue(const QVector<Record>& records);
+    // Folds the log into a new store; drops lock while the store is written
+    void compact(QLockFile& lock);
+    void updateCompactThreshold();
+    static QVector<Record> parse(const QByteArray& data);
+    static void serialize(const Record& record, QByteArray& out);
+
+    const QString m_filePath;
+    const QString m_storePath;
+    qint64 m_compactThreshold;
+
+    QMutex m_commitMutex;   // one commit at a time: writer thread or flush()
+    QMutex m_mutex;
+    QWaitCondition m_wake;
+    QVector<Record> m_pending;
+    bool m_stopping;
+    QThread* m_writer;
+};
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <QFile>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include "HistoryLog.h"
+
+class QIODevice;
+
+/**
+ * Memory-mapped, sorted snapshot of the search history (history.store)
+ * - One fixed-size record per distinct query, sorted by lowered UTF-8 key,
+ *   so a prefix is two binary searches away from its range of matches
+ * - A max-rank segment tree over blocks of records finds the best ranked
+ *   matches of a range without visiting the rest of it
+ * - The most recently used queries are listed separately for the recent list
+ * - Opening maps the file and checks the header; nothing is read up front,
+ *   so opening costs the same for a thousand queries or ten million
+ * Layout: header, records, string pool, block tree, recent list.
+ * HistoryLog folds its records into a new store when compacting.
+ */
+class HistoryStore {
+public:
+    HistoryStore() = default;
+    ~HistoryStore();
+
+    // A missing file opens as an empty store of generation 0
+    bool open(const QString& path);
+    void close();
+
+    int size() const { return int(m_count); }
+    // Number of compactions behind this store; the log is tagged with it
+    quint64 generation() const { return m_generation; }
+    // Bytes of the previous generation's log folded into this store
+    quint64 foldedLogBytes() const { return m_foldedLogBytes; }
+
+    // Queries starting with prefix (case-insensitive), best frecency first
+    QVector<QPair<QString, double>> ranked(const QString& prefix, int limit) const;
+    // Frecency rank of query, or FrecencyList::kNoRank if it is not stored
+    double rankOf(const QString& query) const;
+    // Most recently used first; at most the length of the stored recent list
+    QStringList recent(int count) const;
+
+    // Writes base plus records (oldest first) as generation base.generation() + 1.
+    // A clear record drops base and everything before it.
+    static bool write(QIODevice& out, const HistoryStore& base, const QVector<HistoryLog::Record>& records,
+                      quint64 foldedLogBytes);
+    // Header fields of the store at path without mapping it; 0 for no store
+    static void peek(const QString& path, quint64* generation, quint64* foldedLogBytes);
+
+    QString errorString() const { return m_error; }
+
+private:
+    QString textAt(quint32 index) const;
+
+    QFile m_file;
+    const uchar* m_data = nullptr;
+    qint64 m_size = 0;
+    quint32 m_count = 0;
+    quint32 m_leafCount = 0;
+    quint32 m_recentCount = 0;
+    quint64 m_generation = 0;
+    quint64 m_foldedLogBytes = 0;
+    const uchar* m_records = nullptr;
+    const char* m_pool = nullptr;
+    const double* m_tree = nullptr;
+    const quint32* m_recent = nullptr;
+    QString m_error;
+};
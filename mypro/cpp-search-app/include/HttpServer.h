@@ -0,0 +1,124 @@
+#pragma once
+
+#include <QAtomicInteger>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QThreadPool>
+#include <QVector>
+
+class QueryIndex;
+class BatchSearch;
+
+/**
+ * HTTP/1.1 JSON endpoint over the offline database (--http)
+ * - GET /search?q=..&limit=N, /suggest?q=..&limit=N, /answer/{id},
+ *   /metrics (Prometheus text; ?format=json for JSON); /search&explain=1
+ *   adds the query plan and cost breakdown (SearchExplain)
+ * - Keep-alive connections on one epoll thread; /search and /suggest run
+ *   on a worker pool, /answer is a lookup and is answered inline
+ * - Admission control: at most queueLimit searches queued or running;
+ *   beyond that, and for searches that waited past the deadline, the
+ *   answer is 503 with Retry-After instead of a growing backlog
+ * Linux only; listen() fails elsewhere.
+ */
+class HttpServer {
+public:
+    struct Stats {
+        quint64 requests = 0;
+        quint64 served = 0;
+        quint64 shedQueueFull = 0;
+        quint64 shedDeadline = 0;
+        quint64 rejectedConnections = 0;
+    };
+
+    HttpServer(const QueryIndex& index, const BatchSearch& search);
+    ~HttpServer();
+
+    // 0 uses every core
+    void setThreadCount(int threads);
+    void setQueueLimit(int jobs) { m_queueLimit = qMax(1, jobs); }
+    // Queued longer than this and the search is shed unanswered
+    void setDeadline(int ms) { m_deadlineNs = qint64(qMax(1, ms)) * 1000000; }
+    void setMaxConnections(int connections) { m_maxConnections = qMax(1, connections); }
+
+    // address is "port" or "ipv4:port"; binds 127.0.0.1 unless told otherwise
+    bool listen(const QString& address);
+
+    // Serves until stop(); returns false on a fatal error
+    bool run();
+
+    // Safe to call from a signal handler or another thread
+    void stop();
+
+    Stats stats() const;
+    QString errorString() const { return m_error; }
+
+private:
+    struct Connection;
+    struct Request {
+        QByteArray method;
+        QByteArray target;
+        bool keepAlive = true;
+    };
+    struct Job {
+        int fd;
+        quint64 serial;     // guards against a closed and reused fd
+        bool keepAlive;
+        bool suggest;
+        bool explain;
+        QString query;
+        int limit;
+        qint64 queuedAt;
+    };
+    struct Completion {
+        int fd;
+        quint64 serial;
+        bool keepAlive;
+        int status;
+        QByteArray body;
+    };
+
+    void acceptConnections();
+    void closeConnection(Connection* connection);
+    bool readInput(Connection* connection);
+    // Parses and answers buffered requests; false if the connection was closed
+    bool handleRequests(Connection* connection);
+    void dispatch(Connection* connection, const Request& request);
+    void runJob(const Job& job);
+    void drainCompletions();
+    void sweepIdleConnections();
+    void respond(Connection* connection, int status, const QByteArray& body, bool keepAlive,
+                 const char* contentType = "application/json");
+    bool flush(Connection* connection);
+    void updateInterest(Connection* connection);
+
+    QByteArray suggestJson(const QString& query, int limit) const;
+    QByteArray answerJson(int entry) const;
+
+    const QueryIndex& m_index;
+    const BatchSearch& m_search;
+    QThreadPool m_pool;
+    int m_queueLimit = 1024;
+    qint64 m_deadlineNs = 250 * 1000000LL;
+    int m_maxConnections = 4096;
+
+    int m_listenFd = -1;
+    int m_epollFd = -1;
+    int m_wakeFd = -1;
+    QAtomicInteger<int> m_stopping;
+    QElapsedTimer m_clock;
+    QHash<int, Connection*> m_connections;
+    quint64 m_nextSerial = 1;
+
+    // Search jobs queued or running; only the event thread changes it upwards
+    QAtomicInteger<int> m_inFlight;
+    QMutex m_completionLock;
+    QVector<Completion> m_completions;
+
+    Stats m_stats;
+    QAtomicInteger<quint64> m_shedDeadline;
+    QString m_error;
+};
@@ -10,21 +10,26 @@
 #include <QLabel>
 #include <QSplitter>
 #include <QTextBrowser>
-#include <QListWidget>
 #include <QCompleter>
 #include <QStringListModel>
-#include <QTabWidget>
 #include <QTimer>
 #include <QSystemTrayIcon>
 #include <QMenu>
+#include <QPlainTextEdit>
 #include <memory>
 
 // Include the actual header files instead of forward declarations
 #include "SearchResult.h"
+#include "NavigationHistory.h"
 #include "ResultsWidget.h"
 #include "SearchHistory.h"
 #include "LoadingScreen.h"
 #include "OfflineQADatabase.h"
+#include "SuggestionEngine.h"
+#include "SearchEngine.h"
+#include "ThemeEngine.h"
+#include "ProfilerOverlay.h"
+#include "MetricsDialog.h"
 
 /**
  * Main application window
@@ -43,9 +48,25 @@ public:
     explicit MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
+    // Frame-time / input-latency overlay (View > Profiler Overlay, --profile-ui)
+    void setProfilerOverlayVisible(bool visible);
+
+    // Bring the window up (also from the tray) and search for query
+    void runSearch(const QString& query);
+    void showAndActivate();
+
+    // Keep running in the system tray when the window is closed
+    void setResident(bool resident);
+    bool isResident() const;
+
+protected:
+    void closeEvent(QCloseEvent* event) override;
+
 private slots:
     void performSearch();
     void onSearchFinished(const QVector<struct SearchResult>& results);
+    void onResultsBatch(quint64 searchId, const QVector<struct SearchResult>& batch);
+    void onSearchStreamFinished(quint64 searchId, int totalResults);
     void onResultClicked(const struct SearchResult& result);
     void onSearchTextChanged(const QString& text);
     void onSuggestionsReady(const QStringList& suggestions);
@@ -56,21 +77,30 @@ private slots:
     void toggleTheme();
     void quickCopyAnswer();
     void showSearchHistory();
+    void showSpeculationStats();
+    void showMetrics();
+    void showExplain(const QString& query);
     void showSettings();
     void showAbout();
+    void onDatabaseLoadProgress(int percent, int filesDone, int fileCount, int entriesLoaded);
+    void onDatabaseLoaded(int totalEntries);
     void onSystemTrayActivated(QSystemTrayIcon::ActivationReason reason);
     void toggleWindowVisibility();
 
 private:
     void setupUI();
     void setupMenus();
+    void setupMenuActions();
+    void setupDeferredUI();
     void setupSystemTray();
     void setupAutoComplete();
     void setupAnimations();
     void updateSearchSuggestions();
+    void updateCompleterModel(const QStringList& suggestions);
     void saveSettings();
     void loadSettings();
     void setSearchInProgress(bool inProgress);
+    void showResultCount(int count);
     void applyFuturisticStyle();
     void showLoadingScreen();
     
@@ -91,54 +121,65 @@ private:
     QPushButton* m_homeButton;
     QPushButton* m_themeToggleButton;
     QProgressBar* m_progressBar;
+    QProgressBar* m_loadProgressBar = nullptr;
     QLabel* m_statusLabel;
     
     // Results area
     ResultsWidget* m_resultsWidget;
     
-    // Tabs
-    QTabWidget* m_tabWidget;
-    QListWidget* m_historyWidget;
-    
-    // System tray
-    QSystemTrayIcon* m_systemTray;
-    QMenu* m_trayMenu;
+    // System tray (resident mode)
+    QSystemTrayIcon* m_systemTray = nullptr;
+    QMenu* m_trayMenu = nullptr;
     
     // Core components
     SearchHistory* m_searchHistory;
     OfflineQADatabase* m_offlineQA;
+    SearchEngine* m_searchEngine;
     
     
     // Auto-complete
     QTimer* m_suggestionTimer;
-    // Autocomplete
+    SuggestionEngine* m_suggestionEngine;
     QCompleter* m_completer;
     QStringListModel* m_completerModel;
     
-    // Loading screen
-    LoadingScreen* m_loadingScreen;
+    // Loading screen, shown only when the knowledge base takes a while to load
+    LoadingScreen* m_loadingScreen = nullptr;
+    
+    // Debug overlay
+    ProfilerOverlay* m_profilerOverlay = nullptr;
+    MetricsDialog* m_metricsDialog = nullptr;
+    QPlainTextEdit* m_explainView = nullptr;
+    bool m_explainMode = false;   // hidden toggle, Ctrl+Shift+E
+    QAction* m_profilerAction = nullptr;
+    
+    // Menus (filled on first use)
+    QMenu* m_fileMenu;
+    QMenu* m_editMenu;
+    QMenu* m_viewMenu;
+    QMenu* m_helpMenu;
+    bool m_menusPopulated = false;
     
-    // Animation components
-    QPropertyAnimation* m_searchAnimation;
-    QPropertyAnimation* m_resultsAnimation;
-    QGraphicsOpacityEffect* m_resultsOpacityEffect;
+    // Animation components (created on first use)
+    QPropertyAnimation* m_searchAnimation = nullptr;
     
     // State
     bool m_searchInProgress;
     QString m_currentQuery;
-    QVector<SearchResult> m_navigationHistory;
-    int m_historyIndex = -1;
+    quint64 m_activeSearchId = 0;
+    bool m_searchedWhileLoading = false;
+    NavigationHistory m_navigation;
     QString m_themeMode; // "Beast" (dark) or "Best" (light)
     
     // Settings
     QString m_defaultBrowser;
     bool m_enableAutoComplete;
-    bool m_enableSystemTray;
+    bool m_enableSystemTray = true;
     int m_maxResults;
 
     void navigateTo(const SearchResult& result);
+    void showNavigationStep(const NavigationHistory::Step& step);
     void updateUrlBar(const SearchResult& result);
     void applyBestStyle();
     void applyBeastStyle();
-    QVector<SearchResult> buildOfflineResults(const QString& query) const;
 };
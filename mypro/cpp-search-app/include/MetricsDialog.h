@@ -0,0 +1,31 @@
+#pragma once
+
+#include <QDialog>
+#include <QPushButton>
+#include <QTimer>
+#include <QTreeWidget>
+
+/**
+ * Live view of the Metrics registry (View > Metrics)
+ * - Counters with their value, histograms with count and percentiles
+ * - Exports the registry as Prometheus text or JSON
+ */
+class MetricsDialog : public QDialog {
+    Q_OBJECT
+
+public:
+    explicit MetricsDialog(QWidget *parent = nullptr);
+
+protected:
+    void showEvent(QShowEvent* event) override;
+    void hideEvent(QHideEvent* event) override;
+
+private slots:
+    void refresh();
+    void exportMetrics();
+
+private:
+    QTreeWidget* m_table;
+    QPushButton* m_exportButton;
+    QTimer* m_refreshTimer;
+};
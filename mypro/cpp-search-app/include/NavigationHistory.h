@@ -0,0 +1,43 @@
+#pragma once
+
+#include <QVector>
+
+/**
+ * Back/forward history of viewed results as a fixed-size ring
+ * - Holds entry ids (SearchResult::entryId) and scores, 8 bytes per step;
+ *   the results themselves are fetched again when navigated to
+ * - Navigating somewhere new drops the forward steps in O(1); once full,
+ *   the oldest step is overwritten, so memory stays constant
+ */
+class NavigationHistory {
+public:
+    struct Step {
+        qint32 entryId = -1;
+        float score = 0.0f;
+    };
+
+    explicit NavigationHistory(int capacity = 256);
+
+    // Makes entryId the current step, dropping any forward steps
+    void push(int entryId, double score);
+    void clear();
+
+    bool canGoBack() const { return m_position > 0; }
+    bool canGoForward() const { return m_position + 1 < m_size; }
+
+    // Move one step and return the new current step
+    Step back();
+    Step forward();
+
+    bool isEmpty() const { return m_size == 0; }
+    int size() const { return m_size; }
+    Step current() const;
+
+private:
+    const Step& at(int position) const { return m_ring.at((m_start + position) % m_ring.size()); }
+
+    QVector<Step> m_ring;
+    int m_start = 0;        // ring slot of the oldest step
+    int m_size = 0;
+    int m_position = -1;    // current step, counted from the oldest
+};
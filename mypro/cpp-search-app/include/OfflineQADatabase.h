@@ -6,8 +6,13 @@
 #include <QStringList>
 #include <QHash>
 #include <QVector>
+#include <QPair>
+#include <QReadWriteLock>
+#include <QAtomicInteger>
 #include "SearchResult.h"
 
+class QThread;
+
 class OfflineQADatabase : public QObject
 {
     Q_OBJECT
@@ -16,6 +21,21 @@ public:
     explicit OfflineQADatabase(QObject *parent = nullptr);
     ~OfflineQADatabase();
 
+    // Load the external data packs on a background thread; queries are
+    // answered from whatever has been loaded so far in the meantime
+    void loadExternalDataAsync();
+
+    // Load the external data packs on the calling thread
+    void loadExternalDataSync();
+
+    bool isLoaded() const { return m_loaded.loadAcquire(); }
+
+    // Keep only the questions of shard index out of count (set before loading).
+    // Assignment is FNV-1a of the normalized question's UTF-8 modulo count, so every
+    // process agrees on it whatever the Qt build or CPU.
+    void setShard(int index, int count);
+    static int shardOf(const QString& question, int count);
+
     // Check if query has an offline answer
     bool hasOfflineAnswer(const QString& query) const;
     
@@ -28,19 +48,52 @@ public:
     // Get suggestions based on partial query
     QStringList getSuggestions(const QString& partialQuery) const;
 
+    // Scored matches among questions [begin, end); safe to call from worker threads.
+    // Built-in questions come first, so questionCount() is never zero.
+    void collectMatches(const QString& query, int begin, int end, QVector<SearchResult>& out) const;
+    int questionCount() const;
+
+    // One result per distinct question, in question-index order (built-ins
+    // first, pack overrides applied), each with its entryId set
+    QVector<SearchResult> snapshotEntries() const;
+
+    // Result for question index (SearchResult::entryId); invalid if out of range
+    SearchResult entryAt(int index) const;
+
+    // Get ranked suggestions (question, score); safe to call from a worker thread
+    QVector<QPair<QString, double>> getScoredSuggestions(const QString& partialQuery, int limit = 10) const;
+
+signals:
+    // Emitted from the loader thread; connect with the default (queued) connection
+    void fileLoadStarted(const QString& fileName, int fileIndex, int fileCount);
+    void loadProgress(int percent, int filesDone, int fileCount, int entriesLoaded);
+    void loadFinished(int totalEntries);
+
 private:
-    void initializeDatabase();
+    struct PendingQA {
+        QString question;
+        QString answer;
+        QString category;
+    };
+
     void addQA(const QString& question, const QString& answer, const QString& category = "General");
-    void addGreetings();
-    void addCommonQuestions();
-    void addTechnicalQuestions();
-    void addGeneralKnowledge();
+    // Built-in entry index, or the data pack answer overriding it; m_lock must be held
+    SearchResult builtinResult(int index) const;
     void loadExternalData();
-    void addFromJsonFile(const QString& filePath);
-    void addFromCsvFile(const QString& filePath);
+    static QStringList externalDataFiles();
+    static void readJsonFile(const QString& filePath, QVector<PendingQA>& out);
+    static void readCsvFile(const QString& filePath, QVector<PendingQA>& out);
     
     QHash<QString, SearchResult> m_qaDatabase;
     QStringList m_allQuestions;
+    
+    // Readers run on search/suggestion workers while the loader appends
+    mutable QReadWriteLock m_lock;
+    QThread* m_loaderThread;
+    QAtomicInteger<bool> m_loaded;
+    QAtomicInteger<bool> m_abortLoading;
+    int m_shardIndex;
+    int m_shardCount;
 };
 
 #endif // OFFLINEQADABASE_H
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <QFrame>
+#include <QLabel>
+#include <QPushButton>
+#include <QTimer>
+
+/**
+ * Floating debug panel over the main window showing UiProfiler statistics
+ * - Frame time, key-to-paint latency and the most expensive widgets
+ * - Exports the collected histograms as JSON or CSV
+ */
+class ProfilerOverlay : public QFrame {
+    Q_OBJECT
+
+public:
+    explicit ProfilerOverlay(QWidget *parent);
+
+    // Show/hide the panel; profiling runs only while it is visible
+    void setActive(bool active);
+    bool isActive() const { return isVisible(); }
+
+protected:
+    bool eventFilter(QObject* watched, QEvent* event) override;
+
+private slots:
+    void refresh();
+    void exportHistograms();
+
+private:
+    void reposition();
+
+    QLabel* m_statsLabel;
+    QPushButton* m_exportButton;
+    QPushButton* m_resetButton;
+    QTimer* m_refreshTimer;
+};
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <QString>
+#include <QStringView>
+#include <QVector>
+#include <QHash>
+#include <QMultiHash>
+#include "SearchResult.h"
+#include "SearchExplain.h"
+
+class OfflineQADatabase;
+
+/**
+ * Read-only search index over a snapshot of the offline database
+ * - Entries are kept in display order (shorter question first), so the
+ *   first k hits found for a score are already the top k
+ * - Trigram posting lists narrow down "question contains query" candidates
+ * - "Query contains question" probes the query's substrings against a
+ *   hash of every question
+ * Scores match OfflineQADatabase::collectMatches (1.0 / 0.8 / 0.6).
+ * search() is const and safe to call from any number of threads. Once a
+ * thread's scratch buffers have grown to fit, a lookup into a reused hits
+ * buffer does not touch the heap (bench/QueryAllocBench checks this).
+ */
+class QueryIndex {
+public:
+    struct Hit {
+        int entry;    // index into entry()
+        double score;
+    };
+
+    void build(const OfflineQADatabase& database);
+    void build(QVector<SearchResult> entries);
+
+    int size() const { return int(m_entries.size()); }
+    const SearchResult& entry(int index) const { return m_entries.at(index); }
+
+    // Best hits first into hits, which is cleared but keeps its capacity;
+    // query must already be normalize()d.
+    // With explain, also records the stages run and each hit's score.
+    void search(QStringView query, int limit, QVector<Hit>& hits, SearchExplain* explain = nullptr) const;
+    QVector<Hit> search(QStringView query, int limit, SearchExplain* explain = nullptr) const;
+
+    static QString normalize(const QString& query) { return query.toLower().trimmed(); }
+    // Same result written into out, reusing its capacity; only a query with
+    // surrogates or U+0130 (which lower-cases to two code units) allocates
+    static void normalize(QStringView query, QString& out);
+
+private:
+    // Each returns the number of candidates it examined
+    int findExact(QStringView query, int* exact) const;
+    int collectContaining(QStringView query, int exact, int wanted, QVector<Hit>& hits,
+                          SearchExplain::StageTimer& stage) const;
+    int collectContained(QStringView query, int wanted, QVector<Hit>& hits) const;
+    void buildTrigrams();
+
+    QVector<SearchResult> m_entries;
+    QVector<QString> m_lowered;          // lower-cased questions, same order
+    QMultiHash<size_t, int> m_exact;     // qHash(lowered question) -> entry
+    int m_minLength = 0;
+    int m_maxLength = 0;
+
+    // Posting lists in CSR form: entries of trigram t are
+    // m_postings[m_offsets[t] .. m_offsets[t + 1]), ascending
+    QHash<quint64, int> m_trigramIds;
+    QVector<int> m_offsets;
+    QVector<int> m_postings;
+};
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QVector>
+#include "QueryIndex.h"
+
+class AnswerStore;
+
+/**
+ * Resident query daemon on a Unix domain socket (--serve)
+ * - Length-prefixed binary frames, see ServeProtocol.h
+ * - Pipelined requests: every complete frame in the read buffer is answered,
+ *   and all responses go out in one gather write
+ * - Answer records are sent straight from the mapped AnswerStore
+ * - One epoll thread; a search costs microseconds, so handing it to a
+ *   worker would only add latency
+ * - Buffers are reused across requests: once warm, answering a search
+ *   does not allocate
+ * Linux only; listen() fails elsewhere.
+ */
+class QueryServer {
+public:
+    QueryServer(const QueryIndex& index, const AnswerStore& store);
+    ~QueryServer();
+
+    // Binds socketPath, replacing a stale socket file
+    bool listen(const QString& socketPath);
+
+    // Serves until stop(); returns false on a fatal error
+    bool run();
+
+    // Safe to call from a signal handler or another thread
+    void stop();
+
+    QString errorString() const { return m_error; }
+
+private:
+    struct Connection;
+    struct Piece {
+        const char* data;   // null: offset into Connection::headers
+        qsizetype offset;
+        qsizetype length;
+    };
+
+    void acceptConnections();
+    void closeConnection(Connection* connection);
+    bool readRequests(Connection* connection);
+    void answerRequests(Connection* connection);
+    void answer(Connection* connection, quint32 id, quint8 op, quint8 limit, const char* payload, quint32 length);
+    bool flush(Connection* connection);
+    void updateInterest(Connection* connection);
+
+    const QueryIndex& m_index;
+    const AnswerStore& m_store;
+    QString m_socketPath;
+    int m_listenFd = -1;
+    int m_epollFd = -1;
+    int m_wakeFd = -1;
+    QHash<int, Connection*> m_connections;
+    QVector<Piece> m_pieces; // scratch for assembling one connection's responses
+    QString m_queryText;     // scratch: decoded query of the request being answered
+    QString m_query;         // scratch: the same, normalized
+    QVector<QueryIndex::Hit> m_hits;
+    QString m_error;
+};
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <QStyledItemDelegate>
+#include <QStaticText>
+#include <QTextLayout>
+#include <QCache>
+#include <QColor>
+#include <QFont>
+
+/**
+ * Paints a search result as a card
+ * - Fixed row height so the view can virtualize with uniform item sizes
+ * - Text layouts are built once per row and cached until the width changes
+ */
+class ResultDelegate : public QStyledItemDelegate {
+    Q_OBJECT
+
+public:
+    struct Colors {
+        QColor card;
+        QColor cardBorder;
+        QColor hover;
+        QColor accent;
+        QColor selectedText;
+        QColor title;
+        QColor meta;
+        QColor text;
+    };
+
+    explicit ResultDelegate(QObject *parent = nullptr);
+
+    void setColors(const Colors& colors);
+    void invalidateCache();
+
+    void paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const override;
+    QSize sizeHint(const QStyleOptionViewItem& option, const QModelIndex& index) const override;
+
+private:
+    struct RowLayout {
+        int width = -1;
+        QStaticText title;
+        QStaticText meta;
+        QStaticText footer;
+        QTextLayout description;
+    };
+
+    RowLayout* layoutFor(const QModelIndex& index, int width) const;
+    void layoutDescription(QTextLayout& layout, const QString& text, int width) const;
+
+    Colors m_colors;
+    QFont m_titleFont;
+    QFont m_metaFont;
+    QFont m_textFont;
+    QFont m_footerFont;
+    int m_rowHeight;
+    mutable QCache<int, RowLayout> m_cache;
+};
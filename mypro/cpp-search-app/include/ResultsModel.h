@@ -0,0 +1,52 @@
+#pragma once
+
+#include <QAbstractListModel>
+#include <QVector>
+#include "SearchResult.h"
+
+/**
+ * List model over a shared result set
+ * - Rows are handles into an implicitly shared QVector, nothing is copied per row
+ * - Rows are exposed in batches through canFetchMore/fetchMore
+ * - Streamed batches are merged in rank order with row inserts, never a reset
+ */
+class ResultsModel : public QAbstractListModel {
+    Q_OBJECT
+
+public:
+    enum Roles {
+        TitleRole = Qt::UserRole + 1,
+        DescriptionRole,
+        SnippetRole,
+        DisplayUrlRole,
+        SourceRole,
+        RelevanceRole,
+        TimestampRole
+    };
+
+    explicit ResultsModel(QObject *parent = nullptr);
+
+    void setResults(const QVector<SearchResult>& results);
+
+    // Merge a batch sorted best-first into the already ranked rows
+    void mergeResults(const QVector<SearchResult>& batch);
+    void clear();
+
+    // Handle lookup; row must be below totalCount()
+    const SearchResult& resultAt(int row) const { return m_results.at(row); }
+    int totalCount() const { return m_results.size(); }
+
+    void setFetchBatchSize(int size) { m_batchSize = qMax(1, size); }
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
+
+private:
+    void topUpLoadedRows();
+
+    QVector<SearchResult> m_results;
+    int m_loadedRows;
+    int m_batchSize;
+};
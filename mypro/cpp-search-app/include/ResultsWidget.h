@@ -1,14 +1,19 @@
 #pragma once
 
 #include <QWidget>
-#include <QListWidget>
+#include <QListView>
 #include <QVBoxLayout>
 #include <QLabel>
 #include <QPushButton>
+#include <QTextBrowser>
 #include "SearchResult.h"
+#include "ResultsModel.h"
+#include "ResultDelegate.h"
 
 /**
  * Widget to display search results
+ * - Virtualized list view over ResultsModel, painted by ResultDelegate
+ * - Rows show a bounded snippet; the full answer is laid out only for the current row
  */
 class ResultsWidget : public QWidget {
     Q_OBJECT
@@ -19,6 +24,14 @@ public:
     void displayResults(const QVector<SearchResult>& results);
     void clearResults();
 
+    // Progressive display: current rows stay up until the first batch arrives
+    void beginStreaming();
+    void appendResults(const QVector<SearchResult>& batch);
+    void finishStreaming();
+
+    int resultCount() const { return m_model->totalCount(); }
+    SearchResult topResult() const;
+
     // Theme-aware styling
     void applyLightStyle();
     void applyDarkStyle();
@@ -27,12 +40,18 @@ signals:
     void resultClicked(const SearchResult& result);
 
 private slots:
-    void onItemClicked();
+    void onItemClicked(const QModelIndex& index);
+    void onCurrentChanged(const QModelIndex& current);
 
 private:
+    void hideDetail();
+
     QVBoxLayout* m_layout;
     QLabel* m_statusLabel;
-    QListWidget* m_resultsList;
-    QVector<SearchResult> m_results;
+    QListView* m_resultsList;
+    QTextBrowser* m_detailView;
+    ResultsModel* m_model;
+    ResultDelegate* m_delegate;
+    bool m_replaceOnNextBatch;
 };
 
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include <QMutex>
+#include <QThreadPool>
+#include <QAtomicInteger>
+#include "SearchResult.h"
+#include "SearchExplain.h"
+
+class OfflineQADatabase;
+
+/**
+ * Counters describing how well speculative prefetch is paying off
+ */
+struct SpeculationStats {
+    quint64 prefetched = 0; // result sets computed ahead of time
+    quint64 hits = 0;       // searches answered from the speculative cache
+    quint64 misses = 0;     // searches that had to be computed on demand
+    quint64 wasted = 0;     // prefetched result sets dropped without being used
+
+    double hitRate() const {
+        const quint64 total = hits + misses;
+        return total ? double(hits) / double(total) : 0.0;
+    }
+};
+
+/**
+ * Offline search pipeline
+ * - Builds ranked result sets from the offline Q&A database
+ * - Streams results in ranked batches as database shards finish
+ * - Speculatively prefetches results for likely queries at low priority
+ */
+class SearchEngine : public QObject {
+    Q_OBJECT
+
+public:
+    explicit SearchEngine(OfflineQADatabase* database, QObject *parent = nullptr);
+    ~SearchEngine();
+
+    // Run a search, serving it from the speculative cache when possible.
+    // With explain, always computes the results and records how (the cache is left alone).
+    QVector<SearchResult> search(const QString& query, bool* fromCache = nullptr, SearchExplain* explain = nullptr);
+
+    // Take a prefetched result set for query; counts a hit or a miss
+    bool takeSpeculative(const QString& query, QVector<SearchResult>* results);
+
+    // Start a streaming search; batches and completion carry the returned id
+    quint64 startSearch(const QString& query);
+    void cancelSearch();
+
+    void setShardSize(int questions) { m_shardSize = qMax(1, questions); }
+
+    // Prefetch results for the most likely next queries (best candidate first)
+    void speculate(const QStringList& candidates);
+
+    // Drop prefetched result sets, e.g. after the database has grown
+    void invalidateSpeculation();
+
+    SpeculationStats speculationStats() const;
+    void resetSpeculationStats();
+
+    void setSpeculationDepth(int depth) { m_speculationDepth = depth; }
+
+signals:
+    // A ranked (best first) slice of the results; later batches may outrank earlier ones
+    void resultsBatch(quint64 searchId, const QVector<SearchResult>& batch);
+    void searchFinished(quint64 searchId, int totalResults);
+
+private:
+    QVector<SearchResult> buildOfflineResults(const QString& query, SearchExplain* explain = nullptr) const;
+    QVector<SearchResult> fallbackResults() const;
+    static QString cacheKey(const QString& query);
+
+    OfflineQADatabase* m_database;
+
+    // Streaming search
+    QThreadPool m_searchPool;
+    QAtomicInteger<quint64> m_searchGeneration;
+    int m_shardSize;
+
+    // Speculative execution
+    QThreadPool m_speculationPool;
+    mutable QMutex m_cacheMutex;
+    QHash<QString, QVector<SearchResult>> m_speculativeCache;
+    // Key -> its queued or running pass; the ticket tells a superseded pass
+    // (key dropped and re-requested meanwhile) from the current one
+    struct PendingPass {
+        quint64 ticket = 0;
+        bool running = false;
+    };
+    QHash<QString, PendingPass> m_pendingKeys;
+    quint64 m_nextTicket = 0;
+    int m_speculationDepth;
+
+    QAtomicInteger<quint64> m_prefetched;
+    QAtomicInteger<quint64> m_hits;
+    QAtomicInteger<quint64> m_misses;
+    QAtomicInteger<quint64> m_wasted;
+};
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QString>
+#include <QVector>
+
+/**
+ * Execution plan and cost breakdown of one search (explain mode)
+ * - Filled in by QueryIndex::search and SearchEngine::search when passed;
+ *   searches without one pay nothing for it
+ * - One stage per path the search took, in order, with candidates examined,
+ *   results produced and time spent; stages that were skipped say why
+ * - One row per returned result with the components of its rank
+ * Shown by --explain, /search?explain=1 and the GUI's Ctrl+Shift+E toggle.
+ *
+ * Stages of the query index (headless, HTTP): exact-hash, then
+ * trigram-index (substring-scan below three characters), then the
+ * contained-probe fallback for queries that contain a whole question.
+ * Stages of the desktop engine: speculative-cache, full-scan, rank, and
+ * fallback-first-25 when nothing matched.
+ */
+struct SearchExplain {
+    struct Stage {
+        QString name;         // see the stage list below
+        bool ran = true;
+        int candidates = 0;   // entries or keys examined
+        int matched = 0;      // results this stage added
+        qint64 ns = 0;
+        QString detail;
+    };
+
+    struct Score {
+        int entryId = -1;
+        QString title;
+        QString stage;        // stage that produced the result
+        double score = 0.0;   // match kind: 1.0 exact, 0.8 contains query, 0.6 contained in query
+        int titleLength = 0;  // first tie-break: shorter titles rank higher
+    };
+
+    // Times one stage until finish() or the end of the scope; does nothing without an explain
+    class StageTimer {
+    public:
+        StageTimer(SearchExplain* explain, const char* name);
+        ~StageTimer() { finish(); }
+
+        // False without an explain; guards building details nobody will read
+        bool isActive() const { return m_index >= 0; }
+        void setCounts(int candidates, int matched);
+        void setDetail(const QString& detail);
+        void finish();
+
+        StageTimer(const StageTimer&) = delete;
+        StageTimer& operator=(const StageTimer&) = delete;
+
+    private:
+        SearchExplain* m_explain;
+        int m_index = -1;
+        QElapsedTimer m_timer;
+    };
+
+    QString query;
+    QString normalized;
+    QVector<Stage> stages;
+    QVector<Score> results;
+    qint64 totalNs = 0;
+
+    // Appends a stage that did not run
+    void skip(const char* name, const QString& reason);
+    void addResult(int entryId, const QString& title, const QString& stage, double score);
+
+    static const char* matchKind(double score);
+
+    QByteArray toJson() const;
+    // Fixed-width table for terminals and the GUI
+    QString toText() const;
+};
@@ -2,27 +2,41 @@
 
 #include <QObject>
 #include <QStringList>
-#include <QSettings>
+#include "FrecencyList.h"
+#include "HistoryStore.h"
+
+class HistoryLog;
 
 /**
  * Search history manager
+ * - Two tiers: the memory-mapped HistoryStore holds everything compacted
+ *   so far (millions of queries), a FrecencyList holds what was searched
+ *   since, replayed from the append-only HistoryLog at startup
+ * - Startup maps the store and replays a log of bounded size, so it does
+ *   not grow with the history
+ * - addSearch() never touches the disk on the calling thread
+ * - Suggestions rank by frecency across both tiers, recent listings by last use
  */
 class SearchHistory : public QObject {
     Q_OBJECT
 
 public:
     explicit SearchHistory(QObject *parent = nullptr);
+    ~SearchHistory();
     
     void addSearch(const QString& query);
     QStringList getRecentSearches(int count = 10) const;
     void clearHistory();
-    QStringList getSuggestions(const QString& prefix) const;
+    QStringList getSuggestions(const QString& prefix, int limit = 10) const;
 
 private:
     void loadHistory();
-    void saveHistory();
+    void importLegacySettings();
     
-    QStringList m_history;
-    int m_maxSize;
-    QSettings* m_settings;
+    FrecencyList m_history;
+    // Mapped once; later compactions by the writer or other instances
+    // replace the file but not this mapping, so nothing is counted twice
+    HistoryStore m_store;
+    bool m_storeHidden = false;   // cleared since the store was written
+    HistoryLog* m_log;
 };
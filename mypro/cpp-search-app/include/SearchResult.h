@@ -3,7 +3,6 @@
 #include <QString>
 #include <QUrl>
 #include <QDateTime>
-#include <QPixmap>
 
 /**
  * Represents a single search result
@@ -14,7 +13,6 @@ struct SearchResult {
     QUrl url;
     QString displayUrl;
     QDateTime timestamp;
-    QPixmap favicon;
     
     // Relevance score (0.0 to 1.0)
     double relevanceScore = 0.0;
@@ -22,19 +20,58 @@ struct SearchResult {
     // Source engine that found this result
     QString sourceEngine;
     
+    // Question index in OfflineQADatabase (built-ins first), -1 if none
+    int entryId = -1;
+    
+    // Length of the collapsed preview of description (precomputed, see snippetBoundary)
+    int snippetLength = 0;
+    
     SearchResult() = default;
     
     SearchResult(const QString& title, const QString& description, const QUrl& url)
         : title(title), description(description), url(url), timestamp(QDateTime::currentDateTime()) {
         displayUrl = url.toString();
+        snippetLength = snippetBoundary(description);
+    }
+    
+    // Preview text: bounded in length however long the description is
+    QString snippet() const {
+        if (snippetLength >= description.size()) return description;
+        return description.left(snippetLength) + QStringLiteral("…");
+    }
+    
+    bool isTruncated() const {
+        return snippetLength < description.size();
+    }
+    
+    // Cut point for a preview of at most maxChars: the first line break,
+    // else the last word boundary, else a hard cut
+    static int snippetBoundary(const QString& text, int maxChars = 240) {
+        if (text.size() <= maxChars) {
+            const int lineBreak = text.indexOf('\n');
+            return lineBreak > 0 ? lineBreak : int(text.size());
+        }
+        const int lineBreak = QStringView(text).left(maxChars).indexOf(u'\n');
+        if (lineBreak > 0) return lineBreak;
+        for (int i = maxChars; i > maxChars / 2; --i) {
+            if (text.at(i).isSpace()) return i;
+        }
+        return maxChars;
     }
     
     bool isValid() const {
         return !title.isEmpty() && url.isValid();
     }
     
-    // For sorting by relevance
+    // For sorting by relevance; ties go to the shorter (closer) title so
+    // the order does not depend on which shard produced a result first
     bool operator<(const SearchResult& other) const {
-        return relevanceScore > other.relevanceScore; // Higher score first
+        if (relevanceScore != other.relevanceScore) {
+            return relevanceScore > other.relevanceScore; // Higher score first
+        }
+        if (title.size() != other.title.size()) {
+            return title.size() < other.title.size();
+        }
+        return title < other.title;
     }
 };
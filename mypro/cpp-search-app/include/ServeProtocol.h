@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * Wire format of the --serve query daemon (Unix domain stream socket)
+ * - Plain C++ without Qt, so other local services can include it as-is
+ * - Integers are little-endian; every frame starts with its length
+ * - Requests may be pipelined; responses come back in request order
+ *
+ * Request:  RequestHeader, then the UTF-8 query (Search) or a uint32 entry id (Answer)
+ * Response: ResponseHeader, then count x (HitHeader, record)
+ * Record:   RecordHeader, then title, url and answer bytes (UTF-8)
+ */
+namespace ServeProtocol {
+
+constexpr uint32_t kMaxRequestLength = 64 * 1024;
+constexpr uint8_t kDefaultLimit = 10;
+
+enum Op : uint8_t {
+    Search = 1, // ranked hits for a query
+    Answer = 2, // one entry by id (ids come from earlier hits)
+    Ping = 3
+};
+
+enum Status : uint8_t {
+    Ok = 0,
+    BadRequest = 1,
+    NotFound = 2
+};
+
+#pragma pack(push, 1)
+struct RequestHeader {
+    uint32_t length;   // bytes after this field
+    uint32_t id;       // echoed back in the response
+    uint8_t op;
+    uint8_t limit;     // Search: max hits, 0 = kDefaultLimit
+    uint16_t reserved;
+};
+
+struct ResponseHeader {
+    uint32_t length;   // bytes after this field
+    uint32_t id;
+    uint8_t status;
+    uint8_t count;     // number of hits that follow
+    uint16_t reserved;
+};
+
+struct HitHeader {
+    uint32_t entry;
+    uint16_t score;    // relevance x 1000, rounded: exact for the 1.0 / 0.8 / 0.6 scores
+    uint16_t reserved;
+    uint32_t recordLength;
+};
+
+struct RecordHeader {
+    uint16_t titleLength;
+    uint16_t urlLength;
+    uint32_t answerLength;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(RequestHeader) == 12, "RequestHeader is part of the wire format");
+static_assert(sizeof(ResponseHeader) == 12, "ResponseHeader is part of the wire format");
+static_assert(sizeof(HitHeader) == 12, "HitHeader is part of the wire format");
+static_assert(sizeof(RecordHeader) == 8, "RecordHeader is part of the wire format");
+
+}
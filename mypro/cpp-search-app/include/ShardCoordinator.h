@@ -0,0 +1,63 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include "SearchResult.h"
+
+/**
+ * Scatter-gather front end over shard daemons (--shards)
+ * - Each shard is a --serve daemon holding one --shard i/N slice of the corpus
+ * - Every query goes to all shards at once; the per-shard top k are merged
+ *   into the global top k
+ * - Shards that miss the per-query timeout are left out of that answer,
+ *   and their late responses are dropped when they arrive
+ * Scores depend only on the question and the query (exact / contains /
+ * contained), never on corpus-wide statistics, and ties break on the
+ * title as in QueryIndex, so shards need not exchange term statistics.
+ * Shards send scores as relevance x 1000 in 16 bits (ServeProtocol), which
+ * keeps 1.0 / 0.8 / 0.6 exact, so today the merged order matches the
+ * single-process order. Scores closer than 0.001 would tie after the
+ * round trip, so finer-grained scoring needs a wider score on the wire.
+ */
+class ShardCoordinator {
+public:
+    explicit ShardCoordinator(const QStringList& shardSockets);
+    ~ShardCoordinator();
+
+    void setTimeout(int ms) { m_timeoutMs = qMax(1, ms); }
+    void setLimit(int limit) { m_limit = qBound(1, limit, 255); }
+
+    // Connects every shard; false (see errorString) if none is reachable
+    bool connectShards();
+
+    // Global top hits; missingShards counts shards that failed or timed out
+    QVector<SearchResult> search(const QString& query, int* missingShards = nullptr);
+
+    // Same JSON line as BatchSearch::answer, plus "missing_shards" when partial
+    QByteArray answer(const QString& query, qint64 line = 1, int* missingShards = nullptr);
+
+    int shardCount() const { return int(m_shards.size()); }
+    QString errorString() const { return m_error; }
+
+private:
+    struct Shard {
+        QString socketPath;
+        int fd = -1;
+        QByteArray input;
+        bool answered = false;
+        quint64 timeouts = 0;
+    };
+
+    bool connectShard(Shard& shard);
+    void disconnectShard(Shard& shard);
+    // Reads what shard has sent; false if the connection is gone
+    bool receive(Shard& shard, quint32 id, QVector<SearchResult>& out);
+
+    QVector<Shard> m_shards;
+    quint32 m_nextId = 0;
+    int m_timeoutMs = 50;
+    int m_limit = 10;
+    QString m_error;
+};
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <QObject>
+#include <QString>
+
+class QLocalServer;
+
+/**
+ * Single-instance support over a per-user local socket
+ * - The first instance listens; later launches forward their request and exit
+ * - Requests are one line of UTF-8: "show" or "search <query>"; the
+ *   resident instance answers "ok" once the request has been dispatched
+ */
+class SingleInstance : public QObject {
+    Q_OBJECT
+
+public:
+    explicit SingleInstance(QObject *parent = nullptr);
+
+    // Become the resident instance; false if a live instance already owns the socket
+    bool listen();
+
+    // Hand a request to the resident instance (empty query just shows it);
+    // true once it has been acknowledged. Needs a QCoreApplication only.
+    static bool forward(const QString& query, int timeoutMs = 250);
+
+    static QString serverName();
+
+signals:
+    void showRequested();
+    void searchRequested(const QString& query);
+
+private slots:
+    void onNewConnection();
+
+private:
+    QLocalServer* m_server;
+};
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+
+class QWidget;
+
+/**
+ * Wall-clock trace of application start-up
+ * - The clock starts during static initialization, before main() runs
+ * - mark() closes the phase that ran since the previous mark
+ * - Records "first paint" and "first interactive" for a watched window
+ */
+class StartupTrace : public QObject {
+    Q_OBJECT
+
+public:
+    struct Phase {
+        QString name;
+        qint64 endNs; // since process start
+    };
+
+    static StartupTrace* instance();
+
+    void mark(const QString& phase);
+    qint64 elapsedNs() const;
+
+    // Watch the main window for its first paint and the first idle turn after it
+    void watch(QWidget* window);
+    bool isInteractive() const { return m_interactive; }
+
+    // Print the trace to stderr once the window is interactive and deferred work has run
+    void setReportOnInteractive(bool enabled) { m_reportOnInteractive = enabled; }
+    QString report() const;
+
+    // Budget for process start to an interactive search box
+    static constexpr qint64 kInteractiveBudgetMs = 150;
+
+signals:
+    // The window has painted and the event loop is free to take input;
+    // non-critical construction should wait for this
+    void interactive();
+
+protected:
+    bool eventFilter(QObject* watched, QEvent* event) override;
+
+private:
+    StartupTrace() = default;
+
+    QVector<Phase> m_phases;
+    QWidget* m_window = nullptr;
+    bool m_painted = false;
+    bool m_interactive = false;
+    qint64 m_interactiveNs = 0;
+    bool m_reportOnInteractive = false;
+};
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QPair>
+#include <QThreadPool>
+#include <QAtomicInteger>
+
+class OfflineQADatabase;
+class SearchHistory;
+
+/**
+ * Background autocomplete service
+ * - Computes suggestions on a private worker thread
+ * - Merges offline database and search history candidates by score
+ * - Drops results for input that has already changed
+ */
+class SuggestionEngine : public QObject {
+    Q_OBJECT
+
+public:
+    explicit SuggestionEngine(OfflineQADatabase* database, SearchHistory* history, QObject *parent = nullptr);
+    ~SuggestionEngine();
+
+    // Schedule a suggestion pass for text; supersedes any pass in flight
+    void requestSuggestions(const QString& text);
+
+    // Invalidate the pass in flight without starting a new one
+    void cancel();
+
+    void setMaxSuggestions(int count) { m_maxSuggestions = count; }
+
+signals:
+    void suggestionsReady(const QString& query, const QStringList& suggestions);
+
+private:
+    static QStringList mergeCandidates(const QVector<QPair<QString, double>>& databaseCandidates,
+                                       const QStringList& historyCandidates,
+                                       int limit);
+
+    OfflineQADatabase* m_database;
+    SearchHistory* m_history;
+    QThreadPool m_pool;
+    QAtomicInteger<quint64> m_generation;
+    int m_maxSuggestions;
+};
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <QObject>
+#include <QProxyStyle>
+#include <QPalette>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+
+/**
+ * Application style that draws the Beast/Best look from the palette
+ * - Rounded gradient buttons and rounded line edits without any QSS
+ * - Holds no theme state, so switching themes never requires a re-polish
+ */
+class ImilyaStyle : public QProxyStyle {
+    Q_OBJECT
+
+public:
+    ImilyaStyle();
+
+    void drawPrimitive(PrimitiveElement element, const QStyleOption* option,
+                       QPainter* painter, const QWidget* widget = nullptr) const override;
+    QSize sizeFromContents(ContentsType type, const QStyleOption* option,
+                           const QSize& size, const QWidget* widget = nullptr) const override;
+};
+
+/**
+ * Prebuilt themes switched by swapping the application palette
+ * - Palettes are built once at startup; a switch is a single setPalette
+ */
+class ThemeEngine : public QObject {
+    Q_OBJECT
+
+public:
+    static ThemeEngine* instance();
+
+    // Install the shared style once, before any window is created
+    void install();
+
+    void applyTheme(const QString& name);
+    QString currentTheme() const { return m_current; }
+    QStringList themeNames() const { return m_palettes.keys(); }
+    bool isDark(const QString& name) const { return name == "Beast"; }
+
+signals:
+    void themeChanged(const QString& name);
+
+private:
+    explicit ThemeEngine(QObject *parent = nullptr);
+
+    static QPalette buildBeastPalette();
+    static QPalette buildBestPalette();
+
+    QHash<QString, QPalette> m_palettes;
+    QString m_current;
+    bool m_installed;
+};
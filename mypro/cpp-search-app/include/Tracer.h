@@ -0,0 +1,65 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <atomic>
+
+/**
+ * Chrome trace-event recorder (--trace=<file>)
+ * - TraceSpan records a complete ("X") event for its scope; open the file
+ *   in chrome://tracing or ui.perfetto.dev
+ * - Each thread appends to its own buffer; the file is written once, when
+ *   the TraceSession ends
+ * - Disabled, a span costs one relaxed atomic load and a branch
+ * The clock starts during static initialization, so spans before main()
+ * returns line up with StartupTrace's phases.
+ */
+class Tracer {
+public:
+    static bool isEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+    // Nanoseconds since process start
+    static qint64 nowNs();
+
+    // name must outlive the trace (a string literal)
+    static void complete(const char* name, qint64 startNs, qint64 endNs);
+    static void complete(const QString& name, qint64 startNs, qint64 endNs);
+
+    static void start(const QString& filePath);
+    // Writes every recorded event and stops recording
+    static bool finish();
+
+    // Value of --trace=<file> or --trace <file>, read before any parser runs
+    static QString fileFromArguments(int argc, char* argv[]);
+
+private:
+    static std::atomic<bool> s_enabled;
+};
+
+// Traces the enclosing scope
+class TraceSpan {
+public:
+    explicit TraceSpan(const char* name)
+        : m_name(Tracer::isEnabled() ? name : nullptr)
+        , m_startNs(m_name ? Tracer::nowNs() : 0) {}
+    ~TraceSpan() {
+        if (m_name) Tracer::complete(m_name, m_startNs, Tracer::nowNs());
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    const char* m_name;
+    qint64 m_startNs;
+};
+
+// Starts tracing to filePath (if any) and writes the file when it goes out of scope
+class TraceSession {
+public:
+    explicit TraceSession(const QString& filePath);
+    ~TraceSession();
+
+    TraceSession(const TraceSession&) = delete;
+    TraceSession& operator=(const TraceSession&) = delete;
+};
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <QApplication>
+#include <QObject>
+#include <QString>
+#include <QHash>
+#include <QVector>
+#include <QElapsedTimer>
+#include "Metrics.h"
+
+/**
+ * UI frame-time and input-latency profiler
+ * - Frame time: cost of each top-level repaint (UpdateRequest)
+ * - Input latency: key press until the next completed repaint
+ * - Paint cost per widget, exclusive of nested paints (e.g. graphics effects)
+ * Hooks run only while enabled; disabled cost is one pointer check per event.
+ * Histograms are Metrics::Histogram (nanoseconds). The ones here cover the
+ * session since the last reset(); frame time and key-to-paint also go to the
+ * registry (ui_frame_seconds, ui_key_to_paint_seconds), which never resets.
+ */
+class UiProfiler : public QObject {
+    Q_OBJECT
+
+public:
+    struct WidgetCost {
+        QString name;
+        Metrics::Histogram histogram;
+    };
+
+    static UiProfiler* instance();
+
+    // Non-null only while profiling is enabled
+    static UiProfiler* active() { return s_active; }
+
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return s_active == this; }
+    void reset();
+
+    void beginEvent(QObject* receiver, QEvent* event);
+    void endEvent(QObject* receiver, QEvent* event);
+
+    const Metrics::Histogram& frameTimes() const { return m_frameTimes; }
+    const Metrics::Histogram& frameIntervals() const { return m_frameIntervals; }
+    const Metrics::Histogram& inputLatency() const { return m_inputLatency; }
+
+    // Widgets ordered by total paint time, most expensive first
+    QVector<const WidgetCost*> widgetCostsByTotal() const;
+
+    QByteArray exportJson() const;
+    QByteArray exportCsv() const;
+    bool exportToFile(const QString& filePath) const;
+
+private:
+    explicit UiProfiler(QObject *parent = nullptr);
+
+    struct OpenPaint {
+        qint64 start;
+        qint64 childTime;
+    };
+
+    static UiProfiler* s_active;
+
+    QElapsedTimer m_clock;
+    QVector<OpenPaint> m_paintStack;
+    qint64 m_frameStart;
+    qint64 m_lastFrameEnd;
+    qint64 m_pendingKeyPress;
+    Metrics::Histogram m_frameTimes;
+    Metrics::Histogram m_frameIntervals;
+    Metrics::Histogram m_inputLatency;
+    Metrics::Histogram& m_registryFrameTimes;
+    Metrics::Histogram& m_registryInputLatency;
+    QHash<QString, WidgetCost> m_widgetCosts;
+};
+
+/**
+ * QApplication that routes paint, repaint and key events through UiProfiler
+ */
+class ImilyaApplication : public QApplication {
+    Q_OBJECT
+
+public:
+    ImilyaApplication(int& argc, char** argv) : QApplication(argc, argv) {}
+
+    bool notify(QObject* receiver, QEvent* event) override;
+};
@@ -0,0 +1,107 @@
+#include "AnswerStore.h"
+#include "QueryIndex.h"
+#include "ServeProtocol.h"
+#include <QSaveFile>
+#include <cstring>
+
+namespace {
+constexpr char kMagic[4] = {'I', 'M', 'A', 'S'};
+constexpr quint32 kVersion = 1;
+constexpr qint64 kHeaderSize = 16; // magic, version, count, reserved
+}
+
+AnswerStore::~AnswerStore() {
+    close();
+}
+
+void AnswerStore::close() {
+    if (m_data) m_file.unmap(const_cast<uchar*>(m_data));
+    m_file.close();
+    m_data = nullptr;
+    m_offsets = nullptr;
+    m_size = 0;
+    m_count = 0;
+}
+
+bool AnswerStore::build(const QueryIndex& index, const QString& path) {
+    const quint32 count = quint32(index.size());
+    QVector<quint64> offsets(count + 1);
+    QByteArray records;
+    for (quint32 i = 0; i < count; ++i) {
+        const SearchResult& entry = index.entry(int(i));
+        const QByteArray title = entry.title.toUtf8().left(0xffff);
+        const QByteArray url = entry.url.toString().toUtf8().left(0xffff);
+        const QByteArray answer = entry.description.toUtf8();
+
+        ServeProtocol::RecordHeader header;
+        header.titleLength = quint16(title.size());
+        header.urlLength = quint16(url.size());
+        header.answerLength = quint32(answer.size());
+
+        offsets[i] = quint64(records.size());
+        records.append(reinterpret_cast<const char*>(&header), sizeof(header));
+        records += title;
+        records += url;
+        records += answer;
+    }
+    offsets[count] = quint64(records.size());
+
+    // Records start right after the offset table
+    const quint64 base = quint64(kHeaderSize) + quint64(offsets.size()) * sizeof(quint64);
+    for (quint64& offset : offsets) offset += base;
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        m_error = file.errorString();
+        return false;
+    }
+    const quint32 header[3] = {kVersion, count, 0};
+    file.write(kMagic, sizeof(kMagic));
+    file.write(reinterpret_cast<const char*>(header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(offsets.constData()), offsets.size() * qint64(sizeof(quint64)));
+    file.write(records);
+    if (!file.commit()) {
+        m_error = file.errorString();
+        return false;
+    }
+    return open(path);
+}
+
+bool AnswerStore::open(const QString& path) {
+    close();
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        m_error = m_file.errorString();
+        return false;
+    }
+    m_size = m_file.size();
+    m_data = m_size >= kHeaderSize ? m_file.map(0, m_size) : nullptr;
+    if (!m_data || std::memcmp(m_data, kMagic, sizeof(kMagic)) != 0) {
+        m_error = QString("%1 is not an answer store").arg(path);
+        close();
+        return false;
+    }
+
+    quint32 header[3];
+    std::memcpy(header, m_data + sizeof(kMagic), sizeof(header));
+    const qint64 tableEnd = kHeaderSize + (qint64(header[1]) + 1) * qint64(sizeof(quint64));
+    if (header[0] != kVersion || tableEnd > m_size) {
+        m_error = QString("%1 has an unsupported layout").arg(path);
+        close();
+        return false;
+    }
+    m_count = header[1];
+    m_offsets = reinterpret_cast<const quint64*>(m_data + kHeaderSize);
+    if (m_offsets[m_count] > quint64(m_size)) {
+        m_error = QString("%1 is truncated").arg(path);
+        close();
+        return false;
+    }
+    return true;
+}
+
+const char* AnswerStore::record(int entry, quint32* length) const {
+    if (!m_data || entry < 0 || quint32(entry) >= m_count) return nullptr;
+    *length = quint32(m_offsets[entry + 1] - m_offsets[entry]);
+    return reinterpret_cast<const char*>(m_data + m_offsets[entry]);
+}
@@ -0,0 +1,189 @@
+#include "BatchSearch.h"
+#include "QueryIndex.h"
+#include "SearchExplain.h"
+#include <QIODevice>
+#include <QHash>
+#include <QThread>
+#include <QThreadPool>
+#include <QElapsedTimer>
+#include <algorithm>
+
+void BatchSearch::appendJsonString(QByteArray& out, QStringView text) {
+    static const char hex[] = "0123456789abcdef";
+    out += '"';
+    for (char c : text.toUtf8()) {
+        switch (c) {
+        case '"': out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            if (uchar(c) < 0x20) {
+                out += "\\u00";
+                out += hex[uchar(c) >> 4];
+                out += hex[uchar(c) & 0xf];
+            } else {
+                out += c;
+            }
+        }
+    }
+    out += '"';
+}
+
+BatchSearch::BatchSearch(const QueryIndex& index)
+    : m_index(index)
+{
+    setThreadCount(0);
+
+    // Entries are immutable, so each is serialized once instead of per hit
+    m_entryJson.resize(index.size());
+    for (int i = 0; i < index.size(); ++i) {
+        const SearchResult& entry = index.entry(i);
+        QByteArray& json = m_entryJson[i];
+        json += "{\"title\":";
+        appendJsonString(json, entry.title);
+        json += ",\"url\":";
+        appendJsonString(json, entry.url.toString());
+        json += ",\"snippet\":";
+        appendJsonString(json, QStringView(entry.description).left(entry.snippetLength));
+        json += ",\"score\":";
+    }
+}
+
+void BatchSearch::setThreadCount(int threads) {
+    m_pool.setMaxThreadCount(threads > 0 ? threads : QThread::idealThreadCount());
+}
+
+QByteArray BatchSearch::resultsJson(const QString& normalizedQuery, int limit, bool explain) const {
+    QByteArray json = "[";
+    SearchExplain plan;
+    // One hits buffer per worker thread, reused for every query it answers
+    thread_local QVector<QueryIndex::Hit> hits;
+    m_index.search(normalizedQuery, limit, hits, explain ? &plan : nullptr);
+    for (int i = 0; i < hits.size(); ++i) {
+        if (i > 0) json += ',';
+        json += m_entryJson.at(hits[i].entry);
+        json += QByteArray::number(hits[i].score);
+        json += '}';
+    }
+    json += ']';
+    if (explain) {
+        plan.query = normalizedQuery;
+        json += ",\"explain\":";
+        json += plan.toJson();
+    }
+    return json;
+}
+
+QByteArray BatchSearch::answer(const QString& query, qint64 line) const {
+    QByteArray json = "{\"line\":" + QByteArray::number(line) + ",\"query\":";
+    appendJsonString(json, query);
+    json += ",\"results\":";
+    json += resultsJson(QueryIndex::normalize(query), m_limit, m_explain);
+    json += '}';
+    return json;
+}
+
+QByteArray BatchSearch::searchJson(const QString& query, int limit, bool explain) const {
+    QByteArray json = "{\"query\":";
+    appendJsonString(json, query);
+    json += ",\"results\":";
+    json += resultsJson(QueryIndex::normalize(query), qMax(1, limit), explain);
+    json += '}';
+    return json;
+}
+
+bool BatchSearch::run(QIODevice* input, QIODevice* output) {
+    QElapsedTimer timer;
+    timer.start();
+
+    QVector<QByteArray> lines;
+    lines.reserve(m_batchSize);
+    qint64 nextLine = 1;
+    QByteArray pending;
+    bool ok = true;
+
+    auto flush = [&]() {
+        ok = ok && processBatch(lines, nextLine, output);
+        nextLine += lines.size();
+        lines.clear();
+    };
+
+    for (;;) {
+        const QByteArray chunk = input->read(1 << 20);
+        if (chunk.isEmpty()) {
+            if (input->waitForReadyRead(-1)) continue;
+            break;
+        }
+        pending += chunk;
+        int start = 0;
+        for (int end = pending.indexOf('\n'); end >= 0; end = pending.indexOf('\n', start)) {
+            lines.append(pending.mid(start, end - start));
+            start = end + 1;
+            if (lines.size() >= m_batchSize) flush();
+        }
+        pending.remove(0, start);
+    }
+    if (!pending.isEmpty()) lines.append(pending);
+    if (!lines.isEmpty()) flush();
+
+    m_stats.elapsedNs += timer.nsecsElapsed();
+    return ok;
+}
+
+bool BatchSearch::processBatch(const QVector<QByteArray>& lines, qint64 firstLine, QIODevice* output) {
+    // Normalize each line once and answer each distinct query once
+    QVector<QString> queries(lines.size());
+    QVector<int> uniqueOf(lines.size(), -1);
+    QVector<QString> unique;
+    QHash<QString, int> seen;
+    seen.reserve(lines.size());
+    for (int i = 0; i < lines.size(); ++i) {
+        QByteArray line = lines.at(i);
+        if (line.endsWith('\r')) line.chop(1);
+        queries[i] = QString::fromUtf8(line);
+        const QString normalized = QueryIndex::normalize(queries[i]);
+        if (normalized.isEmpty()) continue;
+        auto it = seen.constFind(normalized);
+        if (it == seen.constEnd()) {
+            it = seen.insert(normalized, int(unique.size()));
+            unique.append(normalized);
+        }
+        uniqueOf[i] = it.value();
+    }
+
+    // Answer distinct queries in parallel; slots are disjoint so no locking
+    QVector<QByteArray> answers(unique.size());
+    const int threads = m_pool.maxThreadCount();
+    if (threads <= 1 || unique.size() < 64) {
+        for (int u = 0; u < unique.size(); ++u) answers[u] = resultsJson(unique.at(u), m_limit, m_explain);
+    } else {
+        // Several chunks per thread keep cores busy when some queries are slow
+        const int chunk = qMax(16, int(unique.size()) / (threads * 4));
+        for (int begin = 0; begin < unique.size(); begin += chunk) {
+            const int end = qMin(begin + chunk, int(unique.size()));
+            m_pool.start([this, &unique, &answers, begin, end]() {
+                for (int u = begin; u < end; ++u) answers[u] = resultsJson(unique.at(u), m_limit, m_explain);
+            });
+        }
+        m_pool.waitForDone();
+    }
+
+    // Write in input order
+    QByteArray out;
+    out.reserve(lines.size() * 256);
+    for (int i = 0; i < lines.size(); ++i) {
+        if (uniqueOf[i] < 0) continue; // blank line
+        out += "{\"line\":";
+        out += QByteArray::number(firstLine + i);
+        out += ",\"query\":";
+        appendJsonString(out, queries.at(i));
+        out += ",\"results\":";
+        out += answers.at(uniqueOf[i]);
+        out += "}\n";
+        ++m_stats.queries;
+    }
+    m_stats.uniqueQueries += unique.size();
+    return output->write(out) == out.size();
+}
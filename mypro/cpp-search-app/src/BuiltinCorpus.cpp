@@ -0,0 +1,290 @@
+#include "BuiltinCorpus.h"
+#include <QDateTime>
+#include <array>
+#include <iterator>
+
+namespace {
+
+// Questions must be lower-case, trimmed ASCII: lookups hash the normalized
+// query directly, without converting or allocating
+constexpr BuiltinCorpus::Entry kEntries[] = {
+    // ---- Greetings ----
+    // Basic greetings
+    {"hello", "Hello! How can I help you today? I'm your personal search assistant.", "Greetings"},
+    {"hi", "Hi there! Welcome to your search app. What would you like to know?", "Greetings"},
+    {"hey", "Hey! I'm here to help you find information. What's on your mind?", "Greetings"},
+    {"good morning", "Good morning! I hope you're having a great start to your day. How can I assist you?", "Greetings"},
+    {"good afternoon", "Good afternoon! I'm ready to help you with your search queries.", "Greetings"},
+    {"good evening", "Good evening! I'm here to help you find what you're looking for.", "Greetings"},
+    {"good night", "Good night! I hope you had a productive day. Feel free to ask if you need anything.", "Greetings"},
+    {"morning", "Good morning! How can I help you today?", "Greetings"},
+    {"afternoon", "Good afternoon! What would you like to search for?", "Greetings"},
+    {"evening", "Good evening! I'm here to help you.", "Greetings"},
+    {"night", "Good night! I hope you had a great day.", "Greetings"},
+
+    // Informal greetings
+    {"sup", "Sup! What's up with you? Need help finding something?", "Greetings"},
+    {"what's up", "Not much, just here to help you search! What do you need?", "Greetings"},
+    {"howdy", "Howdy! I'm your search partner. What can I help you find?", "Greetings"},
+    {"yo", "Yo! Ready to help you search. What's the plan?", "Greetings"},
+
+    // Polite greetings
+    {"greetings", "Greetings! I'm honored to assist you today. What would you like to know?", "Greetings"},
+    {"salutations", "Salutations! I'm here to help you find information. How may I assist?", "Greetings"},
+    {"good day", "Good day to you! I'm ready to help with your search needs.", "Greetings"},
+
+    // ---- Common questions ----
+    // Personal questions
+    {"how are you", "I'm doing great, thank you for asking! I'm a search assistant, so I'm always ready to help you find information. How about you?", "Personal"},
+    {"what's your name", "My name is Search Assistant! I'm here to help you find information quickly and efficiently.", "Personal"},
+    {"who are you", "I'm your personal search assistant, designed to help you find information both offline and online. I can answer common questions instantly and search the web when needed.", "Personal"},
+    {"what can you do", "I can do many things! I can answer common questions instantly, provide search suggestions, search multiple engines simultaneously, and even open results in your browser. I'm designed to be fast, responsive, and helpful.", "Personal"},
+
+    // Help requests
+    {"help", "I'm here to help! I can:\n• Answer common questions instantly\n• Search the web for you\n• Provide search suggestions\n• Open results in your browser\n\nJust type your question or search term and I'll assist you!", "Help"},
+    {"help me", "I'd be happy to help you! What do you need assistance with? I can answer questions, search the web, or provide guidance on how to use this app.", "Help"},
+    {"i need help", "No worries, I'm here to help! What can I assist you with today? Feel free to ask any question or search for any topic.", "Help"},
+    {"can you help", "Absolutely! I'm designed to help you find information quickly and easily. What do you need help with?", "Help"},
+
+    // App usage
+    {"how to use", "Using this app is simple:\n\n1. Type your question or search term in the search box\n2. Press Enter or click the search button\n3. I'll show you instant answers if available\n4. If no instant answer, I'll search the web for you\n5. Click any result to open it in your browser\n\nTry asking me something!", "Usage"},
+    {"how does this work", "This app works by combining offline knowledge with web search:\n\n• First, I check if I have an instant answer for your question\n• If not, I search multiple search engines simultaneously\n• I show you the best results with relevance scores\n• You can click any result to open it in your browser\n\nIt's designed to be fast and comprehensive!", "Usage"},
+    {"what is this app", "This is a smart search application that combines:\n\n• Instant offline answers for common questions\n• Multi-engine web search capabilities\n• Intelligent result ranking and filtering\n• Beautiful, responsive user interface\n• Fast search suggestions\n\nIt's designed to give you the best of both worlds - instant answers when possible, and comprehensive web search when needed.", "Usage"},
+
+    // ---- Technology ----
+    // Technology
+    {"what is ai", "AI (Artificial Intelligence) is technology that enables computers to perform tasks that typically require human intelligence, such as learning, reasoning, problem-solving, and understanding natural language.", "Technology"},
+    {"what is machine learning", "Machine Learning is a subset of AI that allows computers to learn and improve from experience without being explicitly programmed. It uses algorithms to identify patterns in data.", "Technology"},
+    {"what is programming", "Programming is the process of creating instructions for computers to follow. It involves writing code in programming languages to solve problems and create software applications.", "Technology"},
+    {"what is coding", "Coding is the act of writing computer programs using programming languages. It's how we communicate with computers to make them perform specific tasks.", "Technology"},
+
+    // Internet and Web
+    {"what is the internet", "The Internet is a global network of connected computers that allows people to share information, communicate, and access resources from anywhere in the world.", "Technology"},
+    {"what is a website", "A website is a collection of web pages hosted on the internet that can contain text, images, videos, and other content accessible through a web browser.", "Technology"},
+    {"what is a browser", "A web browser is software that allows you to access and view websites on the internet. Examples include Chrome, Firefox, Safari, and Edge.", "Technology"},
+
+    // Software
+    {"what is software", "Software is a set of instructions and data that tell a computer how to perform specific tasks. It includes applications, operating systems, and utilities.", "Technology"},
+    {"what is an app", "An app (application) is software designed to perform specific functions for users. Apps can run on computers, smartphones, tablets, and other devices.", "Technology"},
+    {"what is an operating system", "An operating system (OS) is software that manages computer hardware and software resources, providing common services for computer programs.", "Technology"},
+    // More technology Q&A
+    {"what is http", "HTTP (Hypertext Transfer Protocol) is an application protocol used for transmitting hypermedia documents, such as HTML.", "Technology"},
+    {"what is https", "HTTPS is HTTP over TLS/SSL, providing encryption and authentication for secure communication over networks.", "Technology"},
+    {"what is api", "An API (Application Programming Interface) is a set of rules that allow different software entities to communicate.", "Technology"},
+    {"what is rest", "REST (Representational State Transfer) is an architectural style for designing networked applications using stateless requests.", "Technology"},
+    {"what is graphql", "GraphQL is a query language for APIs that lets clients request exactly the data they need.", "Technology"},
+    {"what is database", "A database is an organized collection of structured information, typically stored electronically.", "Technology"},
+    {"what is sql", "SQL (Structured Query Language) is used to manage and query data in relational databases.", "Technology"},
+    {"what is nosql", "NoSQL databases provide flexible schemas and scale horizontally, suitable for large distributed data.", "Technology"},
+    {"what is cloud computing", "Cloud computing is the delivery of computing services over the internet on-demand and pay-as-you-go.", "Technology"},
+    {"what is docker", "Docker is a platform to build, ship, and run applications inside lightweight containers.", "Technology"},
+    {"what is kubernetes", "Kubernetes is an open-source system for automating deployment, scaling, and management of containerized applications.", "Technology"},
+    {"what is version control", "Version control tracks changes to files over time so you can recall specific versions later.", "Technology"},
+    {"what is git", "Git is a distributed version control system for tracking changes in source code.", "Technology"},
+    {"what is github", "GitHub is a platform for hosting Git repositories with collaboration features like pull requests and issues.", "Technology"},
+    {"what is python", "Python is a high-level, interpreted programming language known for readability and rich ecosystem.", "Programming"},
+    {"what is javascript", "JavaScript is a versatile language primarily used to create interactive behavior on web pages.", "Programming"},
+    {"what is c++", "C++ is a general-purpose programming language with object-oriented and generic programming features.", "Programming"},
+    {"what is java", "Java is a class-based, object-oriented programming language designed to have as few implementation dependencies as possible.", "Programming"},
+    {"what is html", "HTML (HyperText Markup Language) structures content on the web.", "Web"},
+    {"what is css", "CSS (Cascading Style Sheets) describes the presentation of HTML documents.", "Web"},
+
+    // ---- General knowledge ----
+    // Science
+    {"what is gravity", "Gravity is a fundamental force that attracts objects toward each other. On Earth, it pulls everything toward the center of the planet, which is why objects fall when dropped.", "Science"},
+    {"what is photosynthesis", "Photosynthesis is the process by which plants convert sunlight, carbon dioxide, and water into glucose and oxygen. It's how plants make their own food.", "Science"},
+    {"what is dna", "DNA (Deoxyribonucleic acid) is a molecule that carries genetic information and instructions for the development and functioning of living organisms.", "Science"},
+
+    // Geography
+    {"what is the capital of france", "The capital of France is Paris, known as the 'City of Light' and famous for its culture, art, fashion, and landmarks like the Eiffel Tower.", "Geography"},
+    {"what is the largest ocean", "The Pacific Ocean is the largest ocean on Earth, covering about 46% of the Earth's water surface and about one-third of its total surface area.", "Geography"},
+    {"what is the highest mountain", "Mount Everest is the highest mountain above sea level, with a peak elevation of 29,029 feet (8,848 meters) above sea level.", "Geography"},
+
+    // History
+    {"who invented the telephone", "Alexander Graham Bell is credited with inventing the first practical telephone in 1876, though there were earlier developments by other inventors.", "History"},
+    {"when was world war 2", "World War II lasted from 1939 to 1945, involving most of the world's nations and resulting in significant global changes.", "History"},
+    {"who was albert einstein", "Albert Einstein was a German-born theoretical physicist who developed the theory of relativity, one of the two pillars of modern physics. He won the Nobel Prize in Physics in 1921.", "History"},
+
+    // Math
+    {"what is pi", "Pi (π) is a mathematical constant representing the ratio of a circle's circumference to its diameter. Its approximate value is 3.14159, though it's an irrational number with infinite decimal places.", "Math"},
+    {"what is the square root", "The square root of a number is a value that, when multiplied by itself, gives the original number. For example, the square root of 16 is 4, because 4 × 4 = 16.", "Math"},
+    {"what is multiplication", "Multiplication is a mathematical operation that combines groups of equal size. It's essentially repeated addition. For example, 3 × 4 means adding 3 four times: 3 + 3 + 3 + 3 = 12.", "Math"},
+
+    // Language
+    {"what is a noun", "A noun is a word that names a person, place, thing, or idea. Examples include: person (John), place (Paris), thing (book), idea (freedom).", "Language"},
+    {"what is a verb", "A verb is a word that expresses an action, occurrence, or state of being. Examples include: run, jump, think, be, have.", "Language"},
+    {"what is an adjective", "An adjective is a word that describes or modifies a noun or pronoun. Examples include: big, red, happy, beautiful, intelligent.", "Language"},
+
+    // Health
+    {"what is exercise", "Exercise is physical activity that improves health, fitness, and overall well-being. It includes activities like walking, running, swimming, and strength training.", "Health"},
+    {"what is nutrition", "Nutrition is the science of how food affects the body. It involves understanding the nutrients in food and how they contribute to health and disease prevention.", "Health"},
+    {"what is sleep", "Sleep is a natural state of rest for the mind and body, essential for physical and mental health, memory consolidation, and overall well-being.", "Health"},
+
+    // Entertainment
+    {"what is music", "Music is an art form that uses sound and silence organized in time. It can include melody, harmony, rhythm, and timbre to create expressive and meaningful compositions.", "Entertainment"},
+    {"what is a movie", "A movie (or film) is a series of moving images shown on a screen, typically with accompanying sound, that tells a story or presents information.", "Entertainment"},
+    {"what is art", "Art is the expression or application of human creative skill and imagination, typically in visual form such as painting, sculpture, or other creative works.", "Entertainment"},
+
+    // Business
+    {"what is entrepreneurship", "Entrepreneurship is the process of starting and running a business, taking on financial risks in the hope of profit. Entrepreneurs identify opportunities and create value.", "Business"},
+    {"what is marketing", "Marketing is the process of promoting, selling, and distributing products or services. It involves understanding customer needs and creating strategies to meet them.", "Business"},
+    {"what is innovation", "Innovation is the process of creating new ideas, methods, or products that provide value. It often involves improving existing solutions or creating entirely new ones.", "Business"},
+
+    // Geography - more capitals
+    {"what is the capital of japan", "Tokyo is the capital of Japan, a bustling metropolis known for its technology and culture.", "Geography"},
+    {"what is the capital of india", "New Delhi is the capital of India, serving as the seat of all three branches of the Government of India.", "Geography"},
+    {"what is the capital of canada", "Ottawa is the capital of Canada, located in the province of Ontario.", "Geography"},
+
+    // Math - more
+    {"what is algebra", "Algebra is a branch of mathematics dealing with symbols and the rules for manipulating those symbols.", "Math"},
+    {"what is calculus", "Calculus is the mathematical study of continuous change, dealing with derivatives and integrals.", "Math"},
+};
+
+constexpr int kEntryCount = int(std::size(kEntries));
+
+// Two-level "hash and displace" perfect hash: the first-level hash picks a
+// bucket, and each bucket stores the seed that sends all of its keys to
+// free slots. Both tables are computed by the compiler.
+constexpr int kBucketCount = 32;
+constexpr int kSlotCount = 256;
+static_assert((kSlotCount & (kSlotCount - 1)) == 0, "slot count must be a power of two");
+static_assert(kEntryCount * 2 <= kSlotCount, "grow kSlotCount with the corpus");
+
+constexpr quint32 codeUnit(char c) { return quint8(c); }
+constexpr quint32 codeUnit(QChar c) { return c.unicode(); }
+
+// FNV-1a with a seeded basis and a murmur3 finalizer for well-mixed low bits
+template <typename Char>
+constexpr quint32 hashKey(const Char* key, int length, quint32 seed) {
+    quint32 h = 2166136261u ^ (seed * 0x9e3779b9u);
+    for (int i = 0; i < length; ++i) {
+        h ^= codeUnit(key[i]);
+        h *= 16777619u;
+    }
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
+}
+
+constexpr int keyLength(const char* key) {
+    int length = 0;
+    while (key[length]) ++length;
+    return length;
+}
+
+constexpr bool isNormalizedKey(const char* key) {
+    const int length = keyLength(key);
+    if (length == 0 || key[0] == ' ' || key[length - 1] == ' ') return false;
+    for (int i = 0; i < length; ++i) {
+        if (quint8(key[i]) > 0x7f || (key[i] >= 'A' && key[i] <= 'Z')) return false;
+    }
+    return true;
+}
+
+struct PerfectHash {
+    std::array<quint16, kBucketCount> seeds{};
+    std::array<qint16, kSlotCount> slots{}; // entry index, or -1
+    bool valid = false;
+};
+
+constexpr PerfectHash buildPerfectHash() {
+    PerfectHash table;
+    for (int slot = 0; slot < kSlotCount; ++slot) table.slots[slot] = -1;
+
+    std::array<int, kEntryCount> bucketOf{};
+    std::array<int, kBucketCount> bucketSize{};
+    for (int i = 0; i < kEntryCount; ++i) {
+        if (!isNormalizedKey(kEntries[i].question)) return table;
+        const char* key = kEntries[i].question;
+        bucketOf[i] = int(hashKey(key, keyLength(key), 0) % kBucketCount);
+        ++bucketSize[bucketOf[i]];
+    }
+
+    // Place the most crowded buckets first, while most slots are still free
+    std::array<int, kBucketCount> order{};
+    for (int b = 0; b < kBucketCount; ++b) order[b] = b;
+    for (int i = 1; i < kBucketCount; ++i) {
+        for (int j = i; j > 0 && bucketSize[order[j]] > bucketSize[order[j - 1]]; --j) {
+            const int tmp = order[j];
+            order[j] = order[j - 1];
+            order[j - 1] = tmp;
+        }
+    }
+
+    for (int o = 0; o < kBucketCount && bucketSize[order[o]] > 0; ++o) {
+        const int bucket = order[o];
+        bool placed = false;
+        for (quint32 seed = 1; seed < 0xffff && !placed; ++seed) {
+            std::array<int, kEntryCount> chosen{};
+            int count = 0;
+            bool fits = true;
+            for (int i = 0; i < kEntryCount && fits; ++i) {
+                if (bucketOf[i] != bucket) continue;
+                const char* key = kEntries[i].question;
+                const int slot = int(hashKey(key, keyLength(key), seed) & (kSlotCount - 1));
+                fits = table.slots[slot] < 0;
+                for (int k = 0; k < count && fits; ++k) fits = chosen[k] != slot;
+                chosen[count++] = slot;
+            }
+            if (!fits) continue;
+
+            count = 0;
+            for (int i = 0; i < kEntryCount; ++i) {
+                if (bucketOf[i] == bucket) table.slots[chosen[count++]] = qint16(i);
+            }
+            table.seeds[bucket] = quint16(seed);
+            placed = true;
+        }
+        if (!placed) return table; // duplicate question
+    }
+    table.valid = true;
+    return table;
+}
+
+constexpr PerfectHash kPerfectHash = buildPerfectHash();
+static_assert(kPerfectHash.valid, "built-in questions must be unique, lower-case, trimmed ASCII");
+
+}
+
+int BuiltinCorpus::count() {
+    return kEntryCount;
+}
+
+const BuiltinCorpus::Entry& BuiltinCorpus::entry(int index) {
+    return kEntries[index];
+}
+
+QLatin1String BuiltinCorpus::question(int index) {
+    return QLatin1String(kEntries[index].question);
+}
+
+int BuiltinCorpus::find(const QString& cleanQuery) {
+    const int length = int(cleanQuery.size());
+    const QChar* key = cleanQuery.constData();
+    for (int i = 0; i < length; ++i) {
+        // No built-in question has anything but ASCII in it
+        if (key[i].unicode() > 0x7f) return -1;
+    }
+    const quint32 bucket = hashKey(key, length, 0) % kBucketCount;
+    const quint32 slot = hashKey(key, length, kPerfectHash.seeds[bucket]) & (kSlotCount - 1);
+    const int index = kPerfectHash.slots[slot];
+    return index >= 0 && question(index) == cleanQuery ? index : -1;
+}
+
+SearchResult BuiltinCorpus::result(int index) {
+    const Entry& e = kEntries[index];
+    const QString category = QString::fromUtf8(e.category);
+    SearchResult result;
+    result.title = QString::fromLatin1(e.question);
+    result.description = QString::fromUtf8(e.answer);
+    result.url = "offline://" + category.toLower();
+    result.displayUrl = "Offline Answer - " + category;
+    result.sourceEngine = "Offline Database";
+    result.relevanceScore = 1.0;
+    result.timestamp = QDateTime::currentDateTime();
+    result.snippetLength = SearchResult::snippetBoundary(result.description);
+    return result;
+}
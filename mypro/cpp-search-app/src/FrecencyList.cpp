@@ -0,0 +1,167 @@
+#include "FrecencyList.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// A use a week ago counts half as much as one now
+constexpr double kHalfLifeMs = 7.0 * 24 * 3600 * 1000;
+}
+
+FrecencyList::FrecencyList(int capacity)
+    : m_capacity(qMax(1, capacity))
+{
+    m_slots.reserve(qMin(m_capacity, 1 << 16));
+}
+
+double FrecencyList::useRank(qint64 timestamp, quint32 count) {
+    return std::log2(double(qMax<quint32>(1, count))) + double(timestamp) / kHalfLifeMs;
+}
+
+double FrecencyList::combineRanks(double a, double b) {
+    // rank = log2(decayed uses) + t / halfLife, so adding the uses behind
+    // two ranks is a log-sum-exp; no decay to a common time is needed
+    if (a <= kNoRank) return b;
+    if (b <= kNoRank) return a;
+    const double high = qMax(a, b);
+    const double low = qMin(a, b);
+    return high + std::log2(1.0 + std::exp2(low - high));
+}
+
+double FrecencyList::rankOf(const QString& query) const {
+    auto it = m_slots.constFind(query);
+    return it == m_slots.constEnd() ? kNoRank : m_entries.at(it.value()).rank;
+}
+
+void FrecencyList::unlink(int slot) {
+    Entry& entry = m_entries[slot];
+    if (entry.prev >= 0) m_entries[entry.prev].next = entry.next;
+    else m_head = entry.next;
+    if (entry.next >= 0) m_entries[entry.next].prev = entry.prev;
+    else m_tail = entry.prev;
+    entry.prev = entry.next = -1;
+}
+
+void FrecencyList::pushFront(int slot) {
+    Entry& entry = m_entries[slot];
+    entry.prev = -1;
+    entry.next = m_head;
+    if (m_head >= 0) m_entries[m_head].prev = slot;
+    m_head = slot;
+    if (m_tail < 0) m_tail = slot;
+}
+
+void FrecencyList::touch(const QString& query, qint64 timestamp, quint32 count) {
+    if (count == 0) return;
+    auto it = m_slots.constFind(query);
+    int slot;
+    if (it != m_slots.constEnd()) {
+        slot = it.value();
+        unlink(slot);
+    } else {
+        if (m_slots.size() >= m_capacity) {
+            // Reuse the least recently used slot
+            slot = m_tail;
+            unlink(slot);
+            m_slots.remove(m_entries.at(slot).query);
+            ++m_entries[slot].version;
+        } else {
+            slot = int(m_entries.size());
+            m_entries.append(Entry());
+        }
+        Entry& entry = m_entries[slot];
+        entry.query = query;
+        entry.lowered = query.toLower();
+        entry.count = 0;
+        entry.lastUsed = 0;
+        m_slots.insert(query, slot);
+        if (m_added.size() / 2 >= m_capacity) {
+            // No lookups for a long while, so mostly stale refs: index every live
+            // slot afresh at the next lookup. O(n) once per n inserts at most.
+            m_sorted.clear();
+            m_added.clear();
+            for (int live = 0; live < m_entries.size(); ++live) {
+                m_added.append({live, m_entries.at(live).version});
+            }
+        } else {
+            m_added.append({slot, entry.version});
+        }
+    }
+
+    Entry& entry = m_entries[slot];
+    entry.rank = combineRanks(entry.count ? entry.rank : kNoRank, useRank(timestamp, count));
+    entry.count += count;
+    entry.lastUsed = qMax(entry.lastUsed, timestamp);
+    pushFront(slot);
+}
+
+void FrecencyList::clear() {
+    m_entries.clear();
+    m_slots.clear();
+    m_sorted.clear();
+    m_added.clear();
+    m_head = m_tail = -1;
+}
+
+QStringList FrecencyList::recent(int count) const {
+    QStringList queries;
+    for (int slot = m_head; slot >= 0 && queries.size() < count; slot = m_entries.at(slot).next) {
+        queries.append(m_entries.at(slot).query);
+    }
+    return queries;
+}
+
+QStringList FrecencyList::suggestions(const QString& prefix, int limit) const {
+    QStringList result;
+    for (const auto& candidate : ranked(prefix, limit)) result.append(candidate.first);
+    return result;
+}
+
+QVector<QPair<QString, double>> FrecencyList::ranked(const QString& prefix, int limit) const {
+    QVector<QPair<QString, double>> result;
+    const QString lowerPrefix = prefix.toLower();
+    if (limit <= 0) return result;
+
+    mergeIndex();
+
+    // Walk the sorted keys sharing the prefix, keeping the best limit matches in a small min-heap
+    QVector<const Entry*> best;
+    best.reserve(limit + 1);
+    auto worse = [](const Entry* a, const Entry* b) { return a->rank > b->rank; };
+    auto it = std::lower_bound(m_sorted.cbegin(), m_sorted.cend(), lowerPrefix,
+                               [this](const IndexRef& ref, const QString& key) {
+                                   return m_entries.at(ref.slot).lowered < key;
+                               });
+    for (; it != m_sorted.cend() && m_entries.at(it->slot).lowered.startsWith(lowerPrefix); ++it) {
+        const Entry& entry = m_entries.at(it->slot);
+        if (entry.query == prefix) continue;
+        if (best.size() < limit) {
+            best.append(&entry);
+            std::push_heap(best.begin(), best.end(), worse);
+        } else if (entry.rank > best.first()->rank) {
+            std::pop_heap(best.begin(), best.end(), worse);
+            best.last() = &entry;
+            std::push_heap(best.begin(), best.end(), worse);
+        }
+    }
+    std::sort_heap(best.begin(), best.end(), worse);
+    for (const Entry* entry : best) result.append({entry->query, entry->rank});
+    return result;
+}
+
+void FrecencyList::mergeIndex() const {
+    if (m_added.isEmpty()) return;
+    auto stale = [this](const IndexRef& ref) { return m_entries.at(ref.slot).version != ref.version; };
+    auto less = [this](const IndexRef& a, const IndexRef& b) {
+        return m_entries.at(a.slot).lowered < m_entries.at(b.slot).lowered;
+    };
+    m_sorted.erase(std::remove_if(m_sorted.begin(), m_sorted.end(), stale), m_sorted.end());
+    m_added.erase(std::remove_if(m_added.begin(), m_added.end(), stale), m_added.end());
+    std::sort(m_added.begin(), m_added.end(), less);
+
+    QVector<IndexRef> merged;
+    merged.reserve(m_sorted.size() + m_added.size());
+    std::merge(m_sorted.cbegin(), m_sorted.cend(), m_added.cbegin(), m_added.cend(),
+               std::back_inserter(merged), less);
+    m_sorted.swap(merged);
+    m_added.clear();
+}
@@ -0,0 +1,291 @@
+#include "HeadlessCli.h"
+#include "AnswerStore.h"
+#include "BatchSearch.h"
+#include "HttpServer.h"
+#include "Metrics.h"
+#include "OfflineQADatabase.h"
+#include "QueryIndex.h"
+#include "QueryServer.h"
+#include "ShardCoordinator.h"
+#include "Tracer.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+#include <csignal>
+#include <cstdio>
+
+namespace {
+
+QueryServer* s_queryServer = nullptr;
+HttpServer* s_httpServer = nullptr;
+
+void stopServers(int) {
+    if (s_queryServer) s_queryServer->stop();
+    if (s_httpServer) s_httpServer->stop();
+}
+
+void installStopHandlers() {
+    // Clients that hang up mid-response must not kill the daemon
+    std::signal(SIGPIPE, SIG_IGN);
+    std::signal(SIGINT, stopServers);
+    std::signal(SIGTERM, stopServers);
+}
+
+// Writes the metrics registry when the command finishes, however it returns
+class MetricsExport {
+public:
+    explicit MetricsExport(const QString& filePath) : m_filePath(filePath) {}
+    ~MetricsExport() {
+        if (!m_filePath.isEmpty() && !Metrics::instance()->exportToFile(m_filePath)) {
+            std::fprintf(stderr, "cannot write metrics to %s\n", qPrintable(m_filePath));
+        }
+    }
+
+private:
+    QString m_filePath;
+};
+
+int serve(const QueryIndex& index, const QString& socketPath, const QString& storePath, bool printStats) {
+    QElapsedTimer timer;
+    timer.start();
+    AnswerStore store;
+    if (!store.build(index, storePath)) {
+        std::fprintf(stderr, "cannot write answer store: %s\n", qPrintable(store.errorString()));
+        return 1;
+    }
+    const qint64 storeMs = timer.elapsed();
+
+    QueryServer server(index, store);
+    if (!server.listen(socketPath)) {
+        std::fprintf(stderr, "cannot serve: %s\n", qPrintable(server.errorString()));
+        return 1;
+    }
+    if (printStats) {
+        std::fprintf(stderr, "entries=%d store_ms=%lld socket=%s\n",
+                     index.size(), (long long)storeMs, qPrintable(socketPath));
+    }
+
+    s_queryServer = &server;
+    installStopHandlers();
+    const bool ok = server.run();
+    s_queryServer = nullptr;
+    if (!ok) std::fprintf(stderr, "server stopped: %s\n", qPrintable(server.errorString()));
+    return ok ? 0 : 1;
+}
+
+// One query per line in, one JSON line out, through the shard coordinator
+bool coordinate(ShardCoordinator& coordinator, QIODevice* input, QIODevice* output, bool printStats) {
+    QElapsedTimer timer;
+    timer.start();
+    qint64 queries = 0;
+    qint64 partial = 0;
+    qint64 line = 0;
+    bool ok = true;
+    for (;;) {
+        QByteArray text = input->readLine();
+        if (text.isEmpty()) break; // end of input; blank lines still carry '\n'
+        ++line;
+        while (text.endsWith('\n') || text.endsWith('\r')) text.chop(1);
+        const QString query = QString::fromUtf8(text);
+        if (QueryIndex::normalize(query).isEmpty()) continue;
+        int missing = 0;
+        const QByteArray json = coordinator.answer(query, line, &missing) + '\n';
+        ++queries;
+        if (missing > 0) ++partial;
+        if (output->write(json) != json.size()) {
+            ok = false;
+            break;
+        }
+    }
+    output->flush();
+    if (printStats) {
+        std::fprintf(stderr, "shards=%d queries=%lld partial=%lld elapsed_ms=%lld qps=%.0f\n",
+                     coordinator.shardCount(), (long long)queries, (long long)partial, (long long)timer.elapsed(),
+                     timer.elapsed() ? queries * 1000.0 / timer.elapsed() : 0.0);
+    }
+    return ok;
+}
+
+int serveHttp(HttpServer& server, const QString& address, bool printStats) {
+    if (!server.listen(address)) {
+        std::fprintf(stderr, "cannot serve HTTP: %s\n", qPrintable(server.errorString()));
+        return 1;
+    }
+    s_httpServer = &server;
+    installStopHandlers();
+    const bool ok = server.run();
+    s_httpServer = nullptr;
+    if (!ok) std::fprintf(stderr, "server stopped: %s\n", qPrintable(server.errorString()));
+    if (printStats) {
+        const HttpServer::Stats stats = server.stats();
+        std::fprintf(stderr, "requests=%llu served=%llu shed_queue_full=%llu shed_deadline=%llu rejected_connections=%llu\n",
+                     (unsigned long long)stats.requests, (unsigned long long)stats.served,
+                     (unsigned long long)stats.shedQueueFull, (unsigned long long)stats.shedDeadline,
+                     (unsigned long long)stats.rejectedConnections);
+    }
+    return ok ? 0 : 1;
+}
+
+}
+
+int HeadlessCli::run(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("Imilya Minds");
+    app.setApplicationVersion("1.0.0");
+    app.setOrganizationName("Imilya");
+    app.setOrganizationDomain("imilya.minds");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Answer queries from the offline database as JSON Lines");
+    parser.addHelpOption();
+    parser.addVersionOption();
+
+    QCommandLineOption searchOption(QStringList() << "s" << "search", "Answer a single query and exit", "query");
+    QCommandLineOption inputOption(QStringList() << "i" << "input", "Read queries from file instead of stdin", "file");
+    QCommandLineOption outputOption(QStringList() << "o" << "output", "Write results to file instead of stdout", "file");
+    QCommandLineOption limitOption("limit", "Results per query", "count", "10");
+    QCommandLineOption threadsOption("threads", "Worker threads (0 = one per core)", "count", "0");
+    QCommandLineOption batchOption("batch-size", "Queries read and answered per batch", "lines", "8192");
+    QCommandLineOption dataDirOption("data-dir", "Directory with the JSON/CSV data packs", "dir");
+    QCommandLineOption statsOption("stats", "Print load time and throughput to stderr");
+    QCommandLineOption metricsOption("metrics", "Write counters and latency histograms on exit (JSON for *.json, "
+                                     "else Prometheus text; - for stdout)", "file");
+    QCommandLineOption serveOption("serve", "Stay resident and answer binary queries on a Unix socket", "socket");
+    QCommandLineOption storeOption("store", "Answer store written for --serve (default: <socket>.store)", "file");
+    QCommandLineOption httpOption("http", "Stay resident and answer HTTP on [ipv4:]port (default host 127.0.0.1)", "address");
+    QCommandLineOption queueOption("http-queue", "Searches queued or running before --http sheds load", "jobs", "1024");
+    QCommandLineOption deadlineOption("http-deadline", "Queue wait after which --http sheds a search", "ms", "250");
+    QCommandLineOption connectionsOption("http-connections", "Open connections --http accepts", "count", "4096");
+    QCommandLineOption shardOption("shard", "Load only shard i of n of the corpus (for --serve)", "i/n");
+    QCommandLineOption shardsOption("shards", "Answer by fanning out to these --serve shard sockets", "socket,...");
+    QCommandLineOption shardTimeoutOption("shard-timeout", "Per-query wait for --shards before answering without a shard", "ms", "50");
+    // Accepted for compatibility with the GUI's command line
+    QCommandLineOption explainOption("explain", "Add each query's plan and cost breakdown to its answer "
+                                                "(and print it as a table to stderr for --search)");
+    QCommandLineOption noGuiOption("no-gui", "Run without GUI (always the case here)");
+    // Recorded and written by main()
+    QCommandLineOption traceOption("trace", "Write a Chrome trace of the run", "file");
+    QCommandLineOption engineOption(QStringList() << "e" << "engine", "Ignored in offline-only mode", "engine");
+    for (const QCommandLineOption& option : {searchOption, inputOption, outputOption, limitOption, threadsOption,
+                                             batchOption, dataDirOption, statsOption, metricsOption, serveOption, storeOption,
+                                             httpOption, queueOption, deadlineOption, connectionsOption,
+                                             shardOption, shardsOption, shardTimeoutOption, explainOption, noGuiOption,
+                                             traceOption, engineOption}) {
+        parser.addOption(option);
+    }
+    parser.process(app);
+
+    const MetricsExport metricsExport(parser.value(metricsOption));
+    if (parser.isSet(dataDirOption)) {
+        qputenv("IMILYA_DATA_DIR", parser.value(dataDirOption).toLocal8Bit());
+    }
+
+    QFile output;
+    QFile input;
+    auto openOutput = [&]() {
+        bool outputOpen = false;
+        if (parser.isSet(outputOption)) {
+            output.setFileName(parser.value(outputOption));
+            outputOpen = output.open(QIODevice::WriteOnly | QIODevice::Truncate);
+        } else {
+            outputOpen = output.open(stdout, QIODevice::WriteOnly);
+        }
+        if (!outputOpen) std::fprintf(stderr, "cannot open output: %s\n", qPrintable(output.errorString()));
+        return outputOpen;
+    };
+    auto openInput = [&]() {
+        bool inputOpen = false;
+        if (parser.isSet(inputOption)) {
+            input.setFileName(parser.value(inputOption));
+            inputOpen = input.open(QIODevice::ReadOnly);
+        } else {
+            inputOpen = input.open(stdin, QIODevice::ReadOnly);
+        }
+        if (!inputOpen) std::fprintf(stderr, "cannot open input: %s\n", qPrintable(input.errorString()));
+        return inputOpen;
+    };
+
+    if (parser.isSet(shardsOption)) {
+        ShardCoordinator coordinator(parser.value(shardsOption).split(',', Qt::SkipEmptyParts));
+        coordinator.setLimit(parser.value(limitOption).toInt());
+        coordinator.setTimeout(parser.value(shardTimeoutOption).toInt());
+        if (!coordinator.connectShards()) {
+            std::fprintf(stderr, "%s\n", qPrintable(coordinator.errorString()));
+            return 1;
+        }
+        if (!openOutput()) return 1;
+        if (parser.isSet(searchOption)) {
+            output.write(coordinator.answer(parser.value(searchOption)) + '\n');
+            return 0;
+        }
+        return openInput() && coordinate(coordinator, &input, &output, parser.isSet(statsOption)) ? 0 : 1;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    QueryIndex index;
+    {
+        // The index keeps what it needs; the database's own tables go away here
+        TraceSpan span("HeadlessCli load");
+        OfflineQADatabase database;
+        if (parser.isSet(shardOption)) {
+            const QStringList shard = parser.value(shardOption).split('/');
+            database.setShard(shard.value(0).toInt(), shard.value(1).toInt());
+        }
+        database.loadExternalDataSync();
+        index.build(database);
+    }
+    const qint64 loadMs = timer.elapsed();
+
+    if (parser.isSet(serveOption)) {
+        if (parser.isSet(statsOption)) {
+            std::fprintf(stderr, "load_ms=%lld\n", (long long)loadMs);
+        }
+        const QString socketPath = parser.value(serveOption);
+        const QString storePath = parser.isSet(storeOption) ? parser.value(storeOption) : socketPath + ".store";
+        return serve(index, socketPath, storePath, parser.isSet(statsOption));
+    }
+
+    BatchSearch batch(index);
+    batch.setLimit(parser.value(limitOption).toInt());
+    batch.setThreadCount(parser.value(threadsOption).toInt());
+    batch.setBatchSize(parser.value(batchOption).toInt());
+    batch.setExplain(parser.isSet(explainOption));
+
+    if (parser.isSet(httpOption)) {
+        if (parser.isSet(statsOption)) {
+            std::fprintf(stderr, "entries=%d load_ms=%lld\n", index.size(), (long long)loadMs);
+        }
+        HttpServer server(index, batch);
+        server.setThreadCount(parser.value(threadsOption).toInt());
+        server.setQueueLimit(parser.value(queueOption).toInt());
+        server.setDeadline(parser.value(deadlineOption).toInt());
+        server.setMaxConnections(parser.value(connectionsOption).toInt());
+        return serveHttp(server, parser.value(httpOption), parser.isSet(statsOption));
+    }
+
+    if (!openOutput()) return 1;
+    if (parser.isSet(searchOption)) {
+        output.write(batch.answer(parser.value(searchOption)) + '\n');
+        if (parser.isSet(explainOption)) {
+            SearchExplain plan;
+            plan.query = parser.value(searchOption);
+            index.search(QueryIndex::normalize(plan.query), qMax(1, parser.value(limitOption).toInt()), &plan);
+            std::fputs(qPrintable(plan.toText()), stderr);
+        }
+        return 0;
+    }
+    if (!openInput()) return 1;
+
+    const bool ok = batch.run(&input, &output);
+    output.flush();
+
+    if (parser.isSet(statsOption)) {
+        const BatchSearch::Stats& stats = batch.stats();
+        std::fprintf(stderr, "entries=%d load_ms=%lld queries=%lld unique=%lld elapsed_ms=%.1f qps=%.0f\n",
+                     index.size(), (long long)loadMs, (long long)stats.queries, (long long)stats.uniqueQueries,
+                     stats.elapsedNs / 1e6, stats.queriesPerSecond());
+    }
+    return ok ? 0 : 1;
+}
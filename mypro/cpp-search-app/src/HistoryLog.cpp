@@ -0,0 +1,260 @@
+#include "HistoryLog.h"
+#include "HistoryStore.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QLockFile>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QThread>
+
+#ifdef Q_OS_UNIX
+#include <unistd.h>
+#endif
+
+namespace {
+// A burst of searches within this window shares one write and one fsync
+constexpr int kGroupCommitMs = 20;
+// Compact once the log reaches 1/16 of the store, within these bounds: the
+// upper one caps what a cold start replays, the lower one keeps small
+// histories from compacting on every search
+constexpr qint64 kMinCompactBytes = 64 * 1024;
+constexpr qint64 kMaxCompactBytes = 4 * 1024 * 1024;
+constexpr int kLockTimeoutMs = 2000;
+
+// Durable before the lock is released, so the next instance reads it whole
+void syncFile(QFile& file) {
+    file.flush();
+#ifdef Q_OS_UNIX
+    ::fsync(file.handle());
+#endif
+}
+
+QByteArray markerLine(quint64 generation) {
+    return QByteArray::number(generation) + "\t-1\t\n";
+}
+
+// Store generation named by the log's first line; logs from before the store name none
+quint64 markerGeneration(const QByteArray& log) {
+    const qsizetype tab = log.indexOf('\t');
+    const qsizetype end = log.indexOf('\n');
+    if (tab < 0 || end < tab || log.mid(tab, 4) != "\t-1\t") return 0;
+    return log.left(tab).toULongLong();
+}
+
+// The part of log a store of this generation has not folded in
+QByteArray unfolded(const QByteArray& log, quint64 generation, quint64 foldedLogBytes) {
+    const quint64 logGeneration = markerGeneration(log);
+    if (logGeneration == generation) return log;
+    // A compaction committed the store but never restarted the log: only its tail is new
+    if (logGeneration + 1 == generation && foldedLogBytes <= quint64(log.size())) {
+        return log.mid(qsizetype(foldedLogBytes));
+    }
+    return QByteArray();
+}
+
+bool rewrite(const QString& filePath, const QByteArray& data) {
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) return false;
+    file.write(data);
+    return file.commit();
+}
+}
+
+HistoryLog::HistoryLog(const QString& filePath, const QString& storePath)
+    : m_filePath(filePath)
+    , m_storePath(storePath)
+    , m_stopping(false)
+{
+    updateCompactThreshold();
+    m_writer = QThread::create([this]() { writerLoop(); });
+    m_writer->setObjectName("HistoryLogWriter");
+    m_writer->start(QThread::LowPriority);
+}
+
+HistoryLog::~HistoryLog() {
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stopping = true;
+        m_wake.wakeOne();
+    }
+    m_writer->wait();
+    delete m_writer;
+}
+
+void HistoryLog::append(const QString& query, qint64 timestamp, int count) {
+    QMutexLocker locker(&m_mutex);
+    // Only the first record of a batch needs to wake the writer
+    const bool wake = m_pending.isEmpty();
+    m_pending.append({timestamp, count, query});
+    if (wake) m_wake.wakeOne();
+}
+
+void HistoryLog::appendClear(qint64 timestamp) {
+    append(QString(), timestamp, 0);
+}
+
+void HistoryLog::flush() {
+    QVector<Record> batch;
+    {
+        QMutexLocker locker(&m_mutex);
+        batch.swap(m_pending);
+    }
+    if (!batch.isEmpty() && !commit(batch, kLockTimeoutMs)) requeue(batch);
+}
+
+void HistoryLog::requeue(const QVector<Record>& records) {
+    QMutexLocker locker(&m_mutex);
+    // In front, so records stay in the order they were appended
+    m_pending = records + m_pending;
+    m_wake.wakeOne();
+}
+
+void HistoryLog::writerLoop() {
+    QMutexLocker locker(&m_mutex);
+    for (;;) {
+        while (m_pending.isEmpty() && !m_stopping) m_wake.wait(&m_mutex);
+        if (m_pending.isEmpty()) return;
+        // Let the rest of a burst queue up behind the first record
+        if (!m_stopping) m_wake.wait(&m_mutex, kGroupCommitMs);
+
+        QVector<Record> batch;
+        batch.swap(m_pending);
+        // The last commit before shutdown waits for the lock however long
+        // it takes (QLockFile breaks a dead holder's lock); earlier ones retry
+        const int timeoutMs = m_stopping ? -1 : kLockTimeoutMs;
+        locker.unlock();
+        const bool committed = commit(batch, timeoutMs);
+        locker.relock();
+        if (!committed) m_pending = batch + m_pending;
+    }
+}
+
+void HistoryLog::serialize(const Record& record, QByteArray& out) {
+    QString query = record.query;
+    query.replace('\t', ' ').replace('\n', ' ').replace('\r', ' ');
+    out += QByteArray::number(record.timestamp);
+    out += '\t';
+    out += QByteArray::number(record.count);
+    out += '\t';
+    out += query.toUtf8();
+    out += '\n';
+}
+
+QVector<HistoryLog::Record> HistoryLog::parse(const QByteArray& data) {
+    QVector<Record> records;
+    qsizetype start = 0;
+    for (qsizetype end = data.indexOf('\n'); end >= 0; end = data.indexOf('\n', start)) {
+        const QByteArray line = data.mid(start, end - start);
+        start = end + 1;
+        const qsizetype firstTab = line.indexOf('\t');
+        const qsizetype secondTab = firstTab < 0 ? -1 : line.indexOf('\t', firstTab + 1);
+        if (secondTab < 0) continue; // not one of ours; skip rather than fail the whole history
+        bool timestampOk = false;
+        bool countOk = false;
+        Record record;
+        record.timestamp = line.left(firstTab).toLongLong(&timestampOk);
+        record.count = line.mid(firstTab + 1, secondTab - firstTab - 1).toInt(&countOk);
+        record.query = QString::fromUtf8(line.mid(secondTab + 1));
+        if (timestampOk && countOk && record.count >= 0) records.append(record);
+    }
+    return records;
+}
+
+QVector<HistoryLog::Record> HistoryLog::load(HistoryStore& store) const {
+    // Store and log are read under one lock, so no compaction can fall between them
+    QLockFile lock(m_filePath + ".lock");
+    const bool locked = lock.tryLock(kLockTimeoutMs);
+    for (int attempt = 0;; ++attempt) {
+        store.open(m_storePath);
+        QFile file(m_filePath);
+        const QByteArray log = file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+        // Without the lock (its holder is slow to let go), a compaction may have
+        // restarted the log after the store was mapped: a log ahead of the store
+        // means the store is stale, so map it again. Both files are replaced by
+        // rename, so each read sees a whole file.
+        if (locked || markerGeneration(log) <= store.generation() || attempt == 3) {
+            return parse(unfolded(log, store.generation(), store.foldedLogBytes()));
+        }
+    }
+}
+
+void HistoryLog::updateCompactThreshold() {
+    m_compactThreshold = qBound(kMinCompactBytes, QFileInfo(m_storePath).size() / 16, kMaxCompactBytes);
+}
+
+bool HistoryLog::commit(const QVector<Record>& records, int timeoutMs) {
+    if (records.isEmpty()) return true;
+    QByteArray data;
+    for (const Record& record : records) serialize(record, data);
+
+    QMutexLocker commitLocker(&m_commitMutex);
+    // Another instance may be appending or compacting; wait for it rather than interleave bytes
+    QLockFile lock(m_filePath + ".lock");
+    if (!lock.tryLock(timeoutMs)) return false;
+
+    // A log behind the store is what an interrupted compaction left; restart it first
+    quint64 generation = 0;
+    quint64 foldedLogBytes = 0;
+    HistoryStore::peek(m_storePath, &generation, &foldedLogBytes);
+    {
+        QFile current(m_filePath);
+        if (current.open(QIODevice::ReadOnly)) {
+            const QByteArray head = current.readLine(64);
+            if (markerGeneration(head) != generation) {
+                current.seek(0);
+                const QByteArray log = current.readAll();
+                current.close();
+                rewrite(m_filePath, markerLine(generation) + unfolded(log, generation, foldedLogBytes));
+            }
+        } else if (generation > 0) {
+            rewrite(m_filePath, markerLine(generation));
+        }
+    }
+
+    // Opened per commit: a handle kept open would still point at the old
+    // file after another instance compacts it
+    QFile file(m_filePath);
+    // An unwritable history file is not contention; retrying would not help
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) return true;
+    file.write(data);
+    syncFile(file);
+    const qint64 size = file.size();
+    file.close();
+
+    if (size > m_compactThreshold) compact(lock);
+    return true;
+}
+
+void HistoryLog::compact(QLockFile& lock) {
+    HistoryStore base;
+    QFile file(m_filePath);
+    if (!base.open(m_storePath) || !file.open(QIODevice::ReadOnly)) return;
+    const QByteArray log = file.readAll();
+    file.close();
+    // Whole lines only; a torn tail stays in the log
+    const qsizetype folded = log.lastIndexOf('\n') + 1;
+    const QVector<Record> records = parse(log.left(folded));
+
+    // Writing a large store takes a while; other instances keep appending meanwhile
+    lock.unlock();
+    QSaveFile store(m_storePath);
+    const bool written = store.open(QIODevice::WriteOnly)
+        && HistoryStore::write(store, base, records, quint64(folded));
+    if (!lock.tryLock(kLockTimeoutMs) || !written) return;
+
+    // Give up if another instance compacted first: its store already holds these records
+    quint64 generation = 0;
+    quint64 ignored = 0;
+    HistoryStore::peek(m_storePath, &generation, &ignored);
+    if (!file.open(QIODevice::ReadOnly)) return;
+    const QByteArray current = file.readAll();
+    file.close();
+    if (generation != base.generation() || !current.startsWith(QByteArrayView(log.constData(), folded))) {
+        store.cancelWriting();
+        return;
+    }
+    // Store first: if the log restart is lost, the marker still tells which part was folded
+    if (!store.commit()) return;
+    rewrite(m_filePath, markerLine(generation + 1) + current.mid(folded));
+    updateCompactThreshold();
+}
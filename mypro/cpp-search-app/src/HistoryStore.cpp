@@ -0,0 +1,441 @@
+#include "HistoryStore.h"
+#include "FrecencyList.h"
+#include <QHash>
+#include <QIODevice>
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <queue>
+#include <vector>
+
+namespace {
+constexpr char kMagic[4] = {'I', 'M', 'H', 'S'};
+constexpr quint32 kVersion = 1;
+// Records per segment tree leaf: a leaf is scanned, not indexed further
+constexpr quint32 kBlockSize = 64;
+constexpr quint32 kRecentLength = 1024;
+constexpr int kWriteChunk = 1 << 20;
+
+struct Header {
+    char magic[4];
+    quint32 version;
+    quint32 count;
+    quint32 leafCount;      // power of two, >= blocks of records
+    quint32 recentCount;
+    quint32 reserved;
+    quint64 generation;
+    quint64 foldedLogBytes;
+    quint64 poolOffset;
+    quint64 poolSize;
+    quint64 treeOffset;     // double[2 * leafCount], node 1 is the root
+    quint64 recentOffset;   // quint32[recentCount], record indices
+};
+static_assert(sizeof(Header) == 72, "history store header must stay 72 bytes");
+
+struct StoredRecord {
+    quint64 offset;         // into the pool: lowered key, then the query as typed
+    quint32 keyLength;
+    quint32 textLength;
+    quint32 count;
+    quint32 reserved;
+    qint64 lastUsed;
+    double rank;
+};
+static_assert(sizeof(StoredRecord) == 40, "history store records must stay 40 bytes");
+
+// Both the stored and the folded side of a compaction, as the merge sees them
+struct Merged {
+    const char* key;
+    quint32 keyLength;
+    const char* text;
+    quint32 textLength;
+    quint32 count;
+    qint64 lastUsed;
+    double rank;
+};
+
+struct Folded {
+    QByteArray key;
+    QByteArray text;
+    quint32 count;
+    qint64 lastUsed;
+    double rank;
+};
+
+int compareBytes(const char* a, quint32 aLength, const char* b, quint32 bLength) {
+    const int order = std::memcmp(a, b, qMin(aLength, bLength));
+    if (order != 0) return order;
+    return aLength < bLength ? -1 : (aLength > bLength ? 1 : 0);
+}
+
+// Store order: lowered key, then the query as typed
+int compareEntries(const Merged& a, const Merged& b) {
+    const int order = compareBytes(a.key, a.keyLength, b.key, b.keyLength);
+    return order != 0 ? order : compareBytes(a.text, a.textLength, b.text, b.textLength);
+}
+
+quint64 alignTo8(quint64 offset) {
+    return (offset + 7) & ~quint64(7);
+}
+}
+
+HistoryStore::~HistoryStore() {
+    close();
+}
+
+void HistoryStore::close() {
+    if (m_data) m_file.unmap(const_cast<uchar*>(m_data));
+    m_file.close();
+    m_data = nullptr;
+    m_size = 0;
+    m_count = m_leafCount = m_recentCount = 0;
+    m_generation = 0;
+    m_foldedLogBytes = 0;
+    m_records = nullptr;
+    m_pool = nullptr;
+    m_tree = nullptr;
+    m_recent = nullptr;
+}
+
+bool HistoryStore::open(const QString& path) {
+    close();
+    m_file.setFileName(path);
+    if (!m_file.exists()) return true;
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        m_error = m_file.errorString();
+        return false;
+    }
+    m_size = m_file.size();
+    m_data = m_size >= qint64(sizeof(Header)) ? m_file.map(0, m_size) : nullptr;
+    if (!m_data || std::memcmp(m_data, kMagic, sizeof(kMagic)) != 0) {
+        m_error = QString("%1 is not a history store").arg(path);
+        close();
+        return false;
+    }
+
+    Header header;
+    std::memcpy(&header, m_data, sizeof(header));
+    const quint64 recordsEnd = sizeof(Header) + quint64(header.count) * sizeof(StoredRecord);
+    const quint64 treeEnd = header.treeOffset + 2 * quint64(header.leafCount) * sizeof(double);
+    const quint64 recentEnd = header.recentOffset + quint64(header.recentCount) * sizeof(quint32);
+    if (header.version != kVersion || header.leafCount == 0
+        || quint64(header.leafCount) * kBlockSize < header.count
+        || header.poolOffset < recordsEnd || header.poolOffset + header.poolSize > header.treeOffset
+        || treeEnd > header.recentOffset || recentEnd > quint64(m_size)) {
+        m_error = QString("%1 has an unsupported layout").arg(path);
+        close();
+        return false;
+    }
+    m_count = header.count;
+    m_leafCount = header.leafCount;
+    m_recentCount = header.recentCount;
+    m_generation = header.generation;
+    m_foldedLogBytes = header.foldedLogBytes;
+    m_records = m_data + sizeof(Header);
+    m_pool = reinterpret_cast<const char*>(m_data + header.poolOffset);
+    m_tree = reinterpret_cast<const double*>(m_data + header.treeOffset);
+    m_recent = reinterpret_cast<const quint32*>(m_data + header.recentOffset);
+    return true;
+}
+
+void HistoryStore::peek(const QString& path, quint64* generation, quint64* foldedLogBytes) {
+    QFile file(path);
+    Header header;
+    if (!file.open(QIODevice::ReadOnly)
+        || file.read(reinterpret_cast<char*>(&header), sizeof(header)) != qint64(sizeof(header))
+        || std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+        header.generation = 0;
+        header.foldedLogBytes = 0;
+    }
+    *generation = header.generation;
+    *foldedLogBytes = header.foldedLogBytes;
+}
+
+QString HistoryStore::textAt(quint32 index) const {
+    const StoredRecord* record = reinterpret_cast<const StoredRecord*>(m_records) + index;
+    return QString::fromUtf8(m_pool + record->offset + record->keyLength, int(record->textLength));
+}
+
+QVector<QPair<QString, double>> HistoryStore::ranked(const QString& prefix, int limit) const {
+    QVector<QPair<QString, double>> result;
+    if (m_count == 0 || limit <= 0) return result;
+    const StoredRecord* records = reinterpret_cast<const StoredRecord*>(m_records);
+    const QByteArray key = prefix.toLower().toUtf8();
+    const QByteArray exact = prefix.toUtf8();
+    const quint32 keyLength = quint32(key.size());
+
+    // Matching keys are contiguous: [first key >= prefix, first key past every key starting with it)
+    auto keyOf = [this, records](quint32 i) { return m_pool + records[i].offset; };
+    quint32 low = 0;
+    quint32 high = m_count;
+    {
+        quint32 first = 0, count = m_count;
+        while (count > 0) {
+            const quint32 step = count / 2;
+            if (compareBytes(keyOf(first + step), records[first + step].keyLength, key.constData(), keyLength) < 0) {
+                first += step + 1;
+                count -= step + 1;
+            } else {
+                count = step;
+            }
+        }
+        low = first;
+        count = m_count - low;
+        while (count > 0) {
+            const quint32 step = count / 2;
+            const quint32 i = first + step;
+            if (compareBytes(keyOf(i), qMin(records[i].keyLength, keyLength), key.constData(), keyLength) <= 0) {
+                first += step + 1;
+                count -= step + 1;
+            } else {
+                count = step;
+            }
+        }
+        high = first;
+    }
+    if (low >= high) return result;
+
+    // Best first over tree nodes and single records: a node stands for every
+    // record below it, so the first limit records popped are the best of the range
+    struct Candidate {
+        double rank;
+        quint32 index;
+        bool isRecord;
+        bool operator<(const Candidate& other) const { return rank < other.rank; }
+    };
+    std::priority_queue<Candidate> frontier;
+    auto pushRecords = [&](quint32 begin, quint32 end) {
+        for (quint32 i = begin; i < end; ++i) frontier.push({records[i].rank, i, true});
+    };
+    auto pushNode = [&](quint32 node) {
+        if (m_tree[node] > FrecencyList::kNoRank) frontier.push({m_tree[node], node, false});
+    };
+
+    const quint32 firstBlock = low / kBlockSize;
+    const quint32 lastBlock = (high - 1) / kBlockSize;
+    if (firstBlock == lastBlock) {
+        pushRecords(low, high);
+    } else {
+        // Partial blocks at either end are scanned; whole blocks go through the tree
+        quint32 fullBegin = firstBlock;
+        quint32 fullEnd = lastBlock + 1;
+        if (low % kBlockSize != 0) {
+            pushRecords(low, (firstBlock + 1) * kBlockSize);
+            ++fullBegin;
+        }
+        if (high % kBlockSize != 0) {
+            pushRecords(lastBlock * kBlockSize, high);
+            --fullEnd;
+        }
+        for (quint32 l = fullBegin + m_leafCount, r = fullEnd + m_leafCount; l < r; l >>= 1, r >>= 1) {
+            if (l & 1) pushNode(l++);
+            if (r & 1) pushNode(--r);
+        }
+    }
+
+    while (!frontier.empty() && result.size() < limit) {
+        const Candidate best = frontier.top();
+        frontier.pop();
+        if (best.isRecord) {
+            const StoredRecord& record = records[best.index];
+            const char* text = m_pool + record.offset + record.keyLength;
+            if (compareBytes(text, record.textLength, exact.constData(), quint32(exact.size())) == 0) continue;
+            result.append({QString::fromUtf8(text, int(record.textLength)), record.rank});
+        } else if (best.index < m_leafCount) {
+            pushNode(2 * best.index);
+            pushNode(2 * best.index + 1);
+        } else {
+            const quint32 block = best.index - m_leafCount;
+            pushRecords(block * kBlockSize, qMin(m_count, (block + 1) * kBlockSize));
+        }
+    }
+    return result;
+}
+
+double HistoryStore::rankOf(const QString& query) const {
+    if (m_count == 0) return FrecencyList::kNoRank;
+    const StoredRecord* records = reinterpret_cast<const StoredRecord*>(m_records);
+    const QByteArray key = query.toLower().toUtf8();
+    const QByteArray text = query.toUtf8();
+    const Merged wanted = {key.constData(), quint32(key.size()), text.constData(), quint32(text.size()), 0, 0, 0.0};
+    auto view = [this, records](quint32 i) {
+        const StoredRecord& record = records[i];
+        const char* key = m_pool + record.offset;
+        return Merged{key, record.keyLength, key + record.keyLength, record.textLength, 0, 0, 0.0};
+    };
+
+    quint32 first = 0, count = m_count;
+    while (count > 0) {
+        const quint32 step = count / 2;
+        if (compareEntries(view(first + step), wanted) < 0) {
+            first += step + 1;
+            count -= step + 1;
+        } else {
+            count = step;
+        }
+    }
+    if (first < m_count && compareEntries(view(first), wanted) == 0) return records[first].rank;
+    return FrecencyList::kNoRank;
+}
+
+QStringList HistoryStore::recent(int count) const {
+    QStringList queries;
+    for (quint32 i = 0; i < m_recentCount && queries.size() < count; ++i) {
+        queries.append(textAt(m_recent[i]));
+    }
+    return queries;
+}
+
+bool HistoryStore::write(QIODevice& out, const HistoryStore& base, const QVector<HistoryLog::Record>& records,
+                         quint64 foldedLogBytes) {
+    // Only what follows the last clear survives it, base included
+    int start = 0;
+    for (int i = records.size() - 1; i >= 0; --i) {
+        if (records.at(i).count == 0) {
+            start = i + 1;
+            break;
+        }
+    }
+    const bool keepBase = start == 0;
+
+    // Fold every use of a query into one entry, then sort into store order
+    QHash<QString, int> slot;
+    QVector<Folded> folded;
+    for (int i = start; i < records.size(); ++i) {
+        const HistoryLog::Record& record = records.at(i);
+        const double rank = FrecencyList::useRank(record.timestamp, quint32(record.count));
+        auto it = slot.constFind(record.query);
+        if (it == slot.constEnd()) {
+            slot.insert(record.query, int(folded.size()));
+            folded.append({record.query.toLower().toUtf8(), record.query.toUtf8(),
+                           quint32(record.count), record.timestamp, rank});
+        } else {
+            Folded& entry = folded[it.value()];
+            entry.count += quint32(record.count);
+            entry.lastUsed = qMax(entry.lastUsed, record.timestamp);
+            entry.rank = FrecencyList::combineRanks(entry.rank, rank);
+        }
+    }
+    std::sort(folded.begin(), folded.end(), [](const Folded& a, const Folded& b) {
+        const int order = compareBytes(a.key.constData(), quint32(a.key.size()), b.key.constData(), quint32(b.key.size()));
+        return order != 0 ? order < 0
+                          : compareBytes(a.text.constData(), quint32(a.text.size()), b.text.constData(), quint32(b.text.size())) < 0;
+    });
+
+    // Linear merge of two sorted runs; called once per output pass so the
+    // merged store never has to be held in memory
+    const StoredRecord* stored = reinterpret_cast<const StoredRecord*>(base.m_records);
+    const quint32 storedCount = keepBase ? base.m_count : 0;
+    auto merge = [&](auto&& visit) {
+        quint32 i = 0;
+        int j = 0;
+        while (i < storedCount || j < folded.size()) {
+            Merged left = {};
+            Merged right = {};
+            if (i < storedCount) {
+                const StoredRecord& record = stored[i];
+                const char* key = base.m_pool + record.offset;
+                left = {key, record.keyLength, key + record.keyLength, record.textLength,
+                        record.count, record.lastUsed, record.rank};
+            }
+            if (j < folded.size()) {
+                const Folded& entry = folded.at(j);
+                right = {entry.key.constData(), quint32(entry.key.size()), entry.text.constData(),
+                         quint32(entry.text.size()), entry.count, entry.lastUsed, entry.rank};
+            }
+            const int order = i >= storedCount ? 1 : (j >= folded.size() ? -1 : compareEntries(left, right));
+            if (order < 0) {
+                visit(left);
+                ++i;
+            } else if (order > 0) {
+                visit(right);
+                ++j;
+            } else {
+                left.count += right.count;
+                left.lastUsed = qMax(left.lastUsed, right.lastUsed);
+                left.rank = FrecencyList::combineRanks(left.rank, right.rank);
+                visit(left);
+                ++i;
+                ++j;
+            }
+        }
+    };
+
+    // Pass 1: sizes
+    quint32 count = 0;
+    quint64 poolSize = 0;
+    merge([&](const Merged& entry) {
+        ++count;
+        poolSize += entry.keyLength + entry.textLength;
+    });
+
+    const quint32 blocks = qMax<quint32>(1, (count + kBlockSize - 1) / kBlockSize);
+    quint32 leafCount = 1;
+    while (leafCount < blocks) leafCount <<= 1;
+    Header header = {};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.count = count;
+    header.leafCount = leafCount;
+    header.recentCount = qMin(count, kRecentLength);
+    header.generation = base.m_generation + 1;
+    header.foldedLogBytes = foldedLogBytes;
+    header.poolOffset = sizeof(Header) + quint64(count) * sizeof(StoredRecord);
+    header.poolSize = poolSize;
+    header.treeOffset = alignTo8(header.poolOffset + poolSize);
+    header.recentOffset = header.treeOffset + 2 * quint64(leafCount) * sizeof(double);
+
+    bool ok = true;
+    QByteArray chunk;
+    chunk.reserve(kWriteChunk + 4096);
+    auto put = [&](const void* data, qint64 length) {
+        chunk.append(static_cast<const char*>(data), length);
+        if (chunk.size() >= kWriteChunk) {
+            ok = ok && out.write(chunk) == chunk.size();
+            chunk.clear();
+        }
+    };
+    put(&header, sizeof(header));
+
+    // Pass 2: records, collecting block maxima and the most recent queries
+    std::vector<double> tree(2 * size_t(leafCount), FrecencyList::kNoRank);
+    using Use = std::pair<qint64, quint32>;
+    std::priority_queue<Use, std::vector<Use>, std::greater<Use>> latest;
+    quint32 index = 0;
+    quint64 offset = 0;
+    merge([&](const Merged& entry) {
+        StoredRecord record = {offset, entry.keyLength, entry.textLength, entry.count, 0, entry.lastUsed, entry.rank};
+        put(&record, sizeof(record));
+        offset += entry.keyLength + entry.textLength;
+        double& leaf = tree[leafCount + index / kBlockSize];
+        leaf = qMax(leaf, entry.rank);
+        latest.push({entry.lastUsed, index});
+        if (latest.size() > kRecentLength) latest.pop();
+        ++index;
+    });
+
+    // Pass 3: strings
+    merge([&](const Merged& entry) {
+        put(entry.key, entry.keyLength);
+        put(entry.text, entry.textLength);
+    });
+
+    const char padding[8] = {};
+    put(padding, qint64(header.treeOffset - (header.poolOffset + poolSize)));
+    for (quint32 node = leafCount - 1; node >= 1; --node) {
+        tree[node] = qMax(tree[2 * node], tree[2 * node + 1]);
+    }
+    put(tree.data(), qint64(tree.size() * sizeof(double)));
+
+    QVector<quint32> recent;
+    recent.reserve(int(latest.size()));
+    while (!latest.empty()) {
+        recent.append(latest.top().second);
+        latest.pop();
+    }
+    std::reverse(recent.begin(), recent.end());
+    put(recent.constData(), qint64(recent.size()) * qint64(sizeof(quint32)));
+
+    ok = ok && (chunk.isEmpty() || out.write(chunk) == chunk.size());
+    return ok;
+}
@@ -0,0 +1,538 @@
+#include "HttpServer.h"
+#include "BatchSearch.h"
+#include "Metrics.h"
+#include "QueryIndex.h"
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QThread>
+#include <QUrl>
+#include <algorithm>
+#include <cstring>
+
+#ifdef Q_OS_LINUX
+#include <cerrno>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace {
+constexpr qsizetype kMaxHeaderBytes = 8 * 1024;
+constexpr qsizetype kMaxBodyBytes = 64 * 1024;
+constexpr int kReadChunk = 16 * 1024;
+constexpr qint64 kIdleTimeoutNs = 60 * 1000000000LL;
+constexpr int kDefaultLimit = 10;
+constexpr int kMaxLimit = 100;
+
+const char* reasonPhrase(int status) {
+    switch (status) {
+    case 200: return "OK";
+    case 400: return "Bad Request";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 413: return "Payload Too Large";
+    case 431: return "Request Header Fields Too Large";
+    case 503: return "Service Unavailable";
+    default: return "Error";
+    }
+}
+
+QByteArray errorJson(const char* message) {
+    return QByteArray("{\"error\":\"") + message + "\"}";
+}
+
+// Value of key in an application/x-www-form-urlencoded query string
+QString queryValue(const QByteArray& query, const QByteArray& key) {
+    for (const QByteArray& pair : query.split('&')) {
+        const int equals = pair.indexOf('=');
+        if (equals < 0 || pair.left(equals) != key) continue;
+        QByteArray value = pair.mid(equals + 1);
+        value.replace('+', ' ');
+        return QUrl::fromPercentEncoding(value);
+    }
+    return QString();
+}
+}
+
+struct HttpServer::Connection {
+    int fd = -1;
+    quint64 serial = 0;
+    QByteArray input;
+    QByteArray output;
+    qsizetype outputOffset = 0;
+    qint64 lastActive = 0;
+    bool busy = false;            // a search for this connection is on the pool
+    bool wantsWrite = false;
+    bool closeAfterWrite = false;
+    bool peerClosed = false;
+};
+
+HttpServer::HttpServer(const QueryIndex& index, const BatchSearch& search)
+    : m_index(index)
+    , m_search(search)
+    , m_stopping(0)
+    , m_inFlight(0)
+    , m_shedDeadline(0)
+{
+    setThreadCount(0);
+    m_clock.start();
+}
+
+void HttpServer::setThreadCount(int threads) {
+    m_pool.setMaxThreadCount(threads > 0 ? threads : QThread::idealThreadCount());
+}
+
+HttpServer::Stats HttpServer::stats() const {
+    Stats stats = m_stats;
+    stats.shedDeadline = m_shedDeadline.loadRelaxed();
+    return stats;
+}
+
+QByteArray HttpServer::suggestJson(const QString& query, int limit) const {
+    const QString normalized = QueryIndex::normalize(query);
+
+    // Oversample the index hits, then rank like the desktop autocompleter:
+    // prefix beats word start beats anywhere
+    QVector<QPair<double, int>> ranked;
+    for (const QueryIndex::Hit& hit : m_index.search(normalized, limit * 4)) {
+        const QString& title = m_index.entry(hit.entry).title;
+        const int pos = int(title.indexOf(normalized, 0, Qt::CaseInsensitive));
+        if (pos < 0) continue; // the query contains the question: not a completion
+        ranked.append({pos == 0 ? 1.0 : title.at(pos - 1).isSpace() ? 0.8 : 0.6, hit.entry});
+    }
+    std::stable_sort(ranked.begin(), ranked.end(), [](const QPair<double, int>& a, const QPair<double, int>& b) {
+        return a.first > b.first;
+    });
+
+    QJsonArray suggestions;
+    for (int i = 0; i < qMin(limit, int(ranked.size())); ++i) {
+        QJsonObject suggestion;
+        suggestion["id"] = ranked.at(i).second;
+        suggestion["text"] = m_index.entry(ranked.at(i).second).title;
+        suggestion["score"] = ranked.at(i).first;
+        suggestions.append(suggestion);
+    }
+    QJsonObject root;
+    root["query"] = query;
+    root["suggestions"] = suggestions;
+    return QJsonDocument(root).toJson(QJsonDocument::Compact);
+}
+
+QByteArray HttpServer::answerJson(int entry) const {
+    const SearchResult& result = m_index.entry(entry);
+    QJsonObject root;
+    root["id"] = entry;
+    root["title"] = result.title;
+    root["url"] = result.url.toString();
+    root["answer"] = result.description;
+    return QJsonDocument(root).toJson(QJsonDocument::Compact);
+}
+
+#ifdef Q_OS_LINUX
+
+HttpServer::~HttpServer() {
+    // Jobs still on the pool post completions into this object
+    m_stopping.storeRelaxed(1);
+    m_pool.waitForDone();
+    for (Connection* connection : m_connections) {
+        ::close(connection->fd);
+        delete connection;
+    }
+    if (m_listenFd >= 0) ::close(m_listenFd);
+    if (m_wakeFd >= 0) ::close(m_wakeFd);
+    if (m_epollFd >= 0) ::close(m_epollFd);
+}
+
+bool HttpServer::listen(const QString& address) {
+    QString host = "127.0.0.1";
+    QString portText = address;
+    const int colon = int(address.lastIndexOf(':'));
+    if (colon >= 0) {
+        host = address.left(colon);
+        portText = address.mid(colon + 1);
+    }
+    bool portOk = false;
+    const int port = portText.toInt(&portOk);
+    sockaddr_in socketAddress{};
+    socketAddress.sin_family = AF_INET;
+    socketAddress.sin_port = htons(quint16(port));
+    if (!portOk || port <= 0 || port > 65535
+        || ::inet_pton(AF_INET, host.toLatin1().constData(), &socketAddress.sin_addr) != 1) {
+        m_error = QString("expected <port> or <ipv4>:<port>, got %1").arg(address);
+        return false;
+    }
+
+    m_listenFd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    const int on = 1;
+    if (m_listenFd < 0
+        || ::setsockopt(m_listenFd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on)) < 0
+        || ::bind(m_listenFd, reinterpret_cast<sockaddr*>(&socketAddress), sizeof(socketAddress)) < 0
+        || ::listen(m_listenFd, SOMAXCONN) < 0) {
+        m_error = QString("listen on %1: %2").arg(address, QString::fromLocal8Bit(std::strerror(errno)));
+        return false;
+    }
+
+    m_epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+    m_wakeFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (m_epollFd < 0 || m_wakeFd < 0) {
+        m_error = QString("epoll: %1").arg(QString::fromLocal8Bit(std::strerror(errno)));
+        return false;
+    }
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = m_listenFd;
+    ::epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_listenFd, &event);
+    event.data.fd = m_wakeFd;
+    ::epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_wakeFd, &event);
+    return true;
+}
+
+void HttpServer::stop() {
+    m_stopping.storeRelaxed(1);
+    if (m_wakeFd < 0) return;
+    const quint64 one = 1;
+    [[maybe_unused]] const ssize_t written = ::write(m_wakeFd, &one, sizeof(one));
+}
+
+bool HttpServer::run() {
+    if (m_epollFd < 0) {
+        m_error = "not listening";
+        return false;
+    }
+    epoll_event events[128];
+    qint64 lastSweep = m_clock.nsecsElapsed();
+    while (!m_stopping.loadRelaxed()) {
+        // Wake up now and then to drop idle keep-alive connections
+        const int ready = ::epoll_wait(m_epollFd, events, 128, 1000);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            m_error = QString("epoll_wait: %1").arg(QString::fromLocal8Bit(std::strerror(errno)));
+            return false;
+        }
+        for (int i = 0; i < ready; ++i) {
+            const int fd = events[i].data.fd;
+            if (fd == m_wakeFd) {
+                quint64 count;
+                [[maybe_unused]] const ssize_t received = ::read(m_wakeFd, &count, sizeof(count));
+                drainCompletions();
+                continue;
+            }
+            if (fd == m_listenFd) {
+                acceptConnections();
+                continue;
+            }
+            Connection* connection = m_connections.value(fd);
+            if (!connection) continue;
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                closeConnection(connection);
+                continue;
+            }
+            if (((events[i].events & EPOLLOUT) && !flush(connection))
+                || ((events[i].events & EPOLLIN) && !readInput(connection))) {
+                closeConnection(connection);
+                continue;
+            }
+            if (handleRequests(connection)) updateInterest(connection);
+        }
+        if (m_clock.nsecsElapsed() - lastSweep > 1000000000LL) {
+            sweepIdleConnections();
+            lastSweep = m_clock.nsecsElapsed();
+        }
+    }
+    return true;
+}
+
+void HttpServer::acceptConnections() {
+    for (;;) {
+        const int fd = ::accept4(m_listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return;
+        if (m_connections.size() >= m_maxConnections) {
+            // Best effort: tell the client why, then drop it
+            static const char busy[] = "HTTP/1.1 503 Service Unavailable\r\nRetry-After: 1\r\n"
+                                       "Content-Length: 0\r\nConnection: close\r\n\r\n";
+            [[maybe_unused]] const ssize_t written = ::write(fd, busy, sizeof(busy) - 1);
+            ::close(fd);
+            ++m_stats.rejectedConnections;
+            continue;
+        }
+        // Responses are small and written whole; never hold them back
+        const int on = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+
+        Connection* connection = new Connection;
+        connection->fd = fd;
+        connection->serial = m_nextSerial++;
+        connection->lastActive = m_clock.nsecsElapsed();
+        m_connections.insert(fd, connection);
+
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        ::epoll_ctl(m_epollFd, EPOLL_CTL_ADD, fd, &event);
+    }
+}
+
+void HttpServer::closeConnection(Connection* connection) {
+    ::epoll_ctl(m_epollFd, EPOLL_CTL_DEL, connection->fd, nullptr);
+    ::close(connection->fd);
+    m_connections.remove(connection->fd);
+    delete connection;
+}
+
+void HttpServer::sweepIdleConnections() {
+    const qint64 now = m_clock.nsecsElapsed();
+    QVector<Connection*> idle;
+    for (Connection* connection : m_connections) {
+        if (!connection->busy && !connection->wantsWrite && now - connection->lastActive > kIdleTimeoutNs) {
+            idle.append(connection);
+        }
+    }
+    for (Connection* connection : idle) closeConnection(connection);
+}
+
+bool HttpServer::readInput(Connection* connection) {
+    connection->lastActive = m_clock.nsecsElapsed();
+    // Pipelined requests wait in the buffer while one is being answered
+    while (!connection->peerClosed && connection->input.size() < kMaxHeaderBytes + kMaxBodyBytes) {
+        const qsizetype used = connection->input.size();
+        connection->input.resize(used + kReadChunk);
+        const ssize_t received = ::read(connection->fd, connection->input.data() + used, kReadChunk);
+        connection->input.resize(used + qMax<ssize_t>(received, 0));
+        if (received == 0) {
+            connection->peerClosed = true;
+            return true;
+        }
+        if (received < 0) return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        if (received < kReadChunk) return true;
+    }
+    return true;
+}
+
+bool HttpServer::handleRequests(Connection* connection) {
+    // One request at a time per connection keeps responses in order
+    while (!connection->busy && !connection->closeAfterWrite) {
+        const int headerEnd = int(connection->input.indexOf("\r\n\r\n"));
+        if (headerEnd < 0) {
+            if (connection->input.size() > kMaxHeaderBytes) {
+                respond(connection, 431, errorJson("request header too large"), false);
+            }
+            break;
+        }
+
+        const QList<QByteArray> lines = connection->input.left(headerEnd).split('\n');
+        const QList<QByteArray> requestLine = lines.first().trimmed().split(' ');
+        if (requestLine.size() != 3 || !requestLine.at(2).startsWith("HTTP/1.")) {
+            respond(connection, 400, errorJson("malformed request line"), false);
+            break;
+        }
+
+        Request request;
+        request.method = requestLine.at(0);
+        request.target = requestLine.at(1);
+        // HTTP/1.1 keeps the connection unless told otherwise, 1.0 only when asked
+        request.keepAlive = requestLine.at(2) != "HTTP/1.0";
+        qsizetype contentLength = 0;
+        for (int i = 1; i < lines.size(); ++i) {
+            const QByteArray& line = lines.at(i);
+            const int colon = line.indexOf(':');
+            if (colon < 0) continue;
+            const QByteArray name = line.left(colon).trimmed().toLower();
+            const QByteArray value = line.mid(colon + 1).trimmed().toLower();
+            if (name == "connection") {
+                if (value == "close") request.keepAlive = false;
+                else if (value == "keep-alive") request.keepAlive = true;
+            } else if (name == "content-length") {
+                contentLength = value.toLongLong();
+            }
+        }
+        if (contentLength < 0 || contentLength > kMaxBodyBytes) {
+            respond(connection, 413, errorJson("request body too large"), false);
+            break;
+        }
+        const qsizetype total = headerEnd + 4 + contentLength;
+        if (connection->input.size() < total) break; // body still arriving
+
+        // The body is read only to keep the stream in sync; no endpoint takes one
+        connection->input.remove(0, total);
+        dispatch(connection, request);
+    }
+
+    const bool written = flush(connection);
+    const bool drained = !connection->busy && !connection->wantsWrite;
+    if (!written || (drained && (connection->closeAfterWrite || connection->peerClosed))) {
+        closeConnection(connection);
+        return false;
+    }
+    return true;
+}
+
+void HttpServer::dispatch(Connection* connection, const Request& request) {
+    ++m_stats.requests;
+    if (request.method != "GET") {
+        respond(connection, 405, errorJson("only GET is supported"), request.keepAlive);
+        return;
+    }
+
+    const int question = request.target.indexOf('?');
+    const QByteArray path = question < 0 ? request.target : request.target.left(question);
+    const QByteArray query = question < 0 ? QByteArray() : request.target.mid(question + 1);
+
+    if (path.startsWith("/answer/")) {
+        bool ok = false;
+        const int entry = path.mid(int(qstrlen("/answer/"))).toInt(&ok);
+        if (!ok || entry < 0 || entry >= m_index.size()) {
+            respond(connection, 404, errorJson("no such answer"), request.keepAlive);
+        } else {
+            respond(connection, 200, answerJson(entry), request.keepAlive);
+        }
+        return;
+    }
+    if (path == "/metrics") {
+        if (queryValue(query, "format") == "json") {
+            respond(connection, 200, Metrics::instance()->json(), request.keepAlive);
+        } else {
+            respond(connection, 200, Metrics::instance()->prometheusText(), request.keepAlive,
+                    "text/plain; version=0.0.4");
+        }
+        return;
+    }
+    if (path != "/search" && path != "/suggest") {
+        respond(connection, 404, errorJson("unknown endpoint"), request.keepAlive);
+        return;
+    }
+
+    Job job;
+    job.fd = connection->fd;
+    job.serial = connection->serial;
+    job.keepAlive = request.keepAlive;
+    job.suggest = path == "/suggest";
+    const QString explain = queryValue(query, "explain");
+    job.explain = !explain.isEmpty() && explain != "0";
+    job.query = queryValue(query, "q");
+    const QString limit = queryValue(query, "limit");
+    job.limit = limit.isEmpty() ? kDefaultLimit : qBound(1, limit.toInt(), kMaxLimit);
+    if (job.query.trimmed().isEmpty()) {
+        respond(connection, 400, errorJson("missing q parameter"), request.keepAlive);
+        return;
+    }
+
+    // Admission control: refuse now rather than queue work nobody will wait for
+    if (m_inFlight.loadRelaxed() >= m_queueLimit) {
+        ++m_stats.shedQueueFull;
+        respond(connection, 503, errorJson("overloaded"), request.keepAlive);
+        return;
+    }
+    m_inFlight.fetchAndAddRelaxed(1);
+    connection->busy = true;
+    job.queuedAt = m_clock.nsecsElapsed();
+    m_pool.start([this, job]() { runJob(job); });
+}
+
+void HttpServer::runJob(const Job& job) {
+    static Metrics::Histogram& queueWait = Metrics::instance()->histogram(
+        "http_queue_wait_seconds", "Time an HTTP search waited for a worker");
+    static Metrics::Histogram& searchTime = Metrics::instance()->histogram(
+        "http_search_seconds", "Time to answer an HTTP /search or /suggest once running");
+    const qint64 startedAt = m_clock.nsecsElapsed();
+    queueWait.record(startedAt - job.queuedAt);
+
+    Completion completion;
+    completion.fd = job.fd;
+    completion.serial = job.serial;
+    completion.keepAlive = job.keepAlive;
+    if (m_stopping.loadRelaxed() || startedAt - job.queuedAt > m_deadlineNs) {
+        // The client has likely given up; spend the core on fresher requests
+        m_shedDeadline.fetchAndAddRelaxed(1);
+        completion.status = 503;
+        completion.body = errorJson("deadline exceeded in queue");
+    } else {
+        completion.status = 200;
+        completion.body = job.suggest ? suggestJson(job.query, job.limit) : m_search.searchJson(job.query, job.limit, job.explain);
+        searchTime.record(m_clock.nsecsElapsed() - startedAt);
+    }
+
+    {
+        QMutexLocker locker(&m_completionLock);
+        m_completions.append(std::move(completion));
+    }
+    m_inFlight.fetchAndSubRelaxed(1);
+    const quint64 one = 1;
+    [[maybe_unused]] const ssize_t written = ::write(m_wakeFd, &one, sizeof(one));
+}
+
+void HttpServer::drainCompletions() {
+    QVector<Completion> completions;
+    {
+        QMutexLocker locker(&m_completionLock);
+        completions.swap(m_completions);
+    }
+    for (const Completion& completion : completions) {
+        Connection* connection = m_connections.value(completion.fd);
+        if (!connection || connection->serial != completion.serial) continue; // client went away
+        connection->busy = false;
+        respond(connection, completion.status, completion.body, completion.keepAlive);
+        if (handleRequests(connection)) updateInterest(connection);
+    }
+}
+
+void HttpServer::respond(Connection* connection, int status, const QByteArray& body, bool keepAlive,
+                         const char* contentType) {
+    if (status == 200) ++m_stats.served;
+    QByteArray& out = connection->output;
+    out += "HTTP/1.1 " + QByteArray::number(status) + ' ' + reasonPhrase(status) + "\r\n";
+    out += "Content-Type: " + QByteArray(contentType) + "\r\nContent-Length: " + QByteArray::number(body.size()) + "\r\n";
+    if (status == 503) out += "Retry-After: 1\r\n";
+    out += keepAlive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n";
+    out += body;
+    if (!keepAlive) connection->closeAfterWrite = true;
+    connection->lastActive = m_clock.nsecsElapsed();
+}
+
+bool HttpServer::flush(Connection* connection) {
+    while (connection->outputOffset < connection->output.size()) {
+        const ssize_t written = ::write(connection->fd, connection->output.constData() + connection->outputOffset,
+                                        size_t(connection->output.size() - connection->outputOffset));
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                connection->wantsWrite = true;
+                return true;
+            }
+            return false;
+        }
+        connection->outputOffset += written;
+    }
+    connection->output.clear();
+    connection->outputOffset = 0;
+    connection->wantsWrite = false;
+    return true;
+}
+
+void HttpServer::updateInterest(Connection* connection) {
+    // Stop reading from clients that pipeline faster than they collect responses
+    const bool canRead = !connection->peerClosed && connection->input.size() < kMaxHeaderBytes + kMaxBodyBytes;
+    epoll_event event{};
+    event.events = (canRead ? EPOLLIN : 0u) | (connection->wantsWrite ? EPOLLOUT : 0u);
+    event.data.fd = connection->fd;
+    ::epoll_ctl(m_epollFd, EPOLL_CTL_MOD, connection->fd, &event);
+}
+
+#else
+
+HttpServer::~HttpServer() = default;
+
+bool HttpServer::listen(const QString&) {
+    m_error = "--http needs epoll and is only available on Linux";
+    return false;
+}
+
+bool HttpServer::run() { return false; }
+void HttpServer::stop() {}
+
+#endif
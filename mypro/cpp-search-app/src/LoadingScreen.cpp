@@ -170,18 +170,9 @@ void LoadingScreen::startLoading() {
     // Start fade in
     m_fadeInAnimation->start();
     
-    // Start progress simulation
+    // Progress and status are driven by the caller via setProgress()/setStatus()
+    setStatus("Initializing...");
     m_progressTimer->start();
-    
-    // Simulate loading steps
-    QTimer::singleShot(500, [this]() { setStatus("Loading search engines..."); });
-    QTimer::singleShot(1500, [this]() { setStatus("Initializing network..."); });
-    QTimer::singleShot(2500, [this]() { setStatus("Preparing UI components..."); });
-    QTimer::singleShot(3500, [this]() { setStatus("Almost ready..."); });
-    QTimer::singleShot(4000, [this]() { 
-        setStatus("Launching application...");
-        m_targetProgress = 100;
-    });
 }
 
 void LoadingScreen::setProgress(int value) {
@@ -213,11 +204,15 @@ void LoadingScreen::setStatus(const QString& status) {
 
 void LoadingScreen::updateProgress() {
     if (m_currentProgress < m_targetProgress) {
-        m_currentProgress += 2;
+        // Close a quarter of the gap per tick so the bar keeps up with real progress
+        m_currentProgress = qMin(m_targetProgress,
+                                 m_currentProgress + qMax(2, (m_targetProgress - m_currentProgress) / 4));
         m_progressBar->setValue(m_currentProgress);
-        
-        if (m_currentProgress >= m_targetProgress) {
-            m_progressTimer->stop();
+    }
+    if (m_currentProgress >= m_targetProgress) {
+        m_progressTimer->stop();
+        if (m_isLoading && m_currentProgress >= 100) {
+            m_isLoading = false;
             m_animationTimer->start();
         }
     }
@@ -1,38 +1,76 @@
 #include "MainWindow.h"
 #include "ResultsWidget.h"
 #include "SearchHistory.h"
+#include "StartupTrace.h"
+#include "Tracer.h"
 #include <QMenuBar>
 #include <QStatusBar>
 #include <QMessageBox>
 #include <QClipboard>
 #include <QApplication>
 #include <QDebug>
+#include <QAbstractItemView>
+#include <QCloseEvent>
+#include <QStyle>
+#include <QFontDatabase>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent), m_searchInProgress(false) {
-    qDebug() << "MainWindow: ctor start";
-    // Loading screen disabled for stability
-    qDebug() << "MainWindow: loading screen skipped";
+    TraceSpan span("MainWindow::MainWindow");
+    StartupTrace* trace = StartupTrace::instance();
     // Initialize core components
     m_searchHistory = new SearchHistory(this);
     m_offlineQA = new OfflineQADatabase(this);
-    qDebug() << "MainWindow: after core components";
+    m_searchEngine = new SearchEngine(m_offlineQA, this);
+    trace->mark("core components");
     setupUI();
-    qDebug() << "MainWindow: after setupUI";
+    trace->mark("setupUI");
     setupMenus();
-    qDebug() << "MainWindow: after setupMenus";
-    setupAnimations();
-    qDebug() << "MainWindow: after setupAnimations";
+    trace->mark("menu bar");
     m_themeMode = "Beast";
     applyFuturisticStyle();
-    qDebug() << "MainWindow: after applyFuturisticStyle";
+    trace->mark("theme");
     
     // Connect signals
     connect(m_resultsWidget, &ResultsWidget::resultClicked,
             this, &MainWindow::onResultClicked);
+    connect(m_searchEngine, &SearchEngine::resultsBatch,
+            this, &MainWindow::onResultsBatch);
+    connect(m_searchEngine, &SearchEngine::searchFinished,
+            this, &MainWindow::onSearchStreamFinished);
+    
+    // Built-in answers are ready now; the data packs load in the background
+    // and queries meanwhile see whatever has been loaded so far
+    connect(m_offlineQA, &OfflineQADatabase::fileLoadStarted, this,
+            [this](const QString& fileName, int fileIndex, int fileCount) {
+                if (m_loadingScreen) {
+                    m_loadingScreen->setStatus(QString("Loading %1 (%2/%3)...")
+                                                   .arg(fileName).arg(fileIndex + 1).arg(fileCount));
+                }
+            });
+    connect(m_offlineQA, &OfflineQADatabase::loadProgress,
+            this, &MainWindow::onDatabaseLoadProgress);
+    connect(m_offlineQA, &OfflineQADatabase::loadFinished,
+            this, &MainWindow::onDatabaseLoaded);
+    m_loadProgressBar = new QProgressBar(this);
+    m_loadProgressBar->setRange(0, 100);
+    m_loadProgressBar->setMaximumWidth(160);
+    m_loadProgressBar->setFormat("Loading %p%");
+    statusBar()->addPermanentWidget(m_loadProgressBar);
+    m_offlineQA->loadExternalDataAsync();
+    
+    // Fast loads finish before anyone would notice a splash
+    QTimer::singleShot(250, this, [this]() {
+        if (!m_offlineQA->isLoaded()) showLoadingScreen();
+    });
+    
+    // Menu contents, animations and other non-critical UI are built only
+    // once the search box is interactive (or when first needed)
+    connect(trace, &StartupTrace::interactive, this, &MainWindow::setupDeferredUI);
     
+    m_searchInput->setFocus();
     loadSettings();
-    qDebug() << "MainWindow: ctor end";
+    trace->mark("MainWindow signals");
 }
 
 MainWindow::~MainWindow() {
@@ -40,7 +78,6 @@ MainWindow::~MainWindow() {
 }
 
 void MainWindow::setupUI() {
-    qDebug() << "setupUI: start";
     m_centralWidget = new QWidget(this);
     setCentralWidget(m_centralWidget);
     
@@ -52,6 +89,8 @@ void MainWindow::setupUI() {
     m_topBar->setFrameShape(QFrame::NoFrame);
     m_topBar->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
     m_topBar->setFixedHeight(54);
+    m_topBar->setAutoFillBackground(true);
+    m_topBar->setBackgroundRole(QPalette::AlternateBase);
     m_searchLayout = new QHBoxLayout(m_topBar);
     m_searchLayout->setContentsMargins(12, 8, 12, 8);
     m_searchLayout->setSpacing(10);
@@ -59,12 +98,17 @@ void MainWindow::setupUI() {
     // Logo
     m_logoLabel = new QLabel(this);
     m_logoLabel->setText("🧠 Imilya Minds");
-    m_logoLabel->setStyleSheet("font-weight: 800; font-size: 16px; color: #00d4ff;");
+    QFont logoFont = m_logoLabel->font();
+    logoFont.setPixelSize(16);
+    logoFont.setWeight(QFont::ExtraBold);
+    m_logoLabel->setFont(logoFont);
+    m_logoLabel->setForegroundRole(QPalette::Link);
 
     m_backButton = new QPushButton("◀", this);
     m_forwardButton = new QPushButton("▶", this);
     m_homeButton = new QPushButton("⌂", this);
     m_themeToggleButton = new QPushButton("Beast", this);
+    m_themeToggleButton->setObjectName("ThemeToggle");
     QPushButton* copyButton = new QPushButton("Copy", this);
     m_backButton->setToolTip("Back");
     m_forwardButton->setToolTip("Forward");
@@ -81,23 +125,29 @@ void MainWindow::setupUI() {
     m_urlBar->setReadOnly(true);
     
     m_searchInput = new QLineEdit(this);
+    m_searchInput->setObjectName("SearchInput");
     m_searchInput->setPlaceholderText("Enter search query...");
     m_searchInput->setMinimumHeight(30);
     connect(m_searchInput, &QLineEdit::returnPressed, this, &MainWindow::performSearch);
     connect(m_searchInput, &QLineEdit::textChanged, this, &MainWindow::onSearchTextChanged);
-
-    // Fast, robust autocomplete using QCompleter
-    m_completerModel = new QStringListModel(this);
-    m_completer = new QCompleter(m_completerModel, this);
-    m_completer->setCaseSensitivity(Qt::CaseInsensitive);
-    m_completer->setFilterMode(Qt::MatchContains);
-    m_completer->setCompletionMode(QCompleter::PopupCompletion);
-    m_searchInput->setCompleter(m_completer);
+    setupAutoComplete();
+    
+    // Hidden diagnostic: while on, every search also shows its plan and cost breakdown
+    QAction* explainAction = new QAction(this);
+    explainAction->setCheckable(true);
+    explainAction->setShortcut(QKeySequence("Ctrl+Shift+E"));
+    connect(explainAction, &QAction::toggled, this, [this](bool on) {
+        m_explainMode = on;
+        statusBar()->showMessage(on ? "Explain mode on" : "Explain mode off", 2000);
+    });
+    addAction(explainAction);
     
     m_searchButton = new QPushButton("Search", this);
+    m_searchButton->setObjectName("SearchButton");
     connect(m_searchButton, &QPushButton::clicked, this, &MainWindow::performSearch);
     
     m_clearButton = new QPushButton("Clear", this);
+    m_clearButton->setObjectName("ClearButton");
     connect(m_clearButton, &QPushButton::clicked, this, &MainWindow::clearResults);
     
     m_searchLayout->addWidget(m_logoLabel);
@@ -129,41 +179,70 @@ void MainWindow::setupUI() {
     
     // Window properties
     setWindowTitle("Search & Browse - C++ Search App");
-    setMinimumSize(800, 600);
-    resize(1000, 700);
-    qDebug() << "setupUI: end";
+    setMinimumSize(1000, 700);
+    resize(1200, 800);
 }
 
 void MainWindow::setupMenus() {
-    qDebug() << "setupMenus: start";
+    // Only the titles are needed for the first frame; the menus are filled
+    // in by setupMenuActions() after startup or when first opened
+    m_fileMenu = menuBar()->addMenu("&File");
+    m_editMenu = menuBar()->addMenu("&Edit");
+    m_viewMenu = menuBar()->addMenu("&View");
+    m_helpMenu = menuBar()->addMenu("&Help");
+    for (QMenu* menu : {m_fileMenu, m_editMenu, m_viewMenu, m_helpMenu}) {
+        connect(menu, &QMenu::aboutToShow, this, &MainWindow::setupMenuActions);
+    }
+    
+    // Status bar
+    statusBar()->showMessage("Ready");
+}
+
+void MainWindow::setupMenuActions() {
+    if (m_menusPopulated) return;
+    m_menusPopulated = true;
+    
     // File menu
-    QMenu* fileMenu = menuBar()->addMenu("&File");
-    fileMenu->addAction("&Settings", this, &MainWindow::showSettings);
-    fileMenu->addSeparator();
-    fileMenu->addAction("E&xit", this, &QWidget::close, QKeySequence::Quit);
+    m_fileMenu->addAction("&Settings", this, &MainWindow::showSettings);
+    m_fileMenu->addSeparator();
+    // Closing the window only hides it in resident mode; Exit really quits
+    m_fileMenu->addAction("E&xit", qApp, &QCoreApplication::quit, QKeySequence::Quit);
     
     // Edit menu
-    QMenu* editMenu = menuBar()->addMenu("&Edit");
-    editMenu->addAction("&Clear Results", this, &MainWindow::clearResults);
-    editMenu->addAction("Clear &History", this, [this]() {
+    m_editMenu->addAction("&Clear Results", this, &MainWindow::clearResults);
+    m_editMenu->addAction("Clear &History", this, [this]() {
         m_searchHistory->clearHistory();
         statusBar()->showMessage("Search history cleared", 2000);
     });
     
     // View menu
-    QMenu* viewMenu = menuBar()->addMenu("&View");
-    viewMenu->addAction("Show &History", this, &MainWindow::showSearchHistory);
+    m_viewMenu->addAction("Show &History", this, &MainWindow::showSearchHistory);
+    m_viewMenu->addAction("&Prefetch Statistics", this, &MainWindow::showSpeculationStats);
+    m_viewMenu->addAction("&Metrics", this, &MainWindow::showMetrics);
+    m_profilerAction = m_viewMenu->addAction("Profiler &Overlay");
+    m_profilerAction->setCheckable(true);
+    m_profilerAction->setChecked(m_profilerOverlay && m_profilerOverlay->isActive());
+    m_profilerAction->setShortcut(QKeySequence("Ctrl+Shift+P"));
+    connect(m_profilerAction, &QAction::toggled, this, &MainWindow::setProfilerOverlayVisible);
     
     // Help menu
-    QMenu* helpMenu = menuBar()->addMenu("&Help");
-    helpMenu->addAction("&About", this, &MainWindow::showAbout);
-    
-    // Status bar
-    statusBar()->showMessage("Ready");
-    qDebug() << "setupMenus: end";
+    m_helpMenu->addAction("&About", this, &MainWindow::showAbout);
+}
+
+void MainWindow::setupDeferredUI() {
+    StartupTrace* trace = StartupTrace::instance();
+    setupMenuActions();
+    trace->mark("deferred: menus");
+    setupAnimations();
+    trace->mark("deferred: animations");
+    if (m_enableSystemTray) {
+        setupSystemTray();
+        trace->mark("deferred: system tray");
+    }
 }
 
 void MainWindow::performSearch() {
+    TraceSpan span("MainWindow::performSearch");
     QString query = m_searchInput->text().trimmed();
     if (query.isEmpty()) {
         statusBar()->showMessage("Please enter a search query", 2000);
@@ -175,31 +254,47 @@ void MainWindow::performSearch() {
         return;
     }
     
-    // Clear completer popup
+    // Clear completer popup and drop any pending suggestion pass
     if (m_completer) {
-        m_completerModel->setStringList({});
+        m_suggestionTimer->stop();
+        m_suggestionEngine->cancel();
+        updateCompleterModel({});
     }
     
     m_currentQuery = query;
     m_searchHistory->addSearch(query);
+    if (!m_offlineQA->isLoaded()) {
+        // Answered from the partial database now, refreshed once loading completes
+        m_searchedWhileLoading = true;
+    }
     
     setSearchInProgress(true);
     
+    if (m_explainMode) {
+        // Before takeSpeculative, which would consume the prefetched set the plan reports on
+        showExplain(query);
+    }
+    
     // Offline-only Q&A search
     statusBar()->showMessage(QString("🔎 Looking up offline Q&A for '%1'...").arg(query), 0);
     m_progressBar->setRange(0, 0); // Indeterminate progress
     
-    QVector<SearchResult> results = buildOfflineResults(query);
-
-    // Mimic async completion
-    QTimer::singleShot(150, this, [this, results]() {
+    QVector<SearchResult> results;
+    if (m_searchEngine->takeSpeculative(query, &results)) {
+        // Prefetched while typing: show it right away
+        m_activeSearchId = 0;
         onSearchFinished(results);
         if (!results.isEmpty()) {
             navigateTo(results.first());
         }
-    });
+    } else {
+        // Stream ranked batches in as shards finish
+        m_resultsWidget->beginStreaming();
+        m_activeSearchId = m_searchEngine->startSearch(query);
+    }
     
     // Animate search button
+    if (!m_searchAnimation) setupAnimations();
     if (m_searchAnimation) {
         QRect currentGeometry = m_searchButton->geometry();
         QRect newGeometry = currentGeometry.adjusted(-2, -2, 2, 2);
@@ -215,22 +310,42 @@ void MainWindow::onSearchFinished(const QVector<SearchResult>& results) {
     // Keep UI snappy: skip heavy animations
     
     m_resultsWidget->displayResults(results);
-    
+    showResultCount(results.size());
+}
+
+void MainWindow::onResultsBatch(quint64 searchId, const QVector<SearchResult>& batch) {
+    if (searchId != m_activeSearchId) return;
+    m_resultsWidget->appendResults(batch);
+}
+
+void MainWindow::onSearchStreamFinished(quint64 searchId, int totalResults) {
+    TraceSpan span("MainWindow::onSearchStreamFinished");
+    if (searchId != m_activeSearchId) return;
+    m_activeSearchId = 0;
+    setSearchInProgress(false);
+    m_resultsWidget->finishStreaming();
+    showResultCount(totalResults);
+    if (totalResults > 0) {
+        navigateTo(m_resultsWidget->topResult());
+    }
+}
+
+void MainWindow::showResultCount(int count) {
     // Enhanced status message
     QString message;
-    if (results.isEmpty()) {
+    if (count == 0) {
         message = QString("❌ No results found for '%1'").arg(m_currentQuery);
-    } else if (results.size() == 1) {
+    } else if (count == 1) {
         message = QString("✅ Found 1 result for '%1'").arg(m_currentQuery);
     } else {
-        message = QString("✅ Found %1 results for '%2'").arg(results.size()).arg(m_currentQuery);
+        message = QString("✅ Found %1 results for '%2'").arg(count).arg(m_currentQuery);
     }
     
     statusBar()->showMessage(message, 5000);
     
     // Show results count in title
-    if (!results.isEmpty()) {
-        setWindowTitle(QString("Quantum Search - %1 results for '%2'").arg(results.size()).arg(m_currentQuery));
+    if (count > 0) {
+        setWindowTitle(QString("Quantum Search - %1 results for '%2'").arg(count).arg(m_currentQuery));
     }
 }
 
@@ -239,19 +354,60 @@ void MainWindow::onResultClicked(const SearchResult& result) {
 }
 
 void MainWindow::onSearchTextChanged(const QString& text) {
-    if (text.length() <= 1) {
-        m_completerModel->setStringList({});
+    // Any keystroke invalidates suggestions computed for older text
+    m_suggestionEngine->cancel();
+    if (text.trimmed().length() <= 1) {
+        m_suggestionTimer->stop();
+        updateCompleterModel({});
         return;
     }
-    QStringList suggestions = m_offlineQA->getSuggestions(text);
-    onSuggestionsReady(suggestions);
+    m_suggestionTimer->start();
+}
+
+void MainWindow::updateSearchSuggestions() {
+    m_suggestionEngine->requestSuggestions(m_searchInput->text());
 }
 
 void MainWindow::onSuggestionsReady(const QStringList& suggestions) {
-    m_completerModel->setStringList(suggestions);
+    updateCompleterModel(suggestions);
+    // The top candidates are the likeliest submissions; precompute them
+    m_searchEngine->speculate(suggestions);
+    if (!suggestions.isEmpty() && m_searchInput->hasFocus() && !m_searchInProgress) {
+        m_completer->complete();
+    } else if (suggestions.isEmpty() && m_completer->popup()) {
+        m_completer->popup()->hide();
+    }
+}
+
+void MainWindow::updateCompleterModel(const QStringList& suggestions) {
+    // Patch rows in place instead of resetting the model, so the popup keeps
+    // its selection and view state and avoids a full relayout per keystroke
+    const int oldCount = m_completerModel->rowCount();
+    const int newCount = suggestions.size();
+    const int common = qMin(oldCount, newCount);
+
+    for (int row = 0; row < common; ++row) {
+        const QModelIndex index = m_completerModel->index(row);
+        if (index.data(Qt::EditRole).toString() != suggestions.at(row)) {
+            m_completerModel->setData(index, suggestions.at(row), Qt::EditRole);
+        }
+    }
+    if (newCount < oldCount) {
+        m_completerModel->removeRows(newCount, oldCount - newCount);
+    } else if (newCount > oldCount) {
+        m_completerModel->insertRows(oldCount, newCount - oldCount);
+        for (int row = oldCount; row < newCount; ++row) {
+            m_completerModel->setData(m_completerModel->index(row), suggestions.at(row), Qt::EditRole);
+        }
+    }
 }
 
 void MainWindow::clearResults() {
+    if (m_activeSearchId) {
+        m_searchEngine->cancelSearch();
+        m_activeSearchId = 0;
+        setSearchInProgress(false);
+    }
     m_resultsWidget->clearResults();
     statusBar()->showMessage("Results cleared", 2000);
 }
@@ -267,6 +423,58 @@ void MainWindow::showSearchHistory() {
     msgBox.exec();
 }
 
+void MainWindow::setProfilerOverlayVisible(bool visible) {
+    if (!m_profilerOverlay) {
+        if (!visible) return;
+        m_profilerOverlay = new ProfilerOverlay(this);
+    }
+    m_profilerOverlay->setActive(visible);
+    if (m_profilerAction && m_profilerAction->isChecked() != visible) {
+        m_profilerAction->setChecked(visible);
+    }
+}
+
+void MainWindow::showSpeculationStats() {
+    const SpeculationStats stats = m_searchEngine->speculationStats();
+    QMessageBox::information(this, "Prefetch Statistics",
+        QString("Prefetched result sets: %1\n"
+                "Served from prefetch: %2\n"
+                "Computed on demand: %3\n"
+                "Wasted prefetches: %4\n"
+                "Hit rate: %5%")
+            .arg(stats.prefetched)
+            .arg(stats.hits)
+            .arg(stats.misses)
+            .arg(stats.wasted)
+            .arg(stats.hitRate() * 100.0, 0, 'f', 1));
+}
+
+void MainWindow::showMetrics() {
+    // Modeless, so the numbers can be watched while searching
+    if (!m_metricsDialog) m_metricsDialog = new MetricsDialog(this);
+    m_metricsDialog->show();
+    m_metricsDialog->raise();
+    m_metricsDialog->activateWindow();
+}
+
+void MainWindow::showExplain(const QString& query) {
+    // Computed again, on this thread: explain mode is for diagnosis, not speed
+    SearchExplain explain;
+    m_searchEngine->search(query, nullptr, &explain);
+    if (!m_explainView) {
+        m_explainView = new QPlainTextEdit(this);
+        m_explainView->setWindowFlag(Qt::Window);
+        m_explainView->setReadOnly(true);
+        m_explainView->setLineWrapMode(QPlainTextEdit::NoWrap);
+        m_explainView->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+        m_explainView->resize(900, 420);
+    }
+    m_explainView->setWindowTitle(QString("Explain: %1").arg(query));
+    m_explainView->setPlainText(explain.toText());
+    m_explainView->show();
+    m_explainView->raise();
+}
+
 // onEngineChanged removed in offline-only mode
 
 void MainWindow::showSettings() {
@@ -303,44 +511,162 @@ void MainWindow::loadSettings() {
     // Implementation would load saved settings
 }
 
-// Stub implementations
+void MainWindow::setupSystemTray() {
+    if (m_systemTray || !QSystemTrayIcon::isSystemTrayAvailable()) return;
+    
+    m_trayMenu = new QMenu(this);
+    m_trayMenu->addAction("&Show", this, &MainWindow::showAndActivate);
+    m_trayMenu->addAction("&Hide", this, &QWidget::hide);
+    m_trayMenu->addSeparator();
+    m_trayMenu->addAction("&Quit", qApp, &QCoreApplication::quit);
+    
+    QIcon icon = windowIcon();
+    if (icon.isNull()) icon = style()->standardIcon(QStyle::SP_FileDialogContentsView);
+    m_systemTray = new QSystemTrayIcon(icon, this);
+    m_systemTray->setToolTip("Imilya Minds");
+    m_systemTray->setContextMenu(m_trayMenu);
+    connect(m_systemTray, &QSystemTrayIcon::activated, this, &MainWindow::onSystemTrayActivated);
+    m_systemTray->show();
+}
+
+void MainWindow::setResident(bool resident) {
+    m_enableSystemTray = resident;
+    if (resident) {
+        setupSystemTray();
+    } else if (m_systemTray) {
+        m_systemTray->hide();
+    }
+}
+
+bool MainWindow::isResident() const {
+    return m_enableSystemTray && m_systemTray && m_systemTray->isVisible();
+}
+
+void MainWindow::closeEvent(QCloseEvent* event) {
+    if (isResident()) {
+        // Stay warm in the tray so the next launch is just a socket message
+        hide();
+        event->ignore();
+        return;
+    }
+    QMainWindow::closeEvent(event);
+    qApp->quit();
+}
+
 void MainWindow::onSystemTrayActivated(QSystemTrayIcon::ActivationReason reason) {
-    Q_UNUSED(reason)
+    if (reason == QSystemTrayIcon::Trigger || reason == QSystemTrayIcon::DoubleClick) {
+        toggleWindowVisibility();
+    }
 }
 
 void MainWindow::toggleWindowVisibility() {
-    setVisible(!isVisible());
+    if (isVisible() && isActiveWindow()) {
+        hide();
+    } else {
+        showAndActivate();
+    }
 }
 
-void MainWindow::setupAutoComplete() {}
+void MainWindow::showAndActivate() {
+    if (isMinimized()) {
+        showNormal();
+    } else {
+        show();
+    }
+    raise();
+    activateWindow();
+    m_searchInput->setFocus();
+}
+
+void MainWindow::runSearch(const QString& query) {
+    showAndActivate();
+    if (query.trimmed().isEmpty()) return;
+    if (m_searchInProgress) {
+        // A forwarded query replaces whatever is still streaming
+        m_searchEngine->cancelSearch();
+        m_activeSearchId = 0;
+        setSearchInProgress(false);
+    }
+    // Set the text without a suggestion pass; performSearch() takes it from here
+    const QSignalBlocker blocker(m_searchInput);
+    m_searchInput->setText(query.trimmed());
+    performSearch();
+}
+
+void MainWindow::setupAutoComplete() {
+    // Suggestions arrive pre-ranked and pre-filtered from the engine, so the
+    // completer shows them as-is instead of re-filtering on every keystroke
+    m_completerModel = new QStringListModel(this);
+    m_completer = new QCompleter(m_completerModel, this);
+    m_completer->setCaseSensitivity(Qt::CaseInsensitive);
+    m_completer->setCompletionMode(QCompleter::UnfilteredPopupCompletion);
+    m_searchInput->setCompleter(m_completer);
+
+    // Debounce: only compute once typing pauses
+    m_suggestionTimer = new QTimer(this);
+    m_suggestionTimer->setSingleShot(true);
+    m_suggestionTimer->setInterval(120);
+    connect(m_suggestionTimer, &QTimer::timeout, this, &MainWindow::updateSearchSuggestions);
+
+    m_suggestionEngine = new SuggestionEngine(m_offlineQA, m_searchHistory, this);
+    connect(m_suggestionEngine, &SuggestionEngine::suggestionsReady, this,
+            [this](const QString& query, const QStringList& suggestions) {
+                if (query != m_searchInput->text().trimmed()) return;
+                onSuggestionsReady(suggestions);
+            });
+}
 
 void MainWindow::showLoadingScreen() {
+    // Non-modal: the window stays usable while the splash tracks real progress
     m_loadingScreen = new LoadingScreen(this);
+    m_loadingScreen->move((width() - m_loadingScreen->width()) / 2,
+                          (height() - m_loadingScreen->height()) / 2);
     connect(m_loadingScreen, &LoadingScreen::loadingFinished, this, [this]() {
-        show();
-        activateWindow();
+        m_loadingScreen->deleteLater();
+        m_loadingScreen = nullptr;
+        m_searchInput->setFocus();
     });
+    m_loadingScreen->setAttribute(Qt::WA_TransparentForMouseEvents);
+    m_loadingScreen->show();
+    m_loadingScreen->raise();
     m_loadingScreen->startLoading();
+    m_loadingScreen->setProgress(m_loadProgressBar->value());
+}
+
+void MainWindow::onDatabaseLoadProgress(int percent, int filesDone, int fileCount, int entriesLoaded) {
+    Q_UNUSED(filesDone)
+    Q_UNUSED(fileCount)
+    m_loadProgressBar->setValue(percent);
+    m_loadProgressBar->setToolTip(QString("%1 entries loaded").arg(entriesLoaded));
+    if (m_loadingScreen) m_loadingScreen->setProgress(percent);
+}
+
+void MainWindow::onDatabaseLoaded(int totalEntries) {
+    m_loadProgressBar->hide();
+    if (m_loadingScreen) {
+        m_loadingScreen->setStatus("Ready");
+        m_loadingScreen->setProgress(100);
+    }
+    statusBar()->showMessage(QString("Knowledge base ready: %1 entries").arg(totalEntries), 3000);
+
+    // Anything prefetched so far only saw part of the data
+    m_searchEngine->invalidateSpeculation();
+
+    if (m_searchedWhileLoading && !m_currentQuery.isEmpty()) {
+        // Re-run the last query against the complete database
+        m_searchedWhileLoading = false;
+        setSearchInProgress(true);
+        m_resultsWidget->beginStreaming();
+        m_activeSearchId = m_searchEngine->startSearch(m_currentQuery);
+    }
 }
 
 void MainWindow::setupAnimations() {
-    qDebug() << "setupAnimations: start";
+    if (m_searchAnimation) return;
     // Search button animation
-    m_searchAnimation = new QPropertyAnimation(m_searchButton, "geometry");
+    m_searchAnimation = new QPropertyAnimation(m_searchButton, "geometry", this);
     m_searchAnimation->setDuration(200);
     m_searchAnimation->setEasingCurve(QEasingCurve::OutCubic);
-    
-    // Results fade in animation
-    m_resultsOpacityEffect = new QGraphicsOpacityEffect(m_resultsWidget);
-    m_resultsWidget->setGraphicsEffect(m_resultsOpacityEffect);
-    m_resultsOpacityEffect->setOpacity(0.0);
-    
-    m_resultsAnimation = new QPropertyAnimation(m_resultsOpacityEffect, "opacity");
-    m_resultsAnimation->setDuration(500);
-    m_resultsAnimation->setStartValue(0.0);
-    m_resultsAnimation->setEndValue(1.0);
-    m_resultsAnimation->setEasingCurve(QEasingCurve::OutCubic);
-    qDebug() << "setupAnimations: end";
 }
 
 void MainWindow::applyFuturisticStyle() {
@@ -352,253 +678,43 @@ void MainWindow::applyFuturisticStyle() {
 }
 
 void MainWindow::applyBestStyle() {
-    setStyleSheet(R"(
-        QMainWindow {
-            background: #f6f7fb;
-            color: #111111;
-        }
-        #TopBar {
-            background: #ffffff;
-            border-bottom: 1px solid #e1e4ea;
-        }
-        QLineEdit {
-            background-color: #ffffff;
-            border: 2px solid #e1e4ea;
-            border-radius: 8px;
-            padding: 8px 12px;
-            font-size: 14px;
-            color: #111111;
-            selection-background-color: #4a90e2;
-        }
-        QLineEdit:focus { border-color: #4a90e2; }
-        QPushButton {
-            background: qlineargradient(x1:0, y1:0, x2:0, y2:1,
-                stop:0 #4a90e2, stop:1 #357ab8);
-            border: none;
-            border-radius: 10px;
-            padding: 10px 18px;
-            font-size: 14px;
-            font-weight: 600;
-            color: #ffffff;
-            min-height: 20px;
-            box-shadow: 0px 2px 6px rgba(0,0,0,0.15);
-        }
-        QPushButton:hover {
-            background: qlineargradient(x1:0, y1:0, x2:0, y2:1,
-                stop:0 #5aa0f2, stop:1 #468bcd);
-        }
-        QPushButton:disabled { background-color: #c9ced8; color: #8c96a8; }
-        QProgressBar { border: none; border-radius: 4px; background-color: #e9edf3; text-align: center; height: 8px; }
-        QProgressBar::chunk { background: #4a90e2; border-radius: 4px; }
-        QLabel { color: #333333; font-size: 13px; }
-        QSplitter::handle { background-color: #d9dde5; border-radius: 2px; }
-        QTextBrowser {
-            background-color: #ffffff;
-            border: 2px solid #e1e4ea;
-            border-radius: 12px;
-            padding: 16px;
-            color: #222222;
-            font-size: 14px;
-            line-height: 1.5;
-        }
-        QMenuBar { background-color: #ffffff; color: #111111; border-bottom: 1px solid #e1e4ea; }
-        QMenuBar::item { background-color: transparent; padding: 8px 12px; }
-        QMenuBar::item:selected { background-color: #4a90e2; color: #ffffff; }
-        QMenu { background-color: #ffffff; border: 1px solid #e1e4ea; border-radius: 8px; padding: 4px; }
-        QMenu::item { padding: 8px 20px; color: #111111; }
-        QMenu::item:selected { background-color: #4a90e2; color: #ffffff; }
-        QStatusBar { background-color: #ffffff; color: #333333; border-top: 1px solid #e1e4ea; }
-    )");
+    // Prebuilt palette swap; no stylesheet parsing or re-polish
+    ThemeEngine::instance()->applyTheme("Best");
     setWindowTitle("Imilya Minds - Best Mode");
     if (m_resultsWidget) m_resultsWidget->applyLightStyle();
 }
 
 void MainWindow::applyBeastStyle() {
-    setStyleSheet(R"(
-        QMainWindow {
-            background: qlineargradient(x1:0, y1:0, x2:0, y2:1,
-                stop:0 #1a1a1a, stop:1 #0a0a0a);
-            color: #ffffff;
-        }
-        #TopBar {
-            background: #141414;
-            border-bottom: 1px solid #2a2a2a;
-        }
-        
-        QLineEdit {
-            background-color: #2a2a2a;
-            border: 2px solid #333333;
-            border-radius: 8px;
-            padding: 8px 12px;
-            font-size: 14px;
-            color: #ffffff;
-            selection-background-color: #00d4ff;
-        }
-        
-        QLineEdit:focus {
-            border-color: #00d4ff;
-            background-color: #333333;
-        }
-        
-        QPushButton {
-            background: qlineargradient(x1:0, y1:0, x2:0, y2:1,
-                stop:0 #00d4ff, stop:1 #0099ff);
-            border: none;
-            border-radius: 10px;
-            padding: 10px 18px;
-            font-size: 14px;
-            font-weight: bold;
-            color: #ffffff;
-            min-height: 20px;
-            box-shadow: 0px 2px 8px rgba(0, 212, 255, 0.2);
-        }
-        
-        QPushButton:hover {
-            background: qlineargradient(x1:0, y1:0, x2:0, y2:1,
-                stop:0 #00e6ff, stop:1 #00aaff);
-        }
-        
-        QPushButton:pressed {
-            background: qlineargradient(x1:0, y1:0, x2:0, y2:1,
-                stop:0 #0099ff, stop:1 #0077cc);
-        }
-        
-        QPushButton:disabled {
-            background-color: #555555;
-            color: #888888;
-        }
-        
-        QComboBox {
-            background-color: #2a2a2a;
-            border: 2px solid #333333;
-            border-radius: 8px;
-            padding: 8px 12px;
-            font-size: 14px;
-            color: #ffffff;
-            min-height: 20px;
-        }
-        
-        QComboBox:focus {
-            border-color: #00d4ff;
-        }
-        
-        QComboBox::drop-down {
-            border: none;
-            width: 20px;
-        }
-        
-        QComboBox::down-arrow {
-            image: none;
-            border-left: 5px solid transparent;
-            border-right: 5px solid transparent;
-            border-top: 5px solid #ffffff;
-            margin-right: 5px;
-        }
-        
-        QProgressBar {
-            border: none;
-            border-radius: 4px;
-            background-color: #2a2a2a;
-            text-align: center;
-            height: 8px;
-        }
-        
-        QProgressBar::chunk {
-            background: qlineargradient(x1:0, y1:0, x2:1, y2:0,
-                stop:0 #00d4ff, stop:0.5 #0099ff, stop:1 #00d4ff);
-            border-radius: 4px;
-        }
-        
-        QLabel {
-            color: #cccccc;
-            font-size: 13px;
-        }
-        
-        QSplitter::handle {
-            background-color: #333333;
-            border-radius: 2px;
-        }
-        
-        QSplitter::handle:hover {
-            background-color: #00d4ff;
-        }
-        
-        QTextBrowser {
-            background-color: #2a2a2a;
-            border: 2px solid #333333;
-            border-radius: 12px;
-            padding: 16px;
-            color: #ffffff;
-            font-size: 14px;
-            line-height: 1.55;
-        }
-        
-        QMenuBar {
-            background-color: #1a1a1a;
-            color: #ffffff;
-            border-bottom: 1px solid #333333;
-        }
-        
-        QMenuBar::item {
-            background-color: transparent;
-            padding: 8px 12px;
-        }
-        
-        QMenuBar::item:selected {
-            background-color: #00d4ff;
-            color: #000000;
-        }
-        
-        QMenu {
-            background-color: #2a2a2a;
-            border: 1px solid #333333;
-            border-radius: 8px;
-            padding: 4px;
-        }
-        
-        QMenu::item {
-            padding: 8px 20px;
-            color: #ffffff;
-        }
-        
-        QMenu::item:selected {
-            background-color: #00d4ff;
-            color: #000000;
-        }
-        
-        QStatusBar {
-            background-color: #1a1a1a;
-            color: #cccccc;
-            border-top: 1px solid #333333;
-        }
-    )");
+    ThemeEngine::instance()->applyTheme("Beast");
     setWindowTitle("Imilya Minds - Beast Mode");
-    setMinimumSize(1000, 700);
-    resize(1200, 800);
     if (m_resultsWidget) m_resultsWidget->applyDarkStyle();
 }
 
 void MainWindow::navigateTo(const SearchResult& result) {
-    QString descHtml = result.description;
-    descHtml.replace('\n', "<br/>");
     // Display a compact banner in status bar instead of side preview
     statusBar()->showMessage(QString("%1 — %2").arg(result.title, result.displayUrl), 5000);
     updateUrlBar(result);
 
-    // Manage history
-    if (m_historyIndex >= 0 && m_historyIndex < m_navigationHistory.size()-1) {
-        m_navigationHistory = m_navigationHistory.mid(0, m_historyIndex + 1);
+    // Only results the database can hand back again are worth remembering
+    if (result.entryId >= 0) {
+        m_navigation.push(result.entryId, result.relevanceScore);
     }
-    m_navigationHistory.append(result);
-    m_historyIndex = m_navigationHistory.size() - 1;
-
-    m_backButton->setEnabled(m_historyIndex > 0);
+    m_backButton->setEnabled(m_navigation.canGoBack());
     m_forwardButton->setEnabled(false);
 }
 
+void MainWindow::showNavigationStep(const NavigationHistory::Step& step) {
+    SearchResult r = m_offlineQA->entryAt(step.entryId);
+    r.relevanceScore = step.score;
+    statusBar()->showMessage(QString("%1 — %2").arg(r.title, r.displayUrl), 5000);
+    updateUrlBar(r);
+    m_backButton->setEnabled(m_navigation.canGoBack());
+    m_forwardButton->setEnabled(m_navigation.canGoForward());
+}
+
 void MainWindow::quickCopyAnswer() {
-    if (m_navigationHistory.isEmpty()) return;
-    const SearchResult& r = m_navigationHistory.last();
+    if (m_navigation.isEmpty()) return;
+    const SearchResult r = m_offlineQA->entryAt(m_navigation.current().entryId);
     QClipboard* cb = QApplication::clipboard();
     if (!cb) return;
     cb->setText(QString("%1\n%2").arg(r.title, r.description));
@@ -614,24 +730,14 @@ void MainWindow::updateUrlBar(const SearchResult& result) {
 }
 
 void MainWindow::onBack() {
-    if (m_historyIndex > 0) {
-        m_historyIndex--;
-        const SearchResult& r = m_navigationHistory.at(m_historyIndex);
-        statusBar()->showMessage(QString("%1 — %2").arg(r.title, r.displayUrl), 5000);
-        updateUrlBar(r);
-        m_backButton->setEnabled(m_historyIndex > 0);
-        m_forwardButton->setEnabled(m_historyIndex < m_navigationHistory.size() - 1);
+    if (m_navigation.canGoBack()) {
+        showNavigationStep(m_navigation.back());
     }
 }
 
 void MainWindow::onForward() {
-    if (m_historyIndex < m_navigationHistory.size() - 1) {
-        m_historyIndex++;
-        const SearchResult& r = m_navigationHistory.at(m_historyIndex);
-        statusBar()->showMessage(QString("%1 — %2").arg(r.title, r.displayUrl), 5000);
-        updateUrlBar(r);
-        m_backButton->setEnabled(m_historyIndex > 0);
-        m_forwardButton->setEnabled(m_historyIndex < m_navigationHistory.size() - 1);
+    if (m_navigation.canGoForward()) {
+        showNavigationStep(m_navigation.forward());
     }
 }
 
@@ -650,31 +756,4 @@ void MainWindow::toggleTheme() {
     applyFuturisticStyle();
 }
 
-QVector<SearchResult> MainWindow::buildOfflineResults(const QString& query) const {
-    QVector<SearchResult> results;
-    if (m_offlineQA->hasOfflineAnswer(query)) {
-        SearchResult answer = m_offlineQA->getOfflineAnswer(query);
-        if (answer.isValid()) {
-            results.append(answer);
-        }
-    }
-    // Broaden with suggestions
-    QStringList suggestions = m_offlineQA->getSuggestions(query);
-    for (const QString& s : suggestions) {
-        SearchResult r = m_offlineQA->getOfflineAnswer(s);
-        if (r.isValid()) {
-            results.append(r);
-        }
-    }
-    // If still empty, include more from catalog
-    if (results.isEmpty()) {
-        QVector<SearchResult> all = m_offlineQA->getAllOfflineAnswers();
-        int limit = qMin(25, all.size());
-        for (int i = 0; i < limit; ++i) {
-            results.append(all.at(i));
-        }
-    }
-    return results;
-}
-
 #include "MainWindow.moc"
@@ -0,0 +1,181 @@
+#include "Metrics.h"
+#include <QDebug>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <cmath>
+
+namespace {
+const char* const kPrefix = "imilya_";
+
+// Prometheus buckets: powers of four from ~1 us to ~69 s, on bucket boundaries
+constexpr int kFirstBoundBits = 10;
+constexpr int kLastBoundBits = 36;
+
+int highestBit(quint64 value) {
+    int bit = 0;
+    while (value >>= 1) ++bit;
+    return bit;
+}
+
+QByteArray seconds(double nanos) {
+    return QByteArray::number(nanos / 1e9, 'g', 6);
+}
+}
+
+// Buckets are (lower, upper], like Prometheus le: one nanosecond is taken off
+// before bucketing and added back to the bound, so 2^k lands below 2^k + 1
+int Metrics::Histogram::bucketOf(quint64 nanos) {
+    if (nanos > 0) --nanos;
+    if (nanos < quint64(kSubBuckets)) return int(nanos);
+    const int exponent = highestBit(nanos);
+    const int sub = int((nanos >> (exponent - kSubBits)) & (kSubBuckets - 1));
+    return (exponent - kSubBits + 1) * kSubBuckets + sub;
+}
+
+quint64 Metrics::Histogram::bucketUpperBound(int bucket) {
+    if (bucket < kSubBuckets) return quint64(bucket) + 1;
+    const int shift = bucket / kSubBuckets - 1;
+    const quint64 lower = quint64(kSubBuckets + bucket % kSubBuckets) << shift;
+    return lower + (quint64(1) << shift);
+}
+
+void Metrics::Histogram::record(qint64 nanos) {
+    nanos = qMax<qint64>(0, nanos);
+    m_buckets[bucketOf(quint64(nanos))].fetchAndAddRelaxed(1);
+    m_count.fetchAndAddRelaxed(1);
+    m_total.fetchAndAddRelaxed(nanos);
+    qint64 seen = m_max.loadRelaxed();
+    while (nanos > seen && !m_max.testAndSetRelaxed(seen, nanos, seen)) {}
+}
+
+double Metrics::Histogram::meanNs() const {
+    const quint64 samples = count();
+    return samples ? double(totalNs()) / double(samples) : 0.0;
+}
+
+qint64 Metrics::Histogram::percentileNs(double p) const {
+    const quint64 samples = count();
+    if (samples == 0) return 0;
+    const quint64 rank = qMax<quint64>(1, quint64(std::ceil(qBound(0.0, p, 100.0) / 100.0 * double(samples))));
+    quint64 seen = 0;
+    for (int bucket = 0; bucket < kBuckets; ++bucket) {
+        seen += m_buckets[bucket].loadRelaxed();
+        if (seen >= rank) return qMin(qint64(bucketUpperBound(bucket)), maxNs());
+    }
+    return maxNs();
+}
+
+quint64 Metrics::Histogram::countAtOrBelow(qint64 nanos) const {
+    quint64 atOrBelow = 0;
+    for (int bucket = 0; bucket < kBuckets && bucketUpperBound(bucket) <= quint64(nanos); ++bucket) {
+        atOrBelow += m_buckets[bucket].loadRelaxed();
+    }
+    return atOrBelow;
+}
+
+Metrics* Metrics::instance() {
+    // Lives for the whole process; metrics are recorded up to the last moment
+    static Metrics* metrics = new Metrics;
+    return metrics;
+}
+
+Metrics::Counter& Metrics::counter(const QString& name, const QString& help) {
+    QMutexLocker locker(&m_mutex);
+    auto it = m_byName.constFind(name);
+    if (it != m_byName.constEnd()) {
+        if (const Counter* existing = m_metrics.at(it.value()).counter) return *const_cast<Counter*>(existing);
+        // Two # TYPE lines for one family and scrapers reject the whole page
+        Q_ASSERT_X(false, "Metrics::counter", "name already registered as a histogram");
+        qWarning() << "Metrics:" << name << "is already a histogram; counter not exported";
+        static Counter detached;
+        return detached;
+    }
+    m_counters.push_back(std::make_unique<Counter>());
+    m_byName.insert(name, int(m_metrics.size()));
+    m_metrics.append({name, help, m_counters.back().get(), nullptr});
+    return *m_counters.back();
+}
+
+Metrics::Histogram& Metrics::histogram(const QString& name, const QString& help) {
+    QMutexLocker locker(&m_mutex);
+    auto it = m_byName.constFind(name);
+    if (it != m_byName.constEnd()) {
+        if (const Histogram* existing = m_metrics.at(it.value()).histogram) return *const_cast<Histogram*>(existing);
+        Q_ASSERT_X(false, "Metrics::histogram", "name already registered as a counter");
+        qWarning() << "Metrics:" << name << "is already a counter; histogram not exported";
+        static Histogram detached;
+        return detached;
+    }
+    m_histograms.push_back(std::make_unique<Histogram>());
+    m_byName.insert(name, int(m_metrics.size()));
+    m_metrics.append({name, help, nullptr, m_histograms.back().get()});
+    return *m_histograms.back();
+}
+
+QVector<Metrics::Metric> Metrics::metrics() const {
+    QMutexLocker locker(&m_mutex);
+    return m_metrics;
+}
+
+QByteArray Metrics::prometheusText() const {
+    QByteArray out;
+    for (const Metric& metric : metrics()) {
+        const QByteArray name = kPrefix + metric.name.toUtf8();
+        out += "# HELP " + name + ' ' + metric.help.toUtf8() + '\n';
+        if (metric.counter) {
+            out += "# TYPE " + name + " counter\n";
+            out += name + ' ' + QByteArray::number(metric.counter->value()) + '\n';
+            continue;
+        }
+        const Histogram& histogram = *metric.histogram;
+        out += "# TYPE " + name + " histogram\n";
+        for (int bits = kFirstBoundBits; bits <= kLastBoundBits; bits += 2) {
+            const qint64 bound = qint64(1) << bits;
+            out += name + "_bucket{le=\"" + seconds(double(bound)) + "\"} "
+                + QByteArray::number(histogram.countAtOrBelow(bound)) + '\n';
+        }
+        out += name + "_bucket{le=\"+Inf\"} " + QByteArray::number(histogram.count()) + '\n';
+        out += name + "_sum " + seconds(double(histogram.totalNs())) + '\n';
+        out += name + "_count " + QByteArray::number(histogram.count()) + '\n';
+    }
+    return out;
+}
+
+QByteArray Metrics::json() const {
+    QJsonObject counters;
+    QJsonObject histograms;
+    for (const Metric& metric : metrics()) {
+        if (metric.counter) {
+            counters[metric.name] = double(metric.counter->value());
+            continue;
+        }
+        const Histogram& histogram = *metric.histogram;
+        QJsonObject row;
+        row["count"] = double(histogram.count());
+        row["mean_ms"] = histogram.meanNs() / 1e6;
+        row["p50_ms"] = histogram.percentileNs(50) / 1e6;
+        row["p90_ms"] = histogram.percentileNs(90) / 1e6;
+        row["p99_ms"] = histogram.percentileNs(99) / 1e6;
+        row["max_ms"] = histogram.maxNs() / 1e6;
+        histograms[metric.name] = row;
+    }
+    QJsonObject root;
+    root["counters"] = counters;
+    root["histograms"] = histograms;
+    return QJsonDocument(root).toJson(QJsonDocument::Indented);
+}
+
+bool Metrics::exportToFile(const QString& filePath) const {
+    const QByteArray data = filePath.endsWith(".json", Qt::CaseInsensitive) ? json() : prometheusText();
+    QFile file;
+    bool opened;
+    if (filePath == "-") {
+        opened = file.open(stdout, QIODevice::WriteOnly);
+    } else {
+        file.setFileName(filePath);
+        opened = file.open(QIODevice::WriteOnly | QIODevice::Truncate);
+    }
+    return opened && file.write(data) == data.size();
+}
@@ -0,0 +1,83 @@
+#include "MetricsDialog.h"
+#include "Metrics.h"
+#include <QDialogButtonBox>
+#include <QFileDialog>
+#include <QHeaderView>
+#include <QMessageBox>
+#include <QVBoxLayout>
+
+MetricsDialog::MetricsDialog(QWidget *parent)
+    : QDialog(parent)
+{
+    setWindowTitle("Metrics");
+    resize(760, 420);
+
+    m_table = new QTreeWidget(this);
+    m_table->setRootIsDecorated(false);
+    m_table->setUniformRowHeights(true);
+    m_table->setHeaderLabels({"Metric", "Count", "p50 ms", "p90 ms", "p99 ms", "Max ms"});
+    m_table->header()->setSectionResizeMode(0, QHeaderView::Stretch);
+
+    QDialogButtonBox* buttons = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    m_exportButton = buttons->addButton("Export…", QDialogButtonBox::ActionRole);
+    connect(m_exportButton, &QPushButton::clicked, this, &MetricsDialog::exportMetrics);
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+
+    QVBoxLayout* layout = new QVBoxLayout(this);
+    layout->addWidget(m_table);
+    layout->addWidget(buttons);
+
+    // Refreshed only while open
+    m_refreshTimer = new QTimer(this);
+    m_refreshTimer->setInterval(1000);
+    connect(m_refreshTimer, &QTimer::timeout, this, &MetricsDialog::refresh);
+}
+
+void MetricsDialog::showEvent(QShowEvent* event) {
+    refresh();
+    m_refreshTimer->start();
+    QDialog::showEvent(event);
+}
+
+void MetricsDialog::hideEvent(QHideEvent* event) {
+    m_refreshTimer->stop();
+    QDialog::hideEvent(event);
+}
+
+void MetricsDialog::refresh() {
+    const QVector<Metrics::Metric> metrics = Metrics::instance()->metrics();
+    // Metrics are only ever added, so rows can be updated in place
+    while (m_table->topLevelItemCount() < metrics.size()) {
+        QTreeWidgetItem* item = new QTreeWidgetItem(m_table);
+        for (int column = 1; column < m_table->columnCount(); ++column) {
+            item->setTextAlignment(column, Qt::AlignRight | Qt::AlignVCenter);
+        }
+    }
+
+    auto ms = [](qint64 nanos) { return QString::number(nanos / 1e6, 'f', 3); };
+    for (int i = 0; i < metrics.size(); ++i) {
+        const Metrics::Metric& metric = metrics.at(i);
+        QTreeWidgetItem* item = m_table->topLevelItem(i);
+        item->setText(0, metric.name);
+        item->setToolTip(0, metric.help);
+        if (metric.counter) {
+            item->setText(1, QString::number(metric.counter->value()));
+            continue;
+        }
+        const Metrics::Histogram& histogram = *metric.histogram;
+        item->setText(1, QString::number(histogram.count()));
+        item->setText(2, ms(histogram.percentileNs(50)));
+        item->setText(3, ms(histogram.percentileNs(90)));
+        item->setText(4, ms(histogram.percentileNs(99)));
+        item->setText(5, ms(histogram.maxNs()));
+    }
+}
+
+void MetricsDialog::exportMetrics() {
+    const QString filePath = QFileDialog::getSaveFileName(
+        this, "Export metrics", "imilya-metrics.prom", "Prometheus text (*.prom *.txt);;JSON (*.json)");
+    if (filePath.isEmpty()) return;
+    if (!Metrics::instance()->exportToFile(filePath)) {
+        QMessageBox::warning(this, "Export metrics", QString("Could not write %1").arg(filePath));
+    }
+}
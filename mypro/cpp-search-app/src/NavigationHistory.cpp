@@ -0,0 +1,39 @@
+#include "NavigationHistory.h"
+
+NavigationHistory::NavigationHistory(int capacity)
+    : m_ring(qMax(2, capacity))
+{
+}
+
+void NavigationHistory::push(int entryId, double score) {
+    // Forward steps are just forgotten; their slots are reused as we go
+    m_size = m_position + 1;
+    if (m_size == m_ring.size()) {
+        m_start = (m_start + 1) % m_ring.size();
+        --m_size;
+    }
+    Step& step = m_ring[(m_start + m_size) % m_ring.size()];
+    step.entryId = entryId;
+    step.score = float(score);
+    m_position = m_size++;
+}
+
+void NavigationHistory::clear() {
+    m_start = 0;
+    m_size = 0;
+    m_position = -1;
+}
+
+NavigationHistory::Step NavigationHistory::back() {
+    if (canGoBack()) --m_position;
+    return current();
+}
+
+NavigationHistory::Step NavigationHistory::forward() {
+    if (canGoForward()) ++m_position;
+    return current();
+}
+
+NavigationHistory::Step NavigationHistory::current() const {
+    return m_position >= 0 ? at(m_position) : Step();
+}
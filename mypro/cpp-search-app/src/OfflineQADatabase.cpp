@@ -1,47 +1,170 @@
 #include "OfflineQADatabase.h"
+#include "BuiltinCorpus.h"
+#include "Metrics.h"
+#include "Tracer.h"
 #include <QDateTime>
-#include <QDebug>
-#include <QApplication>
+#include <QCoreApplication>
 #include <QFile>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QTextStream>
 #include <QDir>
+#include <QFileInfo>
+#include <QThread>
+#include <QReadLocker>
+#include <QSet>
+#include <QWriteLocker>
+#include <algorithm>
+
+namespace {
+// Entries inserted per write-lock hold, so readers never wait long
+constexpr int kInsertBatch = 1000;
+
+// Exact, question contains query, query contains question; 0 for no match
+template <typename Question>
+double matchScore(const Question& question, const QString& cleanQuery)
+{
+    if (question.compare(cleanQuery, Qt::CaseInsensitive) == 0) return 1.0;
+    if (question.contains(cleanQuery, Qt::CaseInsensitive)) return 0.8;
+    if (cleanQuery.contains(question, Qt::CaseInsensitive)) return 0.6;
+    return 0.0;
+}
+}
 
 OfflineQADatabase::OfflineQADatabase(QObject *parent)
     : QObject(parent)
+    , m_loaderThread(nullptr)
+    , m_loaded(false)
+    , m_abortLoading(false)
+    , m_shardIndex(0)
+    , m_shardCount(1)
 {
-    initializeDatabase();
+    // Built-in answers are compiled in (BuiltinCorpus); nothing to do until
+    // the external data packs are loaded
 }
 
 OfflineQADatabase::~OfflineQADatabase()
 {
+    if (m_loaderThread) {
+        m_abortLoading.storeRelease(true);
+        m_loaderThread->wait();
+    }
+}
+
+void OfflineQADatabase::setShard(int index, int count)
+{
+    m_shardCount = qMax(1, count);
+    m_shardIndex = qBound(0, index, m_shardCount - 1);
+}
+
+int OfflineQADatabase::shardOf(const QString& question, int count)
+{
+    // 32-bit FNV-1a over the normalized UTF-8: fixed by definition, unlike qHash,
+    // whose algorithm depends on the Qt version and the CPU (AES hashing), so
+    // shard daemons built or run anywhere agree on where a question lives
+    quint32 hash = 2166136261u;
+    for (const char byte : question.toLower().trimmed().toUtf8()) {
+        hash ^= quint8(byte);
+        hash *= 16777619u;
+    }
+    return int(hash % quint32(qMax(1, count)));
+}
+
+void OfflineQADatabase::loadExternalDataAsync()
+{
+    if (m_loaderThread || isLoaded()) return;
+    m_loaderThread = QThread::create([this]() { loadExternalData(); });
+    m_loaderThread->setParent(this);
+    m_loaderThread->setObjectName("OfflineQALoader");
+    m_loaderThread->start(QThread::LowPriority);
 }
 
-void OfflineQADatabase::initializeDatabase()
+void OfflineQADatabase::loadExternalDataSync()
 {
-    addGreetings();
-    addCommonQuestions();
-    addTechnicalQuestions();
-    addGeneralKnowledge();
+    if (m_loaderThread || isLoaded()) return;
     loadExternalData();
-    
-    qDebug() << "Offline Q&A Database initialized with" << m_qaDatabase.size() << "entries";
 }
-void OfflineQADatabase::loadExternalData()
+
+QStringList OfflineQADatabase::externalDataFiles()
 {
-    QString baseDir = QApplication::applicationDirPath() + "/resources/data";
+    // IMILYA_DATA_DIR points benchmarks and tests at a different corpus
+    QString baseDir = qEnvironmentVariable("IMILYA_DATA_DIR");
+    if (baseDir.isEmpty()) {
+        baseDir = QCoreApplication::applicationDirPath() + "/resources/data";
+    }
     QDir dir(baseDir);
-    if (!dir.exists()) return;
-    QStringList jsonFiles = dir.entryList({"*.json"}, QDir::Files);
-    QStringList csvFiles = dir.entryList({"*.csv"}, QDir::Files);
-    for (const QString& f : jsonFiles) addFromJsonFile(dir.filePath(f));
-    for (const QString& f : csvFiles) addFromCsvFile(dir.filePath(f));
+    if (!dir.exists()) return {};
+    QStringList files;
+    for (const QString& f : dir.entryList({"*.json"}, QDir::Files)) files << dir.filePath(f);
+    for (const QString& f : dir.entryList({"*.csv"}, QDir::Files)) files << dir.filePath(f);
+    return files;
 }
 
-void OfflineQADatabase::addFromJsonFile(const QString& filePath)
+void OfflineQADatabase::loadExternalData()
 {
+    static Metrics::Histogram& loadTime = Metrics::instance()->histogram(
+        "database_load_seconds", "Time to load the external data packs");
+    static Metrics::Counter& loadedEntries = Metrics::instance()->counter(
+        "database_entries_loaded_total", "Q&A entries loaded from data packs");
+    Metrics::ScopedTimer timer(loadTime);
+    TraceSpan span("OfflineQADatabase::loadExternalData");
+    const QStringList files = externalDataFiles();
+
+    // Progress is weighted by file size so one big pack does not stall the bar
+    qint64 totalBytes = 0;
+    for (const QString& f : files) totalBytes += qMax<qint64>(1, QFileInfo(f).size());
+    qint64 doneBytes = 0;
+    int entriesLoaded = 0;
+
+    for (int fileIndex = 0; fileIndex < files.size(); ++fileIndex) {
+        if (m_abortLoading.loadAcquire()) return;
+        const QString& filePath = files.at(fileIndex);
+        const qint64 fileBytes = qMax<qint64>(1, QFileInfo(filePath).size());
+        emit fileLoadStarted(QFileInfo(filePath).fileName(), fileIndex, files.size());
+
+        QVector<PendingQA> entries;
+        if (filePath.endsWith(".json", Qt::CaseInsensitive)) {
+            readJsonFile(filePath, entries);
+        } else {
+            readCsvFile(filePath, entries);
+        }
+        if (m_shardCount > 1) {
+            entries.erase(std::remove_if(entries.begin(), entries.end(), [this](const PendingQA& entry) {
+                return shardOf(entry.question, m_shardCount) != m_shardIndex;
+            }), entries.end());
+        }
+
+        for (int begin = 0; begin < entries.size(); begin += kInsertBatch) {
+            if (m_abortLoading.loadAcquire()) return;
+            const int end = qMin(begin + kInsertBatch, int(entries.size()));
+            {
+                QWriteLocker locker(&m_lock);
+                for (int i = begin; i < end; ++i) {
+                    const PendingQA& entry = entries.at(i);
+                    addQA(entry.question, entry.answer, entry.category);
+                }
+            }
+            entriesLoaded += end - begin;
+            loadedEntries.add(quint64(end - begin));
+            const qint64 fileDone = fileBytes * end / entries.size();
+            emit loadProgress(int(100 * (doneBytes + fileDone) / qMax<qint64>(1, totalBytes)),
+                              fileIndex, files.size(), entriesLoaded);
+        }
+
+        doneBytes += fileBytes;
+        emit loadProgress(int(100 * doneBytes / qMax<qint64>(1, totalBytes)),
+                          fileIndex + 1, files.size(), entriesLoaded);
+    }
+
+    m_loaded.storeRelease(true);
+    const int total = questionCount();
+    emit loadFinished(total);
+}
+
+void OfflineQADatabase::readJsonFile(const QString& filePath, QVector<PendingQA>& out)
+{
+    TraceSpan span("OfflineQADatabase::readJsonFile");
     QFile file(filePath);
     if (!file.open(QIODevice::ReadOnly)) return;
     QByteArray data = file.readAll();
@@ -49,36 +172,23 @@ void OfflineQADatabase::addFromJsonFile(const QString& filePath)
     QJsonParseError err;
     QJsonDocument doc = QJsonDocument::fromJson(data, &err);
     if (err.error != QJsonParseError::NoError) return;
-    if (doc.isArray()) {
-        QJsonArray arr = doc.array();
-        for (const QJsonValue& v : arr) {
-            if (!v.isObject()) continue;
-            QJsonObject o = v.toObject();
-            QString q = o.value("question").toString();
-            QString a = o.value("answer").toString();
-            QString c = o.value("category").toString("General");
-            if (!q.trimmed().isEmpty() && !a.trimmed().isEmpty()) {
-                addQA(q, a, c);
-            }
-        }
-    } else if (doc.isObject()) {
-        QJsonObject root = doc.object();
-        QJsonArray arr = root.value("items").toArray();
-        for (const QJsonValue& v : arr) {
-            if (!v.isObject()) continue;
-            QJsonObject o = v.toObject();
-            QString q = o.value("question").toString();
-            QString a = o.value("answer").toString();
-            QString c = o.value("category").toString("General");
-            if (!q.trimmed().isEmpty() && !a.trimmed().isEmpty()) {
-                addQA(q, a, c);
-            }
+    const QJsonArray arr = doc.isArray() ? doc.array() : doc.object().value("items").toArray();
+    out.reserve(out.size() + arr.size());
+    for (const QJsonValue& v : arr) {
+        if (!v.isObject()) continue;
+        QJsonObject o = v.toObject();
+        QString q = o.value("question").toString();
+        QString a = o.value("answer").toString();
+        QString c = o.value("category").toString("General");
+        if (!q.trimmed().isEmpty() && !a.trimmed().isEmpty()) {
+            out.append({q, a, c});
         }
     }
 }
 
-void OfflineQADatabase::addFromCsvFile(const QString& filePath)
+void OfflineQADatabase::readCsvFile(const QString& filePath, QVector<PendingQA>& out)
 {
+    TraceSpan span("OfflineQADatabase::readCsvFile");
     QFile file(filePath);
     if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) return;
     QTextStream in(&file);
@@ -91,148 +201,15 @@ void OfflineQADatabase::addFromCsvFile(const QString& filePath)
         QString q = parts.at(0).trimmed();
         QString a = parts.at(1).trimmed();
         QString c = parts.size() >= 3 ? parts.at(2).trimmed() : QString("General");
-        if (!q.isEmpty() && !a.isEmpty()) addQA(q, a, c);
+        if (!q.isEmpty() && !a.isEmpty()) out.append({q, a, c});
     }
     file.close();
 }
 
-void OfflineQADatabase::addGreetings()
+int OfflineQADatabase::questionCount() const
 {
-    // Basic greetings
-    addQA("hello", "Hello! How can I help you today? I'm your personal search assistant.", "Greetings");
-    addQA("hi", "Hi there! Welcome to your search app. What would you like to know?", "Greetings");
-    addQA("hey", "Hey! I'm here to help you find information. What's on your mind?", "Greetings");
-    addQA("good morning", "Good morning! I hope you're having a great start to your day. How can I assist you?", "Greetings");
-    addQA("good afternoon", "Good afternoon! I'm ready to help you with your search queries.", "Greetings");
-    addQA("good evening", "Good evening! I'm here to help you find what you're looking for.", "Greetings");
-    addQA("good night", "Good night! I hope you had a productive day. Feel free to ask if you need anything.", "Greetings");
-    addQA("morning", "Good morning! How can I help you today?", "Greetings");
-    addQA("afternoon", "Good afternoon! What would you like to search for?", "Greetings");
-    addQA("evening", "Good evening! I'm here to help you.", "Greetings");
-    addQA("night", "Good night! I hope you had a great day.", "Greetings");
-    
-    // Informal greetings
-    addQA("sup", "Sup! What's up with you? Need help finding something?", "Greetings");
-    addQA("what's up", "Not much, just here to help you search! What do you need?", "Greetings");
-    addQA("howdy", "Howdy! I'm your search partner. What can I help you find?", "Greetings");
-    addQA("yo", "Yo! Ready to help you search. What's the plan?", "Greetings");
-    
-    // Polite greetings
-    addQA("greetings", "Greetings! I'm honored to assist you today. What would you like to know?", "Greetings");
-    addQA("salutations", "Salutations! I'm here to help you find information. How may I assist?", "Greetings");
-    addQA("good day", "Good day to you! I'm ready to help with your search needs.", "Greetings");
-}
-
-void OfflineQADatabase::addCommonQuestions()
-{
-    // Personal questions
-    addQA("how are you", "I'm doing great, thank you for asking! I'm a search assistant, so I'm always ready to help you find information. How about you?", "Personal");
-    addQA("what's your name", "My name is Search Assistant! I'm here to help you find information quickly and efficiently.", "Personal");
-    addQA("who are you", "I'm your personal search assistant, designed to help you find information both offline and online. I can answer common questions instantly and search the web when needed.", "Personal");
-    addQA("what can you do", "I can do many things! I can answer common questions instantly, provide search suggestions, search multiple engines simultaneously, and even open results in your browser. I'm designed to be fast, responsive, and helpful.", "Personal");
-    
-    // Help requests
-    addQA("help", "I'm here to help! I can:\n• Answer common questions instantly\n• Search the web for you\n• Provide search suggestions\n• Open results in your browser\n\nJust type your question or search term and I'll assist you!", "Help");
-    addQA("help me", "I'd be happy to help you! What do you need assistance with? I can answer questions, search the web, or provide guidance on how to use this app.", "Help");
-    addQA("i need help", "No worries, I'm here to help! What can I assist you with today? Feel free to ask any question or search for any topic.", "Help");
-    addQA("can you help", "Absolutely! I'm designed to help you find information quickly and easily. What do you need help with?", "Help");
-    
-    // App usage
-    addQA("how to use", "Using this app is simple:\n\n1. Type your question or search term in the search box\n2. Press Enter or click the search button\n3. I'll show you instant answers if available\n4. If no instant answer, I'll search the web for you\n5. Click any result to open it in your browser\n\nTry asking me something!", "Usage");
-    addQA("how does this work", "This app works by combining offline knowledge with web search:\n\n• First, I check if I have an instant answer for your question\n• If not, I search multiple search engines simultaneously\n• I show you the best results with relevance scores\n• You can click any result to open it in your browser\n\nIt's designed to be fast and comprehensive!", "Usage");
-    addQA("what is this app", "This is a smart search application that combines:\n\n• Instant offline answers for common questions\n• Multi-engine web search capabilities\n• Intelligent result ranking and filtering\n• Beautiful, responsive user interface\n• Fast search suggestions\n\nIt's designed to give you the best of both worlds - instant answers when possible, and comprehensive web search when needed.", "Usage");
-}
-
-void OfflineQADatabase::addTechnicalQuestions()
-{
-    // Technology
-    addQA("what is ai", "AI (Artificial Intelligence) is technology that enables computers to perform tasks that typically require human intelligence, such as learning, reasoning, problem-solving, and understanding natural language.", "Technology");
-    addQA("what is machine learning", "Machine Learning is a subset of AI that allows computers to learn and improve from experience without being explicitly programmed. It uses algorithms to identify patterns in data.", "Technology");
-    addQA("what is programming", "Programming is the process of creating instructions for computers to follow. It involves writing code in programming languages to solve problems and create software applications.", "Technology");
-    addQA("what is coding", "Coding is the act of writing computer programs using programming languages. It's how we communicate with computers to make them perform specific tasks.", "Technology");
-    
-    // Internet and Web
-    addQA("what is the internet", "The Internet is a global network of connected computers that allows people to share information, communicate, and access resources from anywhere in the world.", "Technology");
-    addQA("what is a website", "A website is a collection of web pages hosted on the internet that can contain text, images, videos, and other content accessible through a web browser.", "Technology");
-    addQA("what is a browser", "A web browser is software that allows you to access and view websites on the internet. Examples include Chrome, Firefox, Safari, and Edge.", "Technology");
-    
-    // Software
-    addQA("what is software", "Software is a set of instructions and data that tell a computer how to perform specific tasks. It includes applications, operating systems, and utilities.", "Technology");
-    addQA("what is an app", "An app (application) is software designed to perform specific functions for users. Apps can run on computers, smartphones, tablets, and other devices.", "Technology");
-    addQA("what is an operating system", "An operating system (OS) is software that manages computer hardware and software resources, providing common services for computer programs.", "Technology");
-    // More technology Q&A
-    addQA("what is http", "HTTP (Hypertext Transfer Protocol) is an application protocol used for transmitting hypermedia documents, such as HTML.", "Technology");
-    addQA("what is https", "HTTPS is HTTP over TLS/SSL, providing encryption and authentication for secure communication over networks.", "Technology");
-    addQA("what is api", "An API (Application Programming Interface) is a set of rules that allow different software entities to communicate.", "Technology");
-    addQA("what is rest", "REST (Representational State Transfer) is an architectural style for designing networked applications using stateless requests.", "Technology");
-    addQA("what is graphql", "GraphQL is a query language for APIs that lets clients request exactly the data they need.", "Technology");
-    addQA("what is database", "A database is an organized collection of structured information, typically stored electronically.", "Technology");
-    addQA("what is sql", "SQL (Structured Query Language) is used to manage and query data in relational databases.", "Technology");
-    addQA("what is nosql", "NoSQL databases provide flexible schemas and scale horizontally, suitable for large distributed data.", "Technology");
-    addQA("what is cloud computing", "Cloud computing is the delivery of computing services over the internet on-demand and pay-as-you-go.", "Technology");
-    addQA("what is docker", "Docker is a platform to build, ship, and run applications inside lightweight containers.", "Technology");
-    addQA("what is kubernetes", "Kubernetes is an open-source system for automating deployment, scaling, and management of containerized applications.", "Technology");
-    addQA("what is version control", "Version control tracks changes to files over time so you can recall specific versions later.", "Technology");
-    addQA("what is git", "Git is a distributed version control system for tracking changes in source code.", "Technology");
-    addQA("what is github", "GitHub is a platform for hosting Git repositories with collaboration features like pull requests and issues.", "Technology");
-    addQA("what is python", "Python is a high-level, interpreted programming language known for readability and rich ecosystem.", "Programming");
-    addQA("what is javascript", "JavaScript is a versatile language primarily used to create interactive behavior on web pages.", "Programming");
-    addQA("what is c++", "C++ is a general-purpose programming language with object-oriented and generic programming features.", "Programming");
-    addQA("what is java", "Java is a class-based, object-oriented programming language designed to have as few implementation dependencies as possible.", "Programming");
-    addQA("what is html", "HTML (HyperText Markup Language) structures content on the web.", "Web");
-    addQA("what is css", "CSS (Cascading Style Sheets) describes the presentation of HTML documents.", "Web");
-}
-
-void OfflineQADatabase::addGeneralKnowledge()
-{
-    // Science
-    addQA("what is gravity", "Gravity is a fundamental force that attracts objects toward each other. On Earth, it pulls everything toward the center of the planet, which is why objects fall when dropped.", "Science");
-    addQA("what is photosynthesis", "Photosynthesis is the process by which plants convert sunlight, carbon dioxide, and water into glucose and oxygen. It's how plants make their own food.", "Science");
-    addQA("what is dna", "DNA (Deoxyribonucleic acid) is a molecule that carries genetic information and instructions for the development and functioning of living organisms.", "Science");
-    
-    // Geography
-    addQA("what is the capital of france", "The capital of France is Paris, known as the 'City of Light' and famous for its culture, art, fashion, and landmarks like the Eiffel Tower.", "Geography");
-    addQA("what is the largest ocean", "The Pacific Ocean is the largest ocean on Earth, covering about 46% of the Earth's water surface and about one-third of its total surface area.", "Geography");
-    addQA("what is the highest mountain", "Mount Everest is the highest mountain above sea level, with a peak elevation of 29,029 feet (8,848 meters) above sea level.", "Geography");
-    
-    // History
-    addQA("who invented the telephone", "Alexander Graham Bell is credited with inventing the first practical telephone in 1876, though there were earlier developments by other inventors.", "History");
-    addQA("when was world war 2", "World War II lasted from 1939 to 1945, involving most of the world's nations and resulting in significant global changes.", "History");
-    addQA("who was albert einstein", "Albert Einstein was a German-born theoretical physicist who developed the theory of relativity, one of the two pillars of modern physics. He won the Nobel Prize in Physics in 1921.", "History");
-    
-    // Math
-    addQA("what is pi", "Pi (π) is a mathematical constant representing the ratio of a circle's circumference to its diameter. Its approximate value is 3.14159, though it's an irrational number with infinite decimal places.", "Math");
-    addQA("what is the square root", "The square root of a number is a value that, when multiplied by itself, gives the original number. For example, the square root of 16 is 4, because 4 × 4 = 16.", "Math");
-    addQA("what is multiplication", "Multiplication is a mathematical operation that combines groups of equal size. It's essentially repeated addition. For example, 3 × 4 means adding 3 four times: 3 + 3 + 3 + 3 = 12.", "Math");
-    
-    // Language
-    addQA("what is a noun", "A noun is a word that names a person, place, thing, or idea. Examples include: person (John), place (Paris), thing (book), idea (freedom).", "Language");
-    addQA("what is a verb", "A verb is a word that expresses an action, occurrence, or state of being. Examples include: run, jump, think, be, have.", "Language");
-    addQA("what is an adjective", "An adjective is a word that describes or modifies a noun or pronoun. Examples include: big, red, happy, beautiful, intelligent.", "Language");
-    
-    // Health
-    addQA("what is exercise", "Exercise is physical activity that improves health, fitness, and overall well-being. It includes activities like walking, running, swimming, and strength training.", "Health");
-    addQA("what is nutrition", "Nutrition is the science of how food affects the body. It involves understanding the nutrients in food and how they contribute to health and disease prevention.", "Health");
-    addQA("what is sleep", "Sleep is a natural state of rest for the mind and body, essential for physical and mental health, memory consolidation, and overall well-being.", "Health");
-    
-    // Entertainment
-    addQA("what is music", "Music is an art form that uses sound and silence organized in time. It can include melody, harmony, rhythm, and timbre to create expressive and meaningful compositions.", "Entertainment");
-    addQA("what is a movie", "A movie (or film) is a series of moving images shown on a screen, typically with accompanying sound, that tells a story or presents information.", "Entertainment");
-    addQA("what is art", "Art is the expression or application of human creative skill and imagination, typically in visual form such as painting, sculpture, or other creative works.", "Entertainment");
-    
-    // Business
-    addQA("what is entrepreneurship", "Entrepreneurship is the process of starting and running a business, taking on financial risks in the hope of profit. Entrepreneurs identify opportunities and create value.", "Business");
-    addQA("what is marketing", "Marketing is the process of promoting, selling, and distributing products or services. It involves understanding customer needs and creating strategies to meet them.", "Business");
-    addQA("what is innovation", "Innovation is the process of creating new ideas, methods, or products that provide value. It often involves improving existing solutions or creating entirely new ones.", "Business");
-    
-    // Geography - more capitals
-    addQA("what is the capital of japan", "Tokyo is the capital of Japan, a bustling metropolis known for its technology and culture.", "Geography");
-    addQA("what is the capital of india", "New Delhi is the capital of India, serving as the seat of all three branches of the Government of India.", "Geography");
-    addQA("what is the capital of canada", "Ottawa is the capital of Canada, located in the province of Ontario.", "Geography");
-    
-    // Math - more
-    addQA("what is algebra", "Algebra is a branch of mathematics dealing with symbols and the rules for manipulating those symbols.", "Math");
-    addQA("what is calculus", "Calculus is the mathematical study of continuous change, dealing with derivatives and integrals.", "Math");
+    QReadLocker locker(&m_lock);
+    return BuiltinCorpus::count() + m_allQuestions.size();
 }
 
 void OfflineQADatabase::addQA(const QString& question, const QString& answer, const QString& category)
@@ -245,6 +222,7 @@ void OfflineQADatabase::addQA(const QString& question, const QString& answer, co
     result.sourceEngine = "Offline Database";
     result.relevanceScore = 1.0;
     result.timestamp = QDateTime::currentDateTime();
+    result.snippetLength = SearchResult::snippetBoundary(answer);
     
     // Store with multiple variations of the question
     QString cleanQuestion = question.toLower().trimmed();
@@ -265,13 +243,22 @@ void OfflineQADatabase::addQA(const QString& question, const QString& answer, co
 bool OfflineQADatabase::hasOfflineAnswer(const QString& query) const
 {
     QString cleanQuery = query.toLower().trimmed();
+    if (BuiltinCorpus::find(cleanQuery) >= 0) {
+        return true;
+    }
     
+    QReadLocker locker(&m_lock);
     // Direct match
     if (m_qaDatabase.contains(cleanQuery)) {
         return true;
     }
     
     // Partial match
+    for (int i = 0; i < BuiltinCorpus::count(); ++i) {
+        if (matchScore(BuiltinCorpus::question(i), cleanQuery) > 0.0) {
+            return true;
+        }
+    }
     for (const QString& question : m_allQuestions) {
         if (question.toLower().contains(cleanQuery) || cleanQuery.contains(question.toLower())) {
             return true;
@@ -283,58 +270,115 @@ bool OfflineQADatabase::hasOfflineAnswer(const QString& query) const
 
 SearchResult OfflineQADatabase::getOfflineAnswer(const QString& query) const
 {
+    QReadLocker locker(&m_lock);
     QString cleanQuery = query.toLower().trimmed();
     
-    // Direct match
+    // Direct match; data packs may override a built-in answer
     if (m_qaDatabase.contains(cleanQuery)) {
         return m_qaDatabase[cleanQuery];
     }
+    const int builtin = BuiltinCorpus::find(cleanQuery);
+    if (builtin >= 0) {
+        return BuiltinCorpus::result(builtin);
+    }
     
     // Partial match - find the best match
     SearchResult bestMatch;
     double bestScore = 0.0;
+    int bestBuiltin = -1;
+    
+    for (int i = 0; i < BuiltinCorpus::count(); ++i) {
+        const double score = matchScore(BuiltinCorpus::question(i), cleanQuery);
+        if (score > bestScore) {
+            bestScore = score;
+            bestBuiltin = i;
+        }
+    }
     
     for (const QString& question : m_allQuestions) {
-        QString lowerQuestion = question.toLower();
-        
-        // Check if query contains question or question contains query
-        if (lowerQuestion.contains(cleanQuery) || cleanQuery.contains(lowerQuestion)) {
-            double score = 0.0;
-            
-            // Exact match gets highest score
-            if (lowerQuestion == cleanQuery) {
-                score = 1.0;
-            }
-            // Query contains question
-            else if (lowerQuestion.contains(cleanQuery)) {
-                score = 0.8;
-            }
-            // Question contains query
-            else if (cleanQuery.contains(lowerQuestion)) {
-                score = 0.6;
-            }
-            
-            if (score > bestScore) {
-                bestScore = score;
-                bestMatch = m_qaDatabase[question.toLower()];
-            }
+        const double score = matchScore(question, cleanQuery);
+        if (score > bestScore) {
+            bestScore = score;
+            bestBuiltin = -1;
+            bestMatch = m_qaDatabase[question.toLower()];
         }
     }
     
-    return bestMatch;
+    return bestBuiltin >= 0 ? BuiltinCorpus::result(bestBuiltin) : bestMatch;
 }
 
 QVector<SearchResult> OfflineQADatabase::getAllOfflineAnswers() const
 {
+    QReadLocker locker(&m_lock);
     QVector<SearchResult> results;
+    results.reserve(BuiltinCorpus::count() + m_qaDatabase.size());
+    for (int i = 0; i < BuiltinCorpus::count(); ++i) {
+        results.append(BuiltinCorpus::result(i));
+    }
     for (const SearchResult& result : m_qaDatabase.values()) {
         results.append(result);
     }
     return results;
 }
 
+QVector<SearchResult> OfflineQADatabase::snapshotEntries() const
+{
+    QReadLocker locker(&m_lock);
+    QVector<SearchResult> entries;
+    entries.reserve(BuiltinCorpus::count() + m_allQuestions.size());
+    const int builtinCount = BuiltinCorpus::count();
+    for (int i = 0; i < builtinCount; ++i) {
+        if (m_shardCount > 1 && shardOf(BuiltinCorpus::question(i), m_shardCount) != m_shardIndex) continue;
+        SearchResult result = builtinResult(i);
+        result.entryId = i;
+        entries.append(result);
+    }
+    // One entry per distinct question: a pack question that overrides a
+    // built-in (already emitted above with the pack's answer) or repeats an
+    // earlier pack question would otherwise tie with it on the exact hit
+    QSet<QString> emitted;
+    for (int i = 0; i < m_allQuestions.size(); ++i) {
+        const QString key = m_allQuestions.at(i).toLower().trimmed();
+        if (BuiltinCorpus::find(key) >= 0 || emitted.contains(key)) continue;
+        auto it = m_qaDatabase.constFind(key);
+        if (it == m_qaDatabase.constEnd()) continue;
+        emitted.insert(key);
+        SearchResult result = it.value();
+        result.entryId = builtinCount + i;
+        entries.append(result);
+    }
+    return entries;
+}
+
+SearchResult OfflineQADatabase::builtinResult(int index) const
+{
+    // Same precedence as getOfflineAnswer: data packs may override a built-in answer
+    if (!m_qaDatabase.isEmpty()) {
+        auto it = m_qaDatabase.constFind(QString(BuiltinCorpus::question(index)));
+        if (it != m_qaDatabase.constEnd()) return it.value();
+    }
+    return BuiltinCorpus::result(index);
+}
+
+SearchResult OfflineQADatabase::entryAt(int index) const
+{
+    QReadLocker locker(&m_lock);
+    const int builtinCount = BuiltinCorpus::count();
+    SearchResult result;
+    if (index >= 0 && index < builtinCount) {
+        result = builtinResult(index);
+    } else if (index >= builtinCount && index - builtinCount < m_allQuestions.size()) {
+        result = m_qaDatabase.value(m_allQuestions.at(index - builtinCount).toLower().trimmed());
+    } else {
+        return result;
+    }
+    result.entryId = index;
+    return result;
+}
+
 QStringList OfflineQADatabase::getSuggestions(const QString& partialQuery) const
 {
+    QReadLocker locker(&m_lock);
     QStringList suggestions;
     QString lowerQuery = partialQuery.toLower().trimmed();
     
@@ -342,14 +386,91 @@ QStringList OfflineQADatabase::getSuggestions(const QString& partialQuery) const
         return suggestions;
     }
     
+    for (int i = 0; i < BuiltinCorpus::count() && suggestions.size() < 10; ++i) {
+        if (BuiltinCorpus::question(i).contains(lowerQuery)) {
+            suggestions.append(BuiltinCorpus::question(i));
+        }
+    }
     for (const QString& question : m_allQuestions) {
+        if (suggestions.size() >= 10) { // Limit suggestions
+            break;
+        }
         if (question.toLower().contains(lowerQuery)) {
             suggestions.append(question);
-            if (suggestions.size() >= 10) { // Limit suggestions
-                break;
-            }
         }
     }
     
     return suggestions;
 }
+
+QVector<QPair<QString, double>> OfflineQADatabase::getScoredSuggestions(const QString& partialQuery, int limit) const
+{
+    QReadLocker locker(&m_lock);
+    QVector<QPair<QString, double>> suggestions;
+    const QString lowerQuery = partialQuery.toLower().trimmed();
+
+    if (lowerQuery.isEmpty() || limit <= 0) {
+        return suggestions;
+    }
+
+    // Prefix beats word-start beats plain substring
+    auto score = [](int pos, QChar before) {
+        if (pos == 0) return 1.0;
+        return before.isSpace() ? 0.8 : 0.6;
+    };
+
+    for (int i = 0; i < BuiltinCorpus::count(); ++i) {
+        const QLatin1String question = BuiltinCorpus::question(i);
+        const int pos = int(question.indexOf(lowerQuery, 0, Qt::CaseInsensitive));
+        if (pos < 0) continue;
+        suggestions.append({question, score(pos, pos > 0 ? QChar(question.at(pos - 1)) : QChar())});
+    }
+    for (const QString& question : m_allQuestions) {
+        const int pos = question.indexOf(lowerQuery, 0, Qt::CaseInsensitive);
+        if (pos < 0) continue;
+        suggestions.append({question, score(pos, pos > 0 ? question.at(pos - 1) : QChar())});
+    }
+
+    std::stable_sort(suggestions.begin(), suggestions.end(),
+                     [](const QPair<QString, double>& a, const QPair<QString, double>& b) {
+                         return a.second > b.second;
+                     });
+    if (suggestions.size() > limit) {
+        suggestions.resize(limit);
+    }
+    return suggestions;
+}
+
+void OfflineQADatabase::collectMatches(const QString& query, int begin, int end, QVector<SearchResult>& out) const
+{
+    QReadLocker locker(&m_lock);
+    const QString cleanQuery = query.toLower().trimmed();
+    if (cleanQuery.isEmpty()) return;
+
+    // Question indices: built-ins first, then the loaded data packs
+    const int builtinCount = BuiltinCorpus::count();
+    begin = qMax(0, begin);
+    end = qMin(end, builtinCount + int(m_allQuestions.size()));
+    for (int i = begin; i < end; ++i) {
+        if (i < builtinCount) {
+            const double score = matchScore(BuiltinCorpus::question(i), cleanQuery);
+            if (score <= 0.0) continue;
+            SearchResult result = builtinResult(i);
+            result.relevanceScore = score;
+            result.entryId = i;
+            out.append(result);
+            continue;
+        }
+
+        const QString& question = m_allQuestions.at(i - builtinCount);
+        const double score = matchScore(question, cleanQuery);
+        if (score <= 0.0) continue;
+
+        auto it = m_qaDatabase.constFind(question.toLower().trimmed());
+        if (it == m_qaDatabase.constEnd()) continue;
+        SearchResult result = it.value();
+        result.relevanceScore = score;
+        result.entryId = i;
+        out.append(result);
+    }
+}
@@ -0,0 +1,113 @@
+#include "ProfilerOverlay.h"
+#include "UiProfiler.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QFileDialog>
+#include <QFontDatabase>
+#include <QEvent>
+
+ProfilerOverlay::ProfilerOverlay(QWidget *parent)
+    : QFrame(parent)
+{
+    setFrameShape(QFrame::StyledPanel);
+    setAutoFillBackground(true);
+    setBackgroundRole(QPalette::ToolTipBase);
+    setForegroundRole(QPalette::ToolTipText);
+    setAttribute(Qt::WA_StyledBackground);
+
+    m_statsLabel = new QLabel(this);
+    m_statsLabel->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    m_statsLabel->setForegroundRole(QPalette::ToolTipText);
+    m_statsLabel->setTextFormat(Qt::PlainText);
+
+    m_exportButton = new QPushButton("Export…", this);
+    m_resetButton = new QPushButton("Reset", this);
+    connect(m_exportButton, &QPushButton::clicked, this, &ProfilerOverlay::exportHistograms);
+    connect(m_resetButton, &QPushButton::clicked, this, [this]() {
+        UiProfiler::instance()->reset();
+        refresh();
+    });
+
+    QHBoxLayout* buttons = new QHBoxLayout;
+    buttons->addWidget(m_exportButton);
+    buttons->addWidget(m_resetButton);
+
+    QVBoxLayout* layout = new QVBoxLayout(this);
+    layout->setContentsMargins(10, 8, 10, 8);
+    layout->addWidget(m_statsLabel);
+    layout->addLayout(buttons);
+
+    // Twice a second is plenty and keeps the overlay's own paints negligible
+    m_refreshTimer = new QTimer(this);
+    m_refreshTimer->setInterval(500);
+    connect(m_refreshTimer, &QTimer::timeout, this, &ProfilerOverlay::refresh);
+
+    parent->installEventFilter(this);
+    hide();
+}
+
+void ProfilerOverlay::setActive(bool active) {
+    UiProfiler::instance()->setEnabled(active);
+    if (active) {
+        refresh();
+        reposition();
+        show();
+        raise();
+        m_refreshTimer->start();
+    } else {
+        m_refreshTimer->stop();
+        hide();
+    }
+}
+
+bool ProfilerOverlay::eventFilter(QObject* watched, QEvent* event) {
+    if (watched == parent() && event->type() == QEvent::Resize && isVisible()) {
+        reposition();
+    }
+    return QFrame::eventFilter(watched, event);
+}
+
+void ProfilerOverlay::reposition() {
+    adjustSize();
+    QWidget* host = parentWidget();
+    move(host->width() - width() - 12, 12);
+}
+
+void ProfilerOverlay::refresh() {
+    const UiProfiler* profiler = UiProfiler::instance();
+    auto line = [](const char* label, const Metrics::Histogram& h) {
+        return QString("%1 n=%2 p50=%3 p95=%4 max=%5 ms")
+            .arg(QString::fromLatin1(label), -13)
+            .arg(h.count(), 5)
+            .arg(h.percentileNs(50) / 1e6, 6, 'f', 2)
+            .arg(h.percentileNs(95) / 1e6, 6, 'f', 2)
+            .arg(h.maxNs() / 1e6, 6, 'f', 2);
+    };
+
+    QStringList lines;
+    lines << line("frame time", profiler->frameTimes());
+    lines << line("frame gap", profiler->frameIntervals());
+    lines << line("key→paint", profiler->inputLatency());
+    lines << QString();
+    lines << "paint cost (exclusive, total ms):";
+
+    const QVector<const UiProfiler::WidgetCost*> costs = profiler->widgetCostsByTotal();
+    for (int i = 0; i < qMin(8, int(costs.size())); ++i) {
+        const UiProfiler::WidgetCost* cost = costs.at(i);
+        lines << QString("  %1 %2 (n=%3, p95=%4)")
+            .arg(cost->name.left(34), -34)
+            .arg(cost->histogram.totalNs() / 1e6, 8, 'f', 2)
+            .arg(cost->histogram.count())
+            .arg(cost->histogram.percentileNs(95) / 1e6, 0, 'f', 2);
+    }
+
+    m_statsLabel->setText(lines.join('\n'));
+    reposition();
+}
+
+void ProfilerOverlay::exportHistograms() {
+    const QString filePath = QFileDialog::getSaveFileName(
+        this, "Export UI profile", "ui-profile.json", "JSON (*.json);;CSV (*.csv)");
+    if (filePath.isEmpty()) return;
+    UiProfiler::instance()->exportToFile(filePath);
+}
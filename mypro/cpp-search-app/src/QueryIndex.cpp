@@ -0,0 +1,287 @@
+#include "QueryIndex.h"
+#include "Metrics.h"
+#include "OfflineQADatabase.h"
+#include "Tracer.h"
+#include <QElapsedTimer>
+#include <algorithm>
+#include <climits>
+
+namespace {
+constexpr int kGram = 3;
+
+quint64 trigramKey(QStringView text, int pos) {
+    return (quint64(text.at(pos).unicode()) << 32)
+         | (quint64(text.at(pos + 1).unicode()) << 16)
+         | quint64(text.at(pos + 2).unicode());
+}
+
+struct PostingRange {
+    const int* begin;
+    const int* end;
+};
+
+// Per-thread buffers for search(); cleared, never shrunk, so a warm lookup
+// does not allocate however long the query
+struct Scratch {
+    QVector<quint64> keys;
+    QVector<PostingRange> lists;
+    QVector<int> entries;
+};
+
+Scratch& scratch() {
+    thread_local Scratch buffers;
+    return buffers;
+}
+
+// Distinct trigrams of text, sorted
+void trigramsOf(QStringView text, QVector<quint64>& keys) {
+    keys.clear();
+    for (int pos = 0; pos + kGram <= text.size(); ++pos) {
+        keys.append(trigramKey(text, pos));
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+}
+}
+
+void QueryIndex::build(const OfflineQADatabase& database) {
+    build(database.snapshotEntries());
+}
+
+void QueryIndex::build(QVector<SearchResult> entries) {
+    static Metrics::Histogram& buildTime = Metrics::instance()->histogram(
+        "index_build_seconds", "Time to build the trigram query index");
+    Metrics::ScopedTimer timer(buildTime);
+    TraceSpan span("QueryIndex::build");
+    // Display order: same tie-break as SearchResult::operator< for equal scores
+    std::stable_sort(entries.begin(), entries.end(), [](const SearchResult& a, const SearchResult& b) {
+        if (a.title.size() != b.title.size()) return a.title.size() < b.title.size();
+        return a.title < b.title;
+    });
+    m_entries = std::move(entries);
+
+    m_lowered.clear();
+    m_lowered.reserve(m_entries.size());
+    m_exact.clear();
+    m_exact.reserve(m_entries.size());
+    m_minLength = m_entries.isEmpty() ? 0 : INT_MAX;
+    m_maxLength = 0;
+    for (int i = 0; i < m_entries.size(); ++i) {
+        const QString lowered = m_entries.at(i).title.toLower();
+        m_lowered.append(lowered);
+        m_exact.insert(qHash(QStringView(lowered)), i);
+        m_minLength = qMin(m_minLength, int(lowered.size()));
+        m_maxLength = qMax(m_maxLength, int(lowered.size()));
+    }
+    buildTrigrams();
+}
+
+void QueryIndex::buildTrigrams() {
+    m_trigramIds.clear();
+    QVector<int> counts;
+    QVector<quint64> keys;
+
+    // Pass 1: number the trigrams and size their lists
+    for (const QString& question : m_lowered) {
+        trigramsOf(question, keys);
+        for (quint64 key : keys) {
+            auto it = m_trigramIds.find(key);
+            if (it == m_trigramIds.end()) {
+                it = m_trigramIds.insert(key, int(counts.size()));
+                counts.append(0);
+            }
+            ++counts[it.value()];
+        }
+    }
+
+    m_offsets.resize(counts.size() + 1);
+    m_offsets[0] = 0;
+    for (int t = 0; t < counts.size(); ++t) {
+        m_offsets[t + 1] = m_offsets[t] + counts[t];
+    }
+
+    // Pass 2: fill; entries are visited in order, so every list comes out sorted
+    m_postings.resize(m_offsets.last());
+    QVector<int> cursor(m_offsets.begin(), m_offsets.end() - 1);
+    for (int i = 0; i < m_lowered.size(); ++i) {
+        trigramsOf(m_lowered.at(i), keys);
+        for (quint64 key : keys) {
+            m_postings[cursor[m_trigramIds.value(key)]++] = i;
+        }
+    }
+}
+
+void QueryIndex::normalize(QStringView query, QString& out) {
+    query = query.trimmed();
+    out.resize(query.size());
+    QChar* lowered = out.data();
+    for (qsizetype i = 0; i < query.size(); ++i) {
+        const char16_t c = query.at(i).unicode();
+        if (c < 0x80) {
+            lowered[i] = QChar(c >= u'A' && c <= u'Z' ? char16_t(c + 32) : c);
+        } else if (QChar::isSurrogate(c) || c == 0x130) {
+            out = query.toString().toLower();
+            return;
+        } else {
+            lowered[i] = QChar(char16_t(QChar::toLower(char32_t(c))));
+        }
+    }
+}
+
+QVector<QueryIndex::Hit> QueryIndex::search(QStringView query, int limit, SearchExplain* explain) const {
+    QVector<Hit> hits;
+    search(query, limit, hits, explain);
+    return hits;
+}
+
+void QueryIndex::search(QStringView query, int limit, QVector<Hit>& hits, SearchExplain* explain) const {
+    static Metrics::Histogram& lookupTime = Metrics::instance()->histogram(
+        "index_lookup_seconds", "Time of one query index lookup");
+    Metrics::ScopedTimer timer(lookupTime);
+    QElapsedTimer total;
+    if (explain) {
+        explain->normalized = query.toString();
+        total.start();
+    }
+    hits.clear();
+    if (query.isEmpty() || limit <= 0) {
+        if (explain) explain->skip("exact-hash", "empty query or no limit");
+        return;
+    }
+
+    int exact = -1;
+    {
+        SearchExplain::StageTimer stage(explain, "exact-hash");
+        const int probed = findExact(query, &exact);
+        if (exact >= 0) {
+            hits.append({exact, 1.0});
+        }
+        stage.setCounts(probed, int(hits.size()));
+    }
+    // Too short for trigrams; short queries match early in a scan anyway
+    const char* containing = query.size() < kGram ? "substring-scan" : "trigram-index";
+    if (hits.size() < limit) {
+        SearchExplain::StageTimer stage(explain, containing);
+        const int before = int(hits.size());
+        const int examined = collectContaining(query, exact, limit - before, hits, stage);
+        stage.setCounts(examined, int(hits.size()) - before);
+    } else if (explain) {
+        explain->skip(containing, "limit reached");
+    }
+    if (hits.size() < limit) {
+        SearchExplain::StageTimer stage(explain, "contained-probe");
+        const int before = int(hits.size());
+        const int probed = collectContained(query, limit - before, hits);
+        stage.setCounts(probed, int(hits.size()) - before);
+        if (stage.isActive()) {
+            stage.setDetail(QString("query substrings of length %1-%2 looked up in the exact hash")
+                                .arg(qMax(1, m_minLength)).arg(qMin(int(query.size()) - 1, m_maxLength)));
+        }
+    } else if (explain) {
+        explain->skip("contained-probe", "limit reached");
+    }
+
+    if (explain) {
+        for (const Hit& hit : hits) {
+            const char* stage = hit.score >= 1.0 ? "exact-hash" : hit.score >= 0.8 ? containing : "contained-probe";
+            explain->addResult(hit.entry, m_entries.at(hit.entry).title, QString::fromLatin1(stage), hit.score);
+        }
+        explain->totalNs = total.nsecsElapsed();
+    }
+}
+
+int QueryIndex::findExact(QStringView query, int* exact) const {
+    int probed = 0;
+    *exact = -1;
+    for (auto it = m_exact.constFind(qHash(query)); it != m_exact.constEnd() && it.key() == qHash(query); ++it) {
+        ++probed;
+        if (m_lowered.at(it.value()) == query) {
+            *exact = it.value();
+            break;
+        }
+    }
+    return probed;
+}
+
+int QueryIndex::collectContaining(QStringView query, int exact, int wanted, QVector<Hit>& hits,
+                                  SearchExplain::StageTimer& stage) const {
+    int found = 0;
+    int examined = 0;
+    auto accept = [&](int entry) {
+        if (entry == exact || !QStringView(m_lowered.at(entry)).contains(query)) return false;
+        hits.append({entry, 0.8});
+        return ++found >= wanted;
+    };
+
+    if (query.size() < kGram) {
+        for (int entry = 0; entry < m_lowered.size(); ++entry) {
+            ++examined;
+            if (accept(entry)) break;
+        }
+        return examined;
+    }
+
+    QVector<quint64>& keys = scratch().keys;
+    trigramsOf(query, keys);
+    QVector<PostingRange>& lists = scratch().lists;
+    lists.clear();
+    for (quint64 key : keys) {
+        const auto id = m_trigramIds.constFind(key);
+        if (id == m_trigramIds.constEnd()) {
+            // Some trigram occurs nowhere
+            if (stage.isActive()) stage.setDetail(QString("%1 trigrams, one in no question").arg(keys.size()));
+            return 0;
+        }
+        lists.append({m_postings.constData() + m_offsets[id.value()],
+                      m_postings.constData() + m_offsets[id.value() + 1]});
+    }
+    std::sort(lists.begin(), lists.end(), [](const PostingRange& a, const PostingRange& b) {
+        return (a.end - a.begin) < (b.end - b.begin);
+    });
+    if (stage.isActive()) {
+        stage.setDetail(QString("%1 trigrams, rarest posting list %2 entries")
+                            .arg(keys.size()).arg(lists[0].end - lists[0].begin));
+    }
+
+    // Walk the rarest list; the next two filter candidates before the
+    // substring check, which settles the rest
+    const int filters = qMin(int(lists.size()), 3);
+    for (const int* candidate = lists[0].begin; candidate != lists[0].end; ++candidate) {
+        ++examined;
+        bool inAll = true;
+        for (int f = 1; f < filters; ++f) {
+            lists[f].begin = std::lower_bound(lists[f].begin, lists[f].end, *candidate);
+            if (lists[f].begin == lists[f].end) return examined;
+            if (*lists[f].begin != *candidate) {
+                inAll = false;
+                break;
+            }
+        }
+        if (inAll && accept(*candidate)) break;
+    }
+    return examined;
+}
+
+int QueryIndex::collectContained(QStringView query, int wanted, QVector<Hit>& hits) const {
+    // Proper substrings only; the whole query is the exact match
+    int probed = 0;
+    QVector<int>& entries = scratch().entries;
+    entries.clear();
+    const int longest = qMin(int(query.size()) - 1, m_maxLength);
+    for (int length = qMax(1, m_minLength); length <= longest; ++length) {
+        for (int start = 0; start + length <= query.size(); ++start) {
+            const QStringView part = query.mid(start, length);
+            ++probed;
+            const size_t hash = qHash(part);
+            for (auto it = m_exact.constFind(hash); it != m_exact.constEnd() && it.key() == hash; ++it) {
+                if (m_lowered.at(it.value()) == part) entries.append(it.value());
+            }
+        }
+    }
+    std::sort(entries.begin(), entries.end());
+    entries.erase(std::unique(entries.begin(), entries.end()), entries.end());
+    for (int i = 0; i < entries.size() && i < wanted; ++i) {
+        hits.append({entries[i], 0.6});
+    }
+    return probed;
+}
@@ -0,0 +1,365 @@
+#include "QueryServer.h"
+#include "AnswerStore.h"
+#include "QueryIndex.h"
+#include "ServeProtocol.h"
+#include <QFile>
+#include <QStringDecoder>
+#include <cstring>
+
+#ifdef Q_OS_LINUX
+#include <cerrno>
+#include <climits>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+// Stop reading from a client that keeps sending without collecting responses
+constexpr qsizetype kMaxBufferedInput = 4 * 1024 * 1024;
+constexpr int kReadChunk = 64 * 1024;
+}
+
+struct QueryServer::Connection {
+    int fd = -1;
+    QByteArray input;         // bytes not yet parsed into requests
+    QByteArray headers;       // response and hit headers of the pending output
+    QVector<struct iovec> output;
+    int outputIndex = 0;      // first iovec not fully written
+    bool wantsWrite = false;
+    bool peerClosed = false;  // answer what was sent, then close
+};
+
+QueryServer::QueryServer(const QueryIndex& index, const AnswerStore& store)
+    : m_index(index)
+    , m_store(store)
+{
+}
+
+#ifdef Q_OS_LINUX
+
+QueryServer::~QueryServer() {
+    for (Connection* connection : m_connections) {
+        ::close(connection->fd);
+        delete connection;
+    }
+    if (m_listenFd >= 0) {
+        ::close(m_listenFd);
+        QFile::remove(m_socketPath);
+    }
+    if (m_wakeFd >= 0) ::close(m_wakeFd);
+    if (m_epollFd >= 0) ::close(m_epollFd);
+}
+
+bool QueryServer::listen(const QString& socketPath) {
+    const QByteArray path = QFile::encodeName(socketPath);
+    sockaddr_un address{};
+    if (path.isEmpty() || size_t(path.size()) >= sizeof(address.sun_path)) {
+        m_error = QString("socket path is empty or too long: %1").arg(socketPath);
+        return false;
+    }
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, path.constData(), size_t(path.size()));
+
+    m_listenFd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (m_listenFd < 0) {
+        m_error = QString("socket: %1").arg(QString::fromLocal8Bit(std::strerror(errno)));
+        return false;
+    }
+
+    if (::bind(m_listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        if (errno != EADDRINUSE) {
+            m_error = QString("bind %1: %2").arg(socketPath, QString::fromLocal8Bit(std::strerror(errno)));
+            return false;
+        }
+        // A socket file nobody accepts on is left over from a crashed daemon
+        const int probe = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        const bool alive = probe >= 0 && ::connect(probe, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+        if (probe >= 0) ::close(probe);
+        if (alive) {
+            m_error = QString("another daemon is serving %1").arg(socketPath);
+            return false;
+        }
+        ::unlink(path.constData());
+        if (::bind(m_listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+            m_error = QString("bind %1: %2").arg(socketPath, QString::fromLocal8Bit(std::strerror(errno)));
+            return false;
+        }
+    }
+    if (::listen(m_listenFd, SOMAXCONN) < 0) {
+        m_error = QString("listen: %1").arg(QString::fromLocal8Bit(std::strerror(errno)));
+        return false;
+    }
+    m_socketPath = socketPath;
+
+    m_epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+    m_wakeFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (m_epollFd < 0 || m_wakeFd < 0) {
+        m_error = QString("epoll: %1").arg(QString::fromLocal8Bit(std::strerror(errno)));
+        return false;
+    }
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = m_listenFd;
+    ::epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_listenFd, &event);
+    event.data.fd = m_wakeFd;
+    ::epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_wakeFd, &event);
+    return true;
+}
+
+void QueryServer::stop() {
+    if (m_wakeFd < 0) return;
+    const quint64 one = 1;
+    [[maybe_unused]] const ssize_t written = ::write(m_wakeFd, &one, sizeof(one));
+}
+
+bool QueryServer::run() {
+    if (m_epollFd < 0) {
+        m_error = "not listening";
+        return false;
+    }
+    epoll_event events[64];
+    for (;;) {
+        const int ready = ::epoll_wait(m_epollFd, events, 64, -1);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            m_error = QString("epoll_wait: %1").arg(QString::fromLocal8Bit(std::strerror(errno)));
+            return false;
+        }
+        for (int i = 0; i < ready; ++i) {
+            const int fd = events[i].data.fd;
+            if (fd == m_wakeFd) return true;
+            if (fd == m_listenFd) {
+                acceptConnections();
+                continue;
+            }
+            Connection* connection = m_connections.value(fd);
+            if (!connection) continue;
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                closeConnection(connection);
+                continue;
+            }
+            // Finish the previous responses before answering anything new,
+            // so output stays in request order
+            if ((events[i].events & EPOLLOUT) && !flush(connection)) {
+                closeConnection(connection);
+                continue;
+            }
+            if ((events[i].events & EPOLLIN) && !readRequests(connection)) {
+                closeConnection(connection);
+                continue;
+            }
+            answerRequests(connection);
+            if (!flush(connection) || (connection->peerClosed && !connection->wantsWrite)) {
+                closeConnection(connection);
+                continue;
+            }
+            updateInterest(connection);
+        }
+    }
+}
+
+void QueryServer::acceptConnections() {
+    for (;;) {
+        const int fd = ::accept4(m_listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return; // EAGAIN, or a client that already went away
+        Connection* connection = new Connection;
+        connection->fd = fd;
+        m_connections.insert(fd, connection);
+
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        ::epoll_ctl(m_epollFd, EPOLL_CTL_ADD, fd, &event);
+    }
+}
+
+void QueryServer::closeConnection(Connection* connection) {
+    ::epoll_ctl(m_epollFd, EPOLL_CTL_DEL, connection->fd, nullptr);
+    ::close(connection->fd);
+    m_connections.remove(connection->fd);
+    delete connection;
+}
+
+bool QueryServer::readRequests(Connection* connection) {
+    while (!connection->peerClosed && connection->input.size() < kMaxBufferedInput) {
+        const qsizetype used = connection->input.size();
+        connection->input.resize(used + kReadChunk);
+        const ssize_t received = ::read(connection->fd, connection->input.data() + used, kReadChunk);
+        connection->input.resize(used + qMax<ssize_t>(received, 0));
+        if (received == 0) {
+            connection->peerClosed = true;
+            return true;
+        }
+        if (received < 0) return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        if (received < kReadChunk) return true;
+    }
+    return true;
+}
+
+void QueryServer::answerRequests(Connection* connection) {
+    // Responses still queued: the client has to drain them first
+    if (connection->outputIndex < connection->output.size()) return;
+
+    // Emptied, not cleared: QByteArray::clear() would also free the capacity
+    connection->headers.truncate(0);
+    connection->output.clear();
+    connection->outputIndex = 0;
+    m_pieces.clear();
+
+    const char* data = connection->input.constData();
+    const qsizetype available = connection->input.size();
+    qsizetype consumed = 0;
+    while (available - consumed >= qsizetype(sizeof(quint32))) {
+        ServeProtocol::RequestHeader header;
+        quint32 length;
+        std::memcpy(&length, data + consumed, sizeof(length));
+        if (length < sizeof(header) - sizeof(quint32) || length > ServeProtocol::kMaxRequestLength) {
+            // Framing is lost; nothing after this can be trusted
+            ::shutdown(connection->fd, SHUT_RD);
+            consumed = available;
+            break;
+        }
+        if (available - consumed < qsizetype(sizeof(quint32) + length)) break;
+        std::memcpy(&header, data + consumed, sizeof(header));
+        answer(connection, header.id, header.op, header.limit,
+               data + consumed + sizeof(header), quint32(length - (sizeof(header) - sizeof(quint32))));
+        consumed += qsizetype(sizeof(quint32) + length);
+    }
+    connection->input.remove(0, consumed);
+
+    // Header bytes have all been appended, so pointers into them are now stable
+    connection->output.reserve(m_pieces.size());
+    for (const Piece& piece : m_pieces) {
+        struct iovec vector;
+        vector.iov_base = const_cast<char*>(piece.data ? piece.data : connection->headers.constData() + piece.offset);
+        vector.iov_len = size_t(piece.length);
+        connection->output.append(vector);
+    }
+}
+
+void QueryServer::answer(Connection* connection, quint32 id, quint8 op, quint8 limit,
+                         const char* payload, quint32 length) {
+    ServeProtocol::ResponseHeader response{};
+    response.id = id;
+    response.status = ServeProtocol::Ok;
+
+    QVector<QueryIndex::Hit>& hits = m_hits;
+    hits.clear();
+    switch (op) {
+    case ServeProtocol::Search: {
+        // Decoded and normalized into reused buffers; UTF-16 never needs more units than UTF-8 bytes
+        QStringDecoder decoder(QStringDecoder::Utf8, QStringDecoder::Flag::Stateless);
+        m_queryText.resize(qsizetype(length));
+        const QChar* end = decoder.appendToBuffer(m_queryText.data(), QByteArrayView(payload, qsizetype(length)));
+        QueryIndex::normalize(QStringView(m_queryText.constData(), end - m_queryText.constData()), m_query);
+        if (!m_query.isEmpty()) {
+            m_index.search(m_query, limit ? limit : ServeProtocol::kDefaultLimit, hits);
+        }
+        break;
+    }
+    case ServeProtocol::Answer: {
+        quint32 entry = 0;
+        if (length != sizeof(entry)) {
+            response.status = ServeProtocol::BadRequest;
+            break;
+        }
+        std::memcpy(&entry, payload, sizeof(entry));
+        if (entry >= quint32(m_store.count())) {
+            response.status = ServeProtocol::NotFound;
+        } else {
+            hits.append({int(entry), 1.0});
+        }
+        break;
+    }
+    case ServeProtocol::Ping:
+        break;
+    default:
+        response.status = ServeProtocol::BadRequest;
+        break;
+    }
+
+    // Response header first, patched with the final length below
+    const qsizetype responseOffset = connection->headers.size();
+    connection->headers.append(reinterpret_cast<const char*>(&response), sizeof(response));
+    m_pieces.append({nullptr, responseOffset, qsizetype(sizeof(response))});
+
+    quint32 bodyLength = sizeof(response) - sizeof(quint32);
+    for (const QueryIndex::Hit& hit : hits) {
+        quint32 recordLength = 0;
+        const char* record = m_store.record(hit.entry, &recordLength);
+        if (!record) continue;
+
+        ServeProtocol::HitHeader hitHeader{};
+        hitHeader.entry = quint32(hit.entry);
+        hitHeader.score = quint16(qRound(hit.score * 1000));
+        hitHeader.recordLength = recordLength;
+        const qsizetype hitOffset = connection->headers.size();
+        connection->headers.append(reinterpret_cast<const char*>(&hitHeader), sizeof(hitHeader));
+        m_pieces.append({nullptr, hitOffset, qsizetype(sizeof(hitHeader))});
+        m_pieces.append({record, 0, qsizetype(recordLength)});
+
+        bodyLength += quint32(sizeof(hitHeader)) + recordLength;
+        ++response.count;
+    }
+    response.length = bodyLength;
+    std::memcpy(connection->headers.data() + responseOffset, &response, sizeof(response));
+}
+
+bool QueryServer::flush(Connection* connection) {
+    while (connection->outputIndex < connection->output.size()) {
+        struct iovec* first = connection->output.data() + connection->outputIndex;
+        const int count = qMin(int(connection->output.size()) - connection->outputIndex, IOV_MAX);
+        ssize_t written = ::writev(connection->fd, first, count);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                connection->wantsWrite = true;
+                return true;
+            }
+            return false;
+        }
+        // Skip what went out and trim a partially written vector
+        while (written > 0 && connection->outputIndex < connection->output.size()) {
+            struct iovec& vector = connection->output[connection->outputIndex];
+            if (size_t(written) < vector.iov_len) {
+                vector.iov_base = static_cast<char*>(vector.iov_base) + written;
+                vector.iov_len -= size_t(written);
+                written = 0;
+            } else {
+                written -= ssize_t(vector.iov_len);
+                ++connection->outputIndex;
+            }
+        }
+    }
+    connection->wantsWrite = false;
+    return true;
+}
+
+void QueryServer::updateInterest(Connection* connection) {
+    // Pipelined requests that arrived behind a blocked write are answered
+    // once the output drains
+    epoll_event event{};
+    const bool canRead = !connection->peerClosed && connection->input.size() < kMaxBufferedInput;
+    event.events = (canRead ? EPOLLIN : 0u)
+                 | (connection->wantsWrite ? EPOLLOUT : 0u);
+    event.data.fd = connection->fd;
+    ::epoll_ctl(m_epollFd, EPOLL_CTL_MOD, connection->fd, &event);
+}
+
+#else
+
+QueryServer::~QueryServer() = default;
+
+bool QueryServer::listen(const QString&) {
+    m_error = "--serve needs epoll and is only available on Linux";
+    return false;
+}
+
+bool QueryServer::run() { return false; }
+void QueryServer::stop() {}
+
+#endif
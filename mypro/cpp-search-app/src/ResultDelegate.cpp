@@ -0,0 +1,186 @@
+#include "ResultDelegate.h"
+#include "ResultsModel.h"
+#include <QApplication>
+#include <QPainter>
+#include <QFontMetrics>
+#include <QDateTime>
+
+namespace {
+constexpr int kMargin = 6;
+constexpr int kPadding = 14;
+constexpr int kLineGap = 2;
+constexpr int kDescriptionLines = 2;
+constexpr int kCachedRows = 256;
+
+QString relevanceIcon(double score) {
+    if (score >= 0.8) return QStringLiteral("🔥");
+    if (score >= 0.6) return QStringLiteral("⭐");
+    if (score >= 0.4) return QStringLiteral("⚡");
+    return QStringLiteral("💡");
+}
+
+QStaticText preparedText(const QString& text, const QFont& font) {
+    QStaticText staticText(text);
+    staticText.setTextFormat(Qt::PlainText);
+    staticText.setPerformanceHint(QStaticText::AggressiveCaching);
+    staticText.prepare(QTransform(), font);
+    return staticText;
+}
+}
+
+ResultDelegate::ResultDelegate(QObject *parent)
+    : QStyledItemDelegate(parent)
+    , m_cache(kCachedRows)
+{
+    const QFont base = QApplication::font();
+    m_titleFont = base;
+    m_titleFont.setPixelSize(15);
+    m_titleFont.setWeight(QFont::Bold);
+    m_metaFont = base;
+    m_metaFont.setPixelSize(12);
+    m_textFont = base;
+    m_textFont.setPixelSize(13);
+    m_footerFont = base;
+    m_footerFont.setPixelSize(11);
+
+    // Title, URL, description lines and footer, plus card padding and margins
+    m_rowHeight = 2 * (kMargin + kPadding)
+                + QFontMetrics(m_titleFont).height() + kLineGap
+                + QFontMetrics(m_metaFont).height() + kLineGap
+                + kDescriptionLines * QFontMetrics(m_textFont).height() + 3 * kLineGap
+                + QFontMetrics(m_footerFont).height();
+
+    m_colors.card = QColor(255, 255, 255, 10);
+    m_colors.cardBorder = QColor(255, 255, 255, 20);
+    m_colors.hover = QColor(0, 212, 255, 26);
+    m_colors.accent = QColor(0x00, 0xd4, 0xff);
+    m_colors.selectedText = QColor(0, 0, 0);
+    m_colors.title = QColor(0x00, 0xd4, 0xff);
+    m_colors.meta = QColor(0x9a, 0xa4, 0xaf);
+    m_colors.text = QColor(0xe0, 0xe3, 0xe6);
+}
+
+void ResultDelegate::setColors(const Colors& colors) {
+    m_colors = colors;
+}
+
+void ResultDelegate::invalidateCache() {
+    m_cache.clear();
+}
+
+QSize ResultDelegate::sizeHint(const QStyleOptionViewItem& option, const QModelIndex& index) const {
+    Q_UNUSED(option)
+    Q_UNUSED(index)
+    return QSize(0, m_rowHeight);
+}
+
+void ResultDelegate::layoutDescription(QTextLayout& layout, const QString& text, int width) const {
+    QString flowed = text;
+    flowed.replace('\n', QChar::LineSeparator);
+
+    QTextOption textOption;
+    textOption.setWrapMode(QTextOption::WrapAtWordBoundaryOrAnywhere);
+    layout.setFont(m_textFont);
+    layout.setTextOption(textOption);
+    layout.setCacheEnabled(true);
+
+    // First pass finds where the last visible line starts; if the text
+    // overflows, that tail is elided and the layout rebuilt once
+    for (int pass = 0; pass < 2; ++pass) {
+        layout.setText(flowed);
+        layout.beginLayout();
+        qreal y = 0;
+        int lastLineStart = 0;
+        int lastLineEnd = 0;
+        for (int i = 0; i < kDescriptionLines; ++i) {
+            QTextLine line = layout.createLine();
+            if (!line.isValid()) break;
+            line.setLineWidth(width);
+            line.setPosition(QPointF(0, y));
+            y += line.height();
+            lastLineStart = line.textStart();
+            lastLineEnd = line.textStart() + line.textLength();
+        }
+        layout.endLayout();
+
+        if (pass == 1 || lastLineEnd >= flowed.size()) break;
+        QString tail = flowed.mid(lastLineStart);
+        tail.replace(QChar::LineSeparator, ' ');
+        flowed = flowed.left(lastLineStart)
+               + QFontMetrics(m_textFont).elidedText(tail, Qt::ElideRight, width);
+    }
+}
+
+ResultDelegate::RowLayout* ResultDelegate::layoutFor(const QModelIndex& index, int width) const {
+    RowLayout* row = m_cache.object(index.row());
+    if (row && row->width == width) return row;
+
+    row = new RowLayout;
+    row->width = width;
+
+    const QString title = index.data(ResultsModel::TitleRole).toString();
+    const double score = index.data(ResultsModel::RelevanceRole).toDouble();
+    const QString displayUrl = index.data(ResultsModel::DisplayUrlRole).toString();
+    const QString source = index.data(ResultsModel::SourceRole).toString();
+    const QDateTime timestamp = index.data(ResultsModel::TimestampRole).toDateTime();
+
+    const QFontMetrics titleMetrics(m_titleFont);
+    const QFontMetrics metaMetrics(m_metaFont);
+    const QFontMetrics footerMetrics(m_footerFont);
+
+    row->title = preparedText(titleMetrics.elidedText(relevanceIcon(score) + ' ' + title, Qt::ElideRight, width),
+                              m_titleFont);
+    row->meta = preparedText(metaMetrics.elidedText(displayUrl, Qt::ElideRight, width), m_metaFont);
+    row->footer = preparedText(footerMetrics.elidedText(
+                                   QString("Source: %1 • Relevance: %2% • %3")
+                                       .arg(source,
+                                            QString::number(int(score * 100)),
+                                            timestamp.toString("MMM dd, hh:mm")),
+                                   Qt::ElideRight, width),
+                               m_footerFont);
+    // Only the bounded snippet is laid out here; the full text is laid out
+    // by the detail view when the row becomes current
+    layoutDescription(row->description, index.data(ResultsModel::SnippetRole).toString(), width);
+
+    m_cache.insert(index.row(), row);
+    return row;
+}
+
+void ResultDelegate::paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const {
+    painter->save();
+    painter->setRenderHint(QPainter::Antialiasing);
+
+    const bool selected = option.state & QStyle::State_Selected;
+    const bool hovered = option.state & QStyle::State_MouseOver;
+
+    const QRect card = option.rect.adjusted(kMargin, kMargin, -kMargin, -kMargin);
+    painter->setPen(QPen(selected || hovered ? m_colors.accent : m_colors.cardBorder, 1));
+    painter->setBrush(selected ? m_colors.accent : hovered ? m_colors.hover : m_colors.card);
+    painter->drawRoundedRect(QRectF(card).adjusted(0.5, 0.5, -0.5, -0.5), 12, 12);
+
+    const int textWidth = qMax(1, card.width() - 2 * kPadding);
+    RowLayout* row = layoutFor(index, textWidth);
+
+    const int x = card.left() + kPadding;
+    int y = card.top() + kPadding;
+
+    painter->setFont(m_titleFont);
+    painter->setPen(selected ? m_colors.selectedText : m_colors.title);
+    painter->drawStaticText(x, y, row->title);
+    y += QFontMetrics(m_titleFont).height() + kLineGap;
+
+    painter->setFont(m_metaFont);
+    painter->setPen(selected ? m_colors.selectedText : m_colors.meta);
+    painter->drawStaticText(x, y, row->meta);
+    y += QFontMetrics(m_metaFont).height() + kLineGap;
+
+    painter->setPen(selected ? m_colors.selectedText : m_colors.text);
+    row->description.draw(painter, QPointF(x, y));
+    y += kDescriptionLines * QFontMetrics(m_textFont).height() + 3 * kLineGap;
+
+    painter->setFont(m_footerFont);
+    painter->setPen(selected ? m_colors.selectedText : m_colors.title);
+    painter->drawStaticText(x, y, row->footer);
+
+    painter->restore();
+}
@@ -0,0 +1,106 @@
+#include "ResultsModel.h"
+#include <algorithm>
+
+ResultsModel::ResultsModel(QObject *parent)
+    : QAbstractListModel(parent)
+    , m_loadedRows(0)
+    , m_batchSize(50)
+{
+}
+
+void ResultsModel::setResults(const QVector<SearchResult>& results) {
+    beginResetModel();
+    m_results = results;
+    m_loadedRows = qMin(m_batchSize, int(m_results.size()));
+    endResetModel();
+}
+
+void ResultsModel::mergeResults(const QVector<SearchResult>& batch) {
+    int searchFrom = 0;
+    int i = 0;
+    while (i < batch.size()) {
+        // All batch items that land at the same position go in as one insert
+        const auto insertAt = std::upper_bound(m_results.begin() + searchFrom, m_results.end(), batch.at(i));
+        const int position = int(insertAt - m_results.begin());
+        int runEnd = i + 1;
+        while (runEnd < batch.size()
+               && (position == m_results.size() || batch.at(runEnd) < m_results.at(position))) {
+            ++runEnd;
+        }
+        const int count = runEnd - i;
+
+        // Rows past the loaded range are not visible to the view yet
+        const bool visible = position < m_loadedRows;
+        if (visible) beginInsertRows(QModelIndex(), position, position + count - 1);
+        m_results.insert(position, count, SearchResult());
+        std::copy(batch.begin() + i, batch.begin() + runEnd, m_results.begin() + position);
+        if (visible) {
+            m_loadedRows += count;
+            endInsertRows();
+        }
+
+        searchFrom = position + count;
+        i = runEnd;
+    }
+    topUpLoadedRows();
+}
+
+void ResultsModel::topUpLoadedRows() {
+    // Keep at least one fetch batch visible so the first screen fills without scrolling
+    const int target = qMin(m_batchSize, int(m_results.size()));
+    if (m_loadedRows >= target) return;
+    beginInsertRows(QModelIndex(), m_loadedRows, target - 1);
+    m_loadedRows = target;
+    endInsertRows();
+}
+
+void ResultsModel::clear() {
+    beginResetModel();
+    m_results.clear();
+    m_loadedRows = 0;
+    endResetModel();
+}
+
+int ResultsModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : m_loadedRows;
+}
+
+QVariant ResultsModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || index.row() >= m_loadedRows) return QVariant();
+
+    const SearchResult& result = m_results.at(index.row());
+    switch (role) {
+    case Qt::DisplayRole:
+    case TitleRole:
+        return result.title;
+    case DescriptionRole:
+        return result.description;
+    case SnippetRole:
+        return result.snippet();
+    case DisplayUrlRole:
+        return result.displayUrl;
+    case SourceRole:
+        return result.sourceEngine;
+    case RelevanceRole:
+        return result.relevanceScore;
+    case TimestampRole:
+        return result.timestamp;
+    default:
+        return QVariant();
+    }
+}
+
+bool ResultsModel::canFetchMore(const QModelIndex& parent) const {
+    return !parent.isValid() && m_loadedRows < m_results.size();
+}
+
+void ResultsModel::fetchMore(const QModelIndex& parent) {
+    if (parent.isValid()) return;
+    const int remaining = int(m_results.size()) - m_loadedRows;
+    const int count = qMin(m_batchSize, remaining);
+    if (count <= 0) return;
+
+    beginInsertRows(QModelIndex(), m_loadedRows, m_loadedRows + count - 1);
+    m_loadedRows += count;
+    endInsertRows();
+}
@@ -1,64 +1,60 @@
 #include "ResultsWidget.h"
-#include <QListWidgetItem>
+#include "Metrics.h"
+#include "Tracer.h"
 
-ResultsWidget::ResultsWidget(QWidget *parent) : QWidget(parent) {
+ResultsWidget::ResultsWidget(QWidget *parent)
+    : QWidget(parent), m_detailView(nullptr), m_replaceOnNextBatch(false) {
     m_layout = new QVBoxLayout(this);
     m_layout->setContentsMargins(0, 0, 0, 0);
     m_layout->setSpacing(0);
     
     m_statusLabel = new QLabel("No results", this);
     m_statusLabel->setAlignment(Qt::AlignCenter);
-    m_statusLabel->setStyleSheet(R"(
-        QLabel { 
-            color: #888888; 
-            font-style: italic; 
-            font-size: 16px;
-            padding: 24px;
-            background-color: rgba(255,255,255,0.04);
-            border: 1px dashed rgba(255,255,255,0.1);
-            border-radius: 12px;
-            margin: 12px;
-        }
-    )");
-    
-    m_resultsList = new QListWidget(this);
-    m_resultsList->setStyleSheet(R"(
-        QListWidget {
-            background-color: transparent;
-            border: none;
-            outline: none;
-            font-size: 14px;
-        }
-        QListWidget::item {
-            background-color: rgba(255,255,255,0.04);
-            border: 1px solid rgba(255,255,255,0.08);
-            border-radius: 12px;
-            margin: 6px;
-            padding: 14px;
-            color: #ffffff;
-        }
-        QListWidget::item:hover {
-            background-color: rgba(0,212,255,0.10);
-            border-color: #00d4ff;
-        }
-        QListWidget::item:selected {
-            background-color: #00d4ff;
-            color: #000000;
-            border-color: #00d4ff;
-        }
-    )");
-    
-    connect(m_resultsList, &QListWidget::itemClicked, this, &ResultsWidget::onItemClicked);
+    QFont statusFont = m_statusLabel->font();
+    statusFont.setItalic(true);
+    statusFont.setPixelSize(16);
+    m_statusLabel->setFont(statusFont);
+    m_statusLabel->setForegroundRole(QPalette::PlaceholderText);
+    m_statusLabel->setMargin(24);
     
+    // Virtualized view: fixed row height lets the view skip per-row layout,
+    // and the model hands rows out in batches as the user scrolls
+    m_model = new ResultsModel(this);
+    m_delegate = new ResultDelegate(this);
+    m_resultsList = new QListView(this);
+    m_resultsList->setModel(m_model);
+    m_resultsList->setItemDelegate(m_delegate);
+    m_resultsList->setUniformItemSizes(true);
+    m_resultsList->setLayoutMode(QListView::Batched);
+    m_resultsList->setVerticalScrollMode(QAbstractItemView::ScrollPerPixel);
+    m_resultsList->setSelectionMode(QAbstractItemView::SingleSelection);
+    m_resultsList->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_resultsList->setMouseTracking(true);
+    m_resultsList->viewport()->setAttribute(Qt::WA_Hover);
+    // Cards float on the window background
+    m_resultsList->setFrameShape(QFrame::NoFrame);
+    m_resultsList->viewport()->setAutoFillBackground(false);
+
+    connect(m_model, &QAbstractItemModel::modelReset, m_delegate, &ResultDelegate::invalidateCache);
+    connect(m_model, &QAbstractItemModel::rowsInserted, m_delegate, &ResultDelegate::invalidateCache);
+    connect(m_resultsList, &QListView::clicked, this, &ResultsWidget::onItemClicked);
+    connect(m_resultsList->selectionModel(), &QItemSelectionModel::currentChanged,
+            this, &ResultsWidget::onCurrentChanged);
+
     m_layout->addWidget(m_statusLabel);
-    m_layout->addWidget(m_resultsList);
+    m_layout->addWidget(m_resultsList, 1);
     
     setLayout(m_layout);
 }
 
 void ResultsWidget::displayResults(const QVector<SearchResult>& results) {
-    m_results = results;
-    m_resultsList->clear();
+    TraceSpan span("ResultsWidget::displayResults");
+    static Metrics::Histogram& renderTime = Metrics::instance()->histogram(
+        "render_results_seconds", "Handing a result set to the results view");
+    Metrics::ScopedTimer timer(renderTime);
+    m_replaceOnNextBatch = false;
+    m_model->setResults(results);
+    hideDetail();
     
     if (results.isEmpty()) {
         m_statusLabel->setText("No results found");
@@ -69,77 +65,103 @@ void ResultsWidget::displayResults(const QVector<SearchResult>& results) {
     
     m_statusLabel->hide();
     m_resultsList->show();
-    
-    for (const SearchResult& result : results) {
-        QListWidgetItem* item = new QListWidgetItem();
-        
-        QString relevanceIcon = "⭐";
-        if (result.relevanceScore >= 0.8) relevanceIcon = "🔥";
-        else if (result.relevanceScore >= 0.6) relevanceIcon = "⭐";
-        else if (result.relevanceScore >= 0.4) relevanceIcon = "⚡";
-        else relevanceIcon = "💡";
-        
-        QString itemText = QString(
-            "<div style='margin: 4px;'>"
-            "<div style='color: #00d4ff; font-weight: 700; font-size: 15px;'>%1 %2</div>"
-            "<div style='color: #9aa4af; font-size: 12px; margin: 2px 0;'>%3</div>"
-            "<div style='color: #e0e3e6; font-size: 13px; line-height: 1.4;'>%4</div>"
-            "<div style='color: #00d4ff; font-size: 11px; margin-top: 6px;'>"
-            "Source: %5 • Relevance: %6% • %7"
-            "</div>"
-            "</div>"
-        ).arg(
-            relevanceIcon,
-            result.title,
-            result.displayUrl,
-            result.description,
-            result.sourceEngine,
-            QString::number(int(result.relevanceScore * 100)),
-            result.timestamp.toString("MMM dd, hh:mm")
-        );
-        
-        item->setText(itemText);
-        item->setData(Qt::UserRole, QVariant::fromValue(result));
-        item->setSizeHint(QSize(0, 110));
-        
-        m_resultsList->addItem(item);
-    }
+    m_resultsList->scrollToTop();
     
     m_statusLabel->setText(QString("Found %1 results").arg(results.size()));
 }
 
+void ResultsWidget::beginStreaming() {
+    // Swapping the old rows out only when new ones exist avoids an empty flash
+    m_replaceOnNextBatch = true;
+}
+
+void ResultsWidget::appendResults(const QVector<SearchResult>& batch) {
+    TraceSpan span("ResultsWidget::appendResults");
+    if (m_replaceOnNextBatch) {
+        displayResults(batch);
+        return;
+    }
+    m_model->mergeResults(batch);
+    m_statusLabel->setText(QString("Found %1 results").arg(m_model->totalCount()));
+}
+
+void ResultsWidget::finishStreaming() {
+    if (m_replaceOnNextBatch) {
+        displayResults({});
+    }
+}
+
+SearchResult ResultsWidget::topResult() const {
+    return m_model->totalCount() > 0 ? m_model->resultAt(0) : SearchResult();
+}
+
 void ResultsWidget::clearResults() {
-    m_results.clear();
-    m_resultsList->clear();
+    m_replaceOnNextBatch = false;
+    m_model->clear();
+    hideDetail();
     m_statusLabel->setText("No results");
     m_resultsList->show();
     m_statusLabel->show();
 }
 
-void ResultsWidget::onItemClicked() {
-    QListWidgetItem* item = m_resultsList->currentItem();
-    if (item) {
-        SearchResult result = item->data(Qt::UserRole).value<SearchResult>();
-        emit resultClicked(result);
+void ResultsWidget::onItemClicked(const QModelIndex& index) {
+    if (index.isValid()) {
+        emit resultClicked(m_model->resultAt(index.row()));
     }
 }
 
+void ResultsWidget::onCurrentChanged(const QModelIndex& current) {
+    if (!current.isValid()) {
+        hideDetail();
+        return;
+    }
+    const SearchResult& result = m_model->resultAt(current.row());
+    if (!result.isTruncated()) {
+        // The card already shows everything
+        hideDetail();
+        return;
+    }
+    if (!m_detailView) {
+        // Expanded answer for the current row only, built the first time it is needed
+        m_detailView = new QTextBrowser(this);
+        m_detailView->setMaximumHeight(200);
+        m_detailView->setOpenLinks(false);
+        m_layout->addWidget(m_detailView);
+    }
+    m_detailView->setPlainText(result.description);
+    m_detailView->show();
+}
+
+void ResultsWidget::hideDetail() {
+    if (m_detailView) m_detailView->hide();
+}
+
 void ResultsWidget::applyLightStyle() {
-    m_resultsList->setStyleSheet(R"(
-        QListWidget { background-color: transparent; border: none; outline: none; font-size: 14px; }
-        QListWidget::item { background-color: #ffffff; border: 1px solid #e1e4ea; border-radius: 12px; margin: 6px; padding: 14px; color: #111111; }
-        QListWidget::item:hover { background-color: #f0f5ff; border-color: #4a90e2; }
-        QListWidget::item:selected { background-color: #4a90e2; color: #ffffff; border-color: #4a90e2; }
-    )");
+    ResultDelegate::Colors colors;
+    colors.card = QColor(0xff, 0xff, 0xff);
+    colors.cardBorder = QColor(0xe1, 0xe4, 0xea);
+    colors.hover = QColor(0xf0, 0xf5, 0xff);
+    colors.accent = QColor(0x4a, 0x90, 0xe2);
+    colors.selectedText = QColor(0xff, 0xff, 0xff);
+    colors.title = QColor(0x4a, 0x90, 0xe2);
+    colors.meta = QColor(0x6b, 0x75, 0x80);
+    colors.text = QColor(0x11, 0x11, 0x11);
+    m_delegate->setColors(colors);
+    m_resultsList->viewport()->update();
 }
 
 void ResultsWidget::applyDarkStyle() {
-    m_resultsList->setStyleSheet(R"(
-        QListWidget { background-color: transparent; border: none; outline: none; font-size: 14px; }
-        QListWidget::item { background-color: rgba(255,255,255,0.04); border: 1px solid rgba(255,255,255,0.08); border-radius: 12px; margin: 6px; padding: 14px; color: #ffffff; }
-        QListWidget::item:hover { background-color: rgba(0,212,255,0.10); border-color: #00d4ff; }
-        QListWidget::item:selected { background-color: #00d4ff; color: #000000; border-color: #00d4ff; }
-    )");
+    ResultDelegate::Colors colors;
+    colors.card = QColor(255, 255, 255, 10);
+    colors.cardBorder = QColor(255, 255, 255, 20);
+    colors.hover = QColor(0, 212, 255, 26);
+    colors.accent = QColor(0x00, 0xd4, 0xff);
+    colors.selectedText = QColor(0x00, 0x00, 0x00);
+    colors.title = QColor(0x00, 0xd4, 0xff);
+    colors.meta = QColor(0x9a, 0xa4, 0xaf);
+    colors.text = QColor(0xe0, 0xe3, 0xe6);
+    m_delegate->setColors(colors);
+    m_resultsList->viewport()->update();
 }
 
 #include "ResultsWidget.moc"
@@ -0,0 +1,305 @@
+#include "SearchEngine.h"
+#include "Metrics.h"
+#include "OfflineQADatabase.h"
+#include "Tracer.h"
+#include <QElapsedTimer>
+#include <QMutexLocker>
+#include <QThread>
+#include <algorithm>
+#include <memory>
+
+SearchEngine::SearchEngine(OfflineQADatabase* database, QObject *parent)
+    : QObject(parent)
+    , m_database(database)
+    , m_searchGeneration(0)
+    , m_shardSize(2048)
+    , m_speculationDepth(2)
+    , m_prefetched(0)
+    , m_hits(0)
+    , m_misses(0)
+    , m_wasted(0)
+{
+    // Speculation must never compete with the GUI thread for a core
+    m_speculationPool.setMaxThreadCount(1);
+    m_speculationPool.setThreadPriority(QThread::LowestPriority);
+}
+
+SearchEngine::~SearchEngine() {
+    cancelSearch();
+    m_searchPool.clear();
+    m_searchPool.waitForDone();
+    m_speculationPool.clear();
+    m_speculationPool.waitForDone();
+}
+
+namespace {
+Metrics::Histogram& matchTime() {
+    static Metrics::Histogram& histogram = Metrics::instance()->histogram(
+        "query_match_seconds", "Scoring database questions against a query (per shard when streaming)");
+    return histogram;
+}
+
+Metrics::Histogram& rankTime() {
+    static Metrics::Histogram& histogram = Metrics::instance()->histogram(
+        "query_rank_seconds", "Sorting matched results (per shard when streaming)");
+    return histogram;
+}
+
+Metrics::Counter& fallbacks() {
+    static Metrics::Counter& counter = Metrics::instance()->counter(
+        "query_fallback_total", "Searches without matches answered with the first entries");
+    return counter;
+}
+}
+
+QString SearchEngine::cacheKey(const QString& query) {
+    return query.toLower().trimmed();
+}
+
+QVector<SearchResult> SearchEngine::search(const QString& query, bool* fromCache, SearchExplain* explain) {
+    if (explain) {
+        QElapsedTimer total;
+        total.start();
+        explain->query = query;
+        {
+            SearchExplain::StageTimer stage(explain, "speculative-cache");
+            bool ready;
+            {
+                QMutexLocker locker(&m_cacheMutex);
+                ready = m_speculativeCache.contains(cacheKey(query));
+            }
+            stage.setCounts(1, 0);
+            stage.setDetail(ready ? "prefetched result set ready; recomputed to explain it" : "nothing prefetched");
+        }
+        if (fromCache) *fromCache = false;
+        const QVector<SearchResult> results = buildOfflineResults(query, explain);
+        explain->totalNs = total.nsecsElapsed();
+        return results;
+    }
+
+    QVector<SearchResult> results;
+    const bool hit = takeSpeculative(query, &results);
+    if (fromCache) *fromCache = hit;
+    return hit ? results : buildOfflineResults(query);
+}
+
+bool SearchEngine::takeSpeculative(const QString& query, QVector<SearchResult>* results) {
+    static Metrics::Counter& speculativeHits = Metrics::instance()->counter(
+        "search_cache_hits_total", "Searches answered from the speculative prefetch cache");
+    static Metrics::Counter& speculativeMisses = Metrics::instance()->counter(
+        "search_cache_misses_total", "Searches computed on demand");
+    const QString key = cacheKey(query);
+    {
+        QMutexLocker locker(&m_cacheMutex);
+        auto it = m_speculativeCache.find(key);
+        if (it != m_speculativeCache.end()) {
+            *results = std::move(it.value());
+            m_speculativeCache.erase(it);
+            m_pendingKeys.remove(key);
+            m_hits.fetchAndAddRelaxed(1);
+            speculativeHits.add();
+            return true;
+        }
+        // A prefetch still in flight for this key would now be redundant
+        m_pendingKeys.remove(key);
+    }
+
+    m_misses.fetchAndAddRelaxed(1);
+    speculativeMisses.add();
+    return false;
+}
+
+quint64 SearchEngine::startSearch(const QString& query) {
+    const quint64 searchId = m_searchGeneration.fetchAndAddOrdered(1) + 1;
+    m_searchPool.clear();
+
+    const int questionCount = m_database->questionCount();
+    const int shardCount = qMax(1, (questionCount + m_shardSize - 1) / m_shardSize);
+    auto remaining = std::make_shared<QAtomicInt>(shardCount);
+    auto total = std::make_shared<QAtomicInt>(0);
+
+    for (int shard = 0; shard < shardCount; ++shard) {
+        const int begin = shard * m_shardSize;
+        const int end = qMin(begin + m_shardSize, questionCount);
+        m_searchPool.start([this, searchId, query, begin, end, remaining, total]() {
+            TraceSpan span("SearchEngine shard");
+            QVector<SearchResult> batch;
+            if (m_searchGeneration.loadAcquire() == searchId) {
+                {
+                    Metrics::ScopedTimer timer(matchTime());
+                    m_database->collectMatches(query, begin, end, batch);
+                }
+                {
+                    Metrics::ScopedTimer timer(rankTime());
+                    std::sort(batch.begin(), batch.end());
+                }
+                total->fetchAndAddRelaxed(batch.size());
+            }
+            const bool last = remaining->fetchAndAddOrdered(-1) == 1;
+            if (last && total->loadAcquire() == 0 && m_searchGeneration.loadAcquire() == searchId) {
+                batch = fallbackResults();
+                fallbacks().add();
+                total->fetchAndAddRelaxed(batch.size());
+            }
+            const int totalResults = total->loadAcquire();
+
+            QMetaObject::invokeMethod(this, [this, searchId, batch, last, totalResults]() {
+                if (m_searchGeneration.loadAcquire() != searchId) return;
+                if (!batch.isEmpty()) emit resultsBatch(searchId, batch);
+                if (last) emit searchFinished(searchId, totalResults);
+            }, Qt::QueuedConnection);
+        });
+    }
+    return searchId;
+}
+
+void SearchEngine::cancelSearch() {
+    m_searchGeneration.fetchAndAddOrdered(1);
+}
+
+void SearchEngine::speculate(const QStringList& candidates) {
+    QStringList keys;
+    for (const QString& candidate : candidates) {
+        const QString key = cacheKey(candidate);
+        if (!key.isEmpty() && !keys.contains(key)) keys.append(key);
+        if (keys.size() >= m_speculationDepth) break;
+    }
+
+    // Queued-but-not-started passes are for stale candidates
+    m_speculationPool.clear();
+
+    QVector<QPair<QString, quint64>> toCompute;  // key, ticket
+    {
+        QMutexLocker locker(&m_cacheMutex);
+        for (auto it = m_speculativeCache.begin(); it != m_speculativeCache.end();) {
+            if (!keys.contains(it.key())) {
+                m_wasted.fetchAndAddRelaxed(1);
+                it = m_speculativeCache.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        // A running pass for a key that is still wanted carries on; the queued
+        // ones were dropped above and are queued again below
+        for (auto it = m_pendingKeys.begin(); it != m_pendingKeys.end();) {
+            if (!it.value().running || !keys.contains(it.key())) {
+                it = m_pendingKeys.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        for (const QString& key : keys) {
+            if (m_speculativeCache.contains(key) || m_pendingKeys.contains(key)) continue;
+            m_pendingKeys.insert(key, {++m_nextTicket, false});
+            toCompute.append({key, m_nextTicket});
+        }
+    }
+
+    for (const auto& pass : toCompute) {
+        m_speculationPool.start([this, key = pass.first, ticket = pass.second]() {
+            {
+                QMutexLocker locker(&m_cacheMutex);
+                auto it = m_pendingKeys.find(key);
+                if (it == m_pendingKeys.end() || it.value().ticket != ticket) return;
+                it.value().running = true;
+            }
+
+            QVector<SearchResult> results = buildOfflineResults(key);
+
+            QMutexLocker locker(&m_cacheMutex);
+            auto it = m_pendingKeys.find(key);
+            const bool current = it != m_pendingKeys.end() && it.value().ticket == ticket;
+            if (current) m_pendingKeys.erase(it);
+            if (current && !m_speculativeCache.contains(key)) {
+                m_speculativeCache.insert(key, std::move(results));
+                m_prefetched.fetchAndAddRelaxed(1);
+            } else {
+                m_wasted.fetchAndAddRelaxed(1);
+            }
+        });
+    }
+}
+
+void SearchEngine::invalidateSpeculation() {
+    m_speculationPool.clear();
+    QMutexLocker locker(&m_cacheMutex);
+    m_wasted.fetchAndAddRelaxed(m_speculativeCache.size());
+    m_speculativeCache.clear();
+    // In-flight passes see their key gone and count themselves as wasted
+    m_pendingKeys.clear();
+}
+
+SpeculationStats SearchEngine::speculationStats() const {
+    SpeculationStats stats;
+    stats.prefetched = m_prefetched.loadRelaxed();
+    stats.hits = m_hits.loadRelaxed();
+    stats.misses = m_misses.loadRelaxed();
+    stats.wasted = m_wasted.loadRelaxed();
+    return stats;
+}
+
+void SearchEngine::resetSpeculationStats() {
+    m_prefetched.storeRelaxed(0);
+    m_hits.storeRelaxed(0);
+    m_misses.storeRelaxed(0);
+    m_wasted.storeRelaxed(0);
+}
+
+QVector<SearchResult> SearchEngine::buildOfflineResults(const QString& query, SearchExplain* explain) const {
+    TraceSpan span("SearchEngine::buildOfflineResults");
+    if (explain) explain->normalized = cacheKey(query);
+    QVector<SearchResult> results;
+    {
+        SearchExplain::StageTimer stage(explain, "full-scan");
+        Metrics::ScopedTimer timer(matchTime());
+        const int questions = m_database->questionCount();
+        m_database->collectMatches(query, 0, questions, results);
+        stage.setCounts(questions, int(results.size()));
+        if (stage.isActive()) {
+            int kinds[3] = {0, 0, 0};
+            for (const SearchResult& result : results) {
+                ++kinds[result.relevanceScore >= 1.0 ? 0 : result.relevanceScore >= 0.8 ? 1 : 2];
+            }
+            stage.setDetail(QString("every question: %1 exact, %2 contain the query, %3 contained in it")
+                                .arg(kinds[0]).arg(kinds[1]).arg(kinds[2]));
+        }
+    }
+    {
+        SearchExplain::StageTimer stage(explain, "rank");
+        Metrics::ScopedTimer timer(rankTime());
+        std::sort(results.begin(), results.end());
+        stage.setCounts(int(results.size()), int(results.size()));
+        if (stage.isActive()) stage.setDetail("by score, then shorter title, then title");
+    }
+    // If still empty, include more from catalog
+    const char* producedBy = "full-scan";
+    if (results.isEmpty()) {
+        SearchExplain::StageTimer stage(explain, "fallback-first-25");
+        results = fallbackResults();
+        fallbacks().add();
+        stage.setCounts(qMin(25, m_database->questionCount()), int(results.size()));
+        if (stage.isActive()) stage.setDetail("no question matched; the first entries in question order");
+        producedBy = "fallback-first-25";
+    } else if (explain) {
+        explain->skip("fallback-first-25", "the scan matched");
+    }
+
+    if (explain) {
+        for (const SearchResult& result : results) {
+            explain->addResult(result.entryId, result.title, QString::fromLatin1(producedBy), result.relevanceScore);
+        }
+    }
+    return results;
+}
+
+QVector<SearchResult> SearchEngine::fallbackResults() const {
+    // The first entries in question order, fetched one by one rather than
+    // copying the whole database to keep 25 of it
+    QVector<SearchResult> results;
+    const int limit = qMin(25, m_database->questionCount());
+    for (int i = 0; i < limit; ++i) {
+        const SearchResult result = m_database->entryAt(i);
+        if (result.isValid()) results.append(result);
+    }
+    return results;
+}
@@ -0,0 +1,115 @@
+#include "SearchExplain.h"
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+SearchExplain::StageTimer::StageTimer(SearchExplain* explain, const char* name)
+    : m_explain(explain)
+{
+    if (!m_explain) return;
+    Stage stage;
+    stage.name = QString::fromLatin1(name);
+    m_index = int(m_explain->stages.size());
+    m_explain->stages.append(stage);
+    m_timer.start();
+}
+
+void SearchExplain::StageTimer::setCounts(int candidates, int matched) {
+    if (m_index < 0) return;
+    Stage& stage = m_explain->stages[m_index];
+    stage.candidates = candidates;
+    stage.matched = matched;
+}
+
+void SearchExplain::StageTimer::setDetail(const QString& detail) {
+    if (m_index >= 0) m_explain->stages[m_index].detail = detail;
+}
+
+void SearchExplain::StageTimer::finish() {
+    if (m_index < 0) return;
+    m_explain->stages[m_index].ns = m_timer.nsecsElapsed();
+    m_index = -1;
+}
+
+void SearchExplain::skip(const char* name, const QString& reason) {
+    Stage stage;
+    stage.name = QString::fromLatin1(name);
+    stage.ran = false;
+    stage.detail = reason;
+    stages.append(stage);
+}
+
+void SearchExplain::addResult(int entryId, const QString& title, const QString& stage, double score) {
+    results.append({entryId, title, stage, score, int(title.size())});
+}
+
+const char* SearchExplain::matchKind(double score) {
+    if (score >= 1.0) return "exact";
+    if (score >= 0.8) return "contains query";
+    if (score >= 0.6) return "contained in query";
+    return "none";
+}
+
+QByteArray SearchExplain::toJson() const {
+    QJsonArray stageRows;
+    for (const Stage& stage : stages) {
+        QJsonObject row;
+        row["stage"] = stage.name;
+        row["ran"] = stage.ran;
+        row["candidates"] = stage.candidates;
+        row["matched"] = stage.matched;
+        row["ms"] = stage.ns / 1e6;
+        if (!stage.detail.isEmpty()) row["detail"] = stage.detail;
+        stageRows.append(row);
+    }
+    QJsonArray resultRows;
+    for (const Score& result : results) {
+        QJsonObject row;
+        row["id"] = result.entryId;
+        row["title"] = result.title;
+        row["stage"] = result.stage;
+        row["score"] = result.score;
+        row["match"] = matchKind(result.score);
+        row["title_length"] = result.titleLength;
+        resultRows.append(row);
+    }
+    QJsonObject root;
+    root["query"] = query;
+    root["normalized"] = normalized;
+    root["total_ms"] = totalNs / 1e6;
+    root["stages"] = stageRows;
+    root["results"] = resultRows;
+    return QJsonDocument(root).toJson(QJsonDocument::Compact);
+}
+
+QString SearchExplain::toText() const {
+    // One multi-arg call, so a % in the query is never taken for a placeholder;
+    // below, the free text (detail, title) always fills the last placeholder
+    QString text = QString("query \"%1\" (normalized \"%2\"), %3 ms\n\n")
+        .arg(query, normalized, QString::number(totalNs / 1e6, 'f', 3));
+    text += QString("%1 %2 %3 %4 %5  %6\n")
+        .arg("stage", -18).arg("ran", -4).arg("candidates", 10).arg("matched", 8).arg("ms", 10).arg("detail");
+    for (const Stage& stage : stages) {
+        text += QString("%1 %2 %3 %4 %5  %6\n")
+            .arg(stage.name, -18)
+            .arg(stage.ran ? "yes" : "no", -4)
+            .arg(stage.candidates, 10)
+            .arg(stage.matched, 8)
+            .arg(stage.ns / 1e6, 10, 'f', 3)
+            .arg(stage.detail);
+    }
+    text += QString("\n%1 %2 %3 %4 %5 %6  %7\n")
+        .arg("#", 3).arg("id", 7).arg("score", 5).arg("match", -19).arg("len", 4).arg("stage", -15).arg("title");
+    for (int i = 0; i < results.size(); ++i) {
+        const Score& result = results.at(i);
+        text += QString("%1 %2 %3 %4 %5 %6  %7\n")
+            .arg(i + 1, 3)
+            .arg(result.entryId, 7)
+            .arg(result.score, 5, 'f', 2)
+            .arg(matchKind(result.score), -19)
+            .arg(result.titleLength, 4)
+            .arg(result.stage, -15)
+            .arg(result.title);
+    }
+    return text;
+}
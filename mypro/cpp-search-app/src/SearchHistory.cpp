@@ -1,60 +1,110 @@
 #include "SearchHistory.h"
+#include "HistoryLog.h"
+#include <QDateTime>
+#include <QDir>
+#include <QSet>
+#include <QSettings>
+#include <QStandardPaths>
+#include <algorithm>
+
+namespace {
+constexpr int kRetainedQueries = 100000;
+}
 
 SearchHistory::SearchHistory(QObject *parent) 
-    : QObject(parent), m_maxSize(100) {
-    m_settings = new QSettings(this);
+    : QObject(parent), m_history(kRetainedQueries) {
+    const QString dataDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir().mkpath(dataDir);
+    m_log = new HistoryLog(dataDir + "/history.log", dataDir + "/history.store");
     loadHistory();
 }
 
+SearchHistory::~SearchHistory() {
+    delete m_log;
+}
+
 void SearchHistory::addSearch(const QString& query) {
-    if (query.trimmed().isEmpty()) return;
-    
-    QString trimmed = query.trimmed();
+    const QString trimmed = query.trimmed();
+    if (trimmed.isEmpty()) return;
     
-    // Remove existing occurrence
-    m_history.removeAll(trimmed);
-    
-    // Add to front
-    m_history.prepend(trimmed);
-    
-    // Limit size
-    if (m_history.size() > m_maxSize) {
-        m_history = m_history.mid(0, m_maxSize);
-    }
-    
-    saveHistory();
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    m_history.touch(trimmed, now);
+    m_log->append(trimmed, now);
 }
 
 QStringList SearchHistory::getRecentSearches(int count) const {
-    return m_history.mid(0, qMin(count, m_history.size()));
+    QStringList queries = m_history.recent(count);
+    if (queries.size() >= count || m_storeHidden) return queries;
+    // Older than anything searched since the store was written
+    QSet<QString> seen(queries.cbegin(), queries.cend());
+    for (const QString& query : m_store.recent(count)) {
+        if (queries.size() >= count) break;
+        if (!seen.contains(query)) queries.append(query);
+    }
+    return queries;
 }
 
 void SearchHistory::clearHistory() {
     m_history.clear();
-    saveHistory();
+    m_storeHidden = true;
+    m_log->appendClear(QDateTime::currentMSecsSinceEpoch());
 }
 
-QStringList SearchHistory::getSuggestions(const QString& prefix) const {
-    QStringList suggestions;
-    QString lowerPrefix = prefix.toLower();
-    
-    for (const QString& query : m_history) {
-        if (query.toLower().startsWith(lowerPrefix) && query != prefix) {
-            suggestions.append(query);
-            if (suggestions.size() >= 10) break;
+QStringList SearchHistory::getSuggestions(const QString& prefix, int limit) const {
+    if (limit <= 0) return {};
+    // Best of each tier, each re-ranked with the uses the other tier holds.
+    // A query outside both short lists is not considered, even if its uses
+    // split across the tiers would add up to more.
+    QVector<QPair<QString, double>> candidates = m_history.ranked(prefix, limit);
+    if (!m_storeHidden) {
+        QSet<QString> seen;
+        for (auto& candidate : candidates) {
+            candidate.second = FrecencyList::combineRanks(candidate.second, m_store.rankOf(candidate.first));
+            seen.insert(candidate.first);
+        }
+        for (auto stored : m_store.ranked(prefix, limit)) {
+            if (seen.contains(stored.first)) continue;
+            stored.second = FrecencyList::combineRanks(stored.second, m_history.rankOf(stored.first));
+            candidates.append(stored);
         }
     }
-    
+    std::stable_sort(candidates.begin(), candidates.end(), [](const auto& a, const auto& b) {
+        return a.second > b.second;
+    });
+
+    QStringList suggestions;
+    for (int i = 0; i < candidates.size() && suggestions.size() < limit; ++i) {
+        suggestions.append(candidates.at(i).first);
+    }
     return suggestions;
 }
 
 void SearchHistory::loadHistory() {
-    m_history = m_settings->value("search_history", QStringList()).toStringList();
+    importLegacySettings();
+    // Map the store, then replay what was logged since it was written; the
+    // last use of a query decides its position
+    for (const HistoryLog::Record& record : m_log->load(m_store)) {
+        if (record.count == 0) {
+            m_history.clear();
+            m_storeHidden = true;
+        } else {
+            m_history.touch(record.query, record.timestamp, quint32(record.count));
+        }
+    }
 }
 
-void SearchHistory::saveHistory() {
-    m_settings->setValue("search_history", m_history);
-    m_settings->sync();
+void SearchHistory::importLegacySettings() {
+    // Histories from before the log lived in QSettings, most recent first
+    QSettings settings;
+    if (!settings.contains("search_history")) return;
+    const QStringList legacy = settings.value("search_history").toStringList();
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    for (int i = legacy.size() - 1; i >= 0; --i) {
+        m_log->append(legacy.at(i), now - i);
+    }
+    // Replay reads the file, so the imported records must be on disk first
+    m_log->flush();
+    settings.remove("search_history");
 }
 
 #include "SearchHistory.moc"
@@ -0,0 +1,230 @@
+#include "ShardCoordinator.h"
+#include "BatchSearch.h"
+#include "ServeProtocol.h"
+#include <QElapsedTimer>
+#include <QFile>
+#include <algorithm>
+#include <cstring>
+
+#ifdef Q_OS_UNIX
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+ShardCoordinator::ShardCoordinator(const QStringList& shardSockets) {
+    for (const QString& socketPath : shardSockets) {
+        Shard shard;
+        shard.socketPath = socketPath;
+        m_shards.append(shard);
+    }
+}
+
+ShardCoordinator::~ShardCoordinator() {
+    for (Shard& shard : m_shards) disconnectShard(shard);
+}
+
+bool ShardCoordinator::connectShards() {
+    int connected = 0;
+    QStringList failed;
+    for (Shard& shard : m_shards) {
+        if (connectShard(shard)) ++connected;
+        else failed << shard.socketPath;
+    }
+    if (connected == 0) {
+        m_error = QString("no shard reachable: %1").arg(failed.join(", "));
+        return false;
+    }
+    return true;
+}
+
+QByteArray ShardCoordinator::answer(const QString& query, qint64 line, int* missingShards) {
+    int missing = 0;
+    const QVector<SearchResult> results = search(query, &missing);
+    if (missingShards) *missingShards = missing;
+
+    QByteArray json = "{\"line\":" + QByteArray::number(line) + ",\"query\":";
+    BatchSearch::appendJsonString(json, query);
+    json += ",\"results\":[";
+    for (int i = 0; i < results.size(); ++i) {
+        const SearchResult& result = results.at(i);
+        if (i > 0) json += ',';
+        json += "{\"title\":";
+        BatchSearch::appendJsonString(json, result.title);
+        json += ",\"url\":";
+        BatchSearch::appendJsonString(json, result.url.toString());
+        json += ",\"snippet\":";
+        BatchSearch::appendJsonString(json, QStringView(result.description).left(result.snippetLength));
+        json += ",\"score\":" + QByteArray::number(result.relevanceScore) + '}';
+    }
+    json += ']';
+    if (missing > 0) json += ",\"missing_shards\":" + QByteArray::number(missing);
+    json += '}';
+    return json;
+}
+
+#ifdef Q_OS_UNIX
+
+bool ShardCoordinator::connectShard(Shard& shard) {
+    const QByteArray path = QFile::encodeName(shard.socketPath);
+    sockaddr_un address{};
+    if (path.isEmpty() || size_t(path.size()) >= sizeof(address.sun_path)) return false;
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, path.constData(), size_t(path.size()));
+
+    shard.fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (shard.fd < 0) return false;
+    if (::connect(shard.fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        disconnectShard(shard);
+        return false;
+    }
+    // Connected: from here on only poll() decides when to read
+    ::fcntl(shard.fd, F_SETFL, ::fcntl(shard.fd, F_GETFL) | O_NONBLOCK);
+    shard.input.clear();
+    return true;
+}
+
+void ShardCoordinator::disconnectShard(Shard& shard) {
+    if (shard.fd >= 0) ::close(shard.fd);
+    shard.fd = -1;
+    shard.input.clear();
+}
+
+QVector<SearchResult> ShardCoordinator::search(const QString& query, int* missingShards) {
+    QVector<SearchResult> merged;
+    int missing = 0;
+    const QByteArray text = query.toUtf8().left(int(ServeProtocol::kMaxRequestLength - 8));
+    if (text.trimmed().isEmpty()) {
+        if (missingShards) *missingShards = 0;
+        return merged;
+    }
+
+    ServeProtocol::RequestHeader header{};
+    header.length = quint32(sizeof(header) - sizeof(quint32) + size_t(text.size()));
+    header.id = ++m_nextId;
+    header.op = ServeProtocol::Search;
+    header.limit = quint8(m_limit);
+    const QByteArray frame = QByteArray(reinterpret_cast<const char*>(&header), sizeof(header)) + text;
+
+    // Scatter
+    int pending = 0;
+    for (Shard& shard : m_shards) {
+        shard.answered = false;
+        // A shard that died is retried once per query
+        if (shard.fd < 0 && !connectShard(shard)) continue;
+        // Frames are tiny; the socket buffer takes them whole unless the shard is wedged
+        if (::send(shard.fd, frame.constData(), size_t(frame.size()), MSG_NOSIGNAL | MSG_DONTWAIT) != frame.size()) {
+            disconnectShard(shard);
+            continue;
+        }
+        ++pending;
+    }
+
+    // Gather until every shard answered or the timeout passed
+    QElapsedTimer timer;
+    timer.start();
+    QVector<pollfd> fds;
+    QVector<int> shardOfFd;
+    while (pending > 0) {
+        const int remaining = m_timeoutMs - int(timer.elapsed());
+        if (remaining <= 0) break;
+        fds.clear();
+        shardOfFd.clear();
+        for (int i = 0; i < m_shards.size(); ++i) {
+            if (m_shards.at(i).fd < 0 || m_shards.at(i).answered) continue;
+            fds.append({m_shards.at(i).fd, POLLIN, 0});
+            shardOfFd.append(i);
+        }
+        const int ready = ::poll(fds.data(), nfds_t(fds.size()), remaining);
+        if (ready < 0 && errno != EINTR) break;
+        for (int f = 0; f < fds.size(); ++f) {
+            if (!fds.at(f).revents) continue;
+            Shard& shard = m_shards[shardOfFd.at(f)];
+            if (!receive(shard, header.id, merged)) {
+                disconnectShard(shard);
+                --pending;
+            } else if (shard.answered) {
+                --pending;
+            }
+        }
+    }
+    for (Shard& shard : m_shards) {
+        if (shard.answered) continue;
+        ++missing;
+        if (shard.fd >= 0) ++shard.timeouts;
+    }
+
+    // Each shard sent its own top k in global order; keep the best k overall
+    std::stable_sort(merged.begin(), merged.end());
+    if (merged.size() > m_limit) merged.resize(m_limit);
+    if (missingShards) *missingShards = missing;
+    return merged;
+}
+
+bool ShardCoordinator::receive(Shard& shard, quint32 id, QVector<SearchResult>& out) {
+    char chunk[64 * 1024];
+    for (;;) {
+        const ssize_t received = ::read(shard.fd, chunk, sizeof(chunk));
+        if (received == 0) return false;
+        if (received < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            return false;
+        }
+        shard.input.append(chunk, int(received));
+    }
+
+    qsizetype consumed = 0;
+    const char* data = shard.input.constData();
+    while (shard.input.size() - consumed >= qsizetype(sizeof(ServeProtocol::ResponseHeader))) {
+        ServeProtocol::ResponseHeader response;
+        std::memcpy(&response, data + consumed, sizeof(response));
+        const qsizetype frameSize = qsizetype(sizeof(quint32)) + qsizetype(response.length);
+        if (shard.input.size() - consumed < frameSize) break;
+
+        // Responses to queries that already timed out are skipped
+        if (response.id == id && response.status == ServeProtocol::Ok) {
+            const char* hit = data + consumed + sizeof(response);
+            for (int i = 0; i < response.count; ++i) {
+                ServeProtocol::HitHeader hitHeader;
+                ServeProtocol::RecordHeader record;
+                std::memcpy(&hitHeader, hit, sizeof(hitHeader));
+                std::memcpy(&record, hit + sizeof(hitHeader), sizeof(record));
+                const char* text = hit + sizeof(hitHeader) + sizeof(record);
+                SearchResult result(QString::fromUtf8(text, record.titleLength),
+                                    QString::fromUtf8(text + record.titleLength + record.urlLength,
+                                                      qsizetype(record.answerLength)),
+                                    QUrl(QString::fromUtf8(text + record.titleLength, record.urlLength)));
+                result.relevanceScore = hitHeader.score / 1000.0;
+                result.sourceEngine = "Offline Database";
+                out.append(result);
+                hit += sizeof(hitHeader) + hitHeader.recordLength;
+            }
+        }
+        if (response.id == id) shard.answered = true;
+        consumed += frameSize;
+    }
+    shard.input.remove(0, consumed);
+    return true;
+}
+
+#else
+
+bool ShardCoordinator::connectShard(Shard&) {
+    m_error = "--shards needs Unix domain sockets";
+    return false;
+}
+
+void ShardCoordinator::disconnectShard(Shard&) {}
+
+QVector<SearchResult> ShardCoordinator::search(const QString&, int* missingShards) {
+    if (missingShards) *missingShards = int(m_shards.size());
+    return {};
+}
+
+bool ShardCoordinator::receive(Shard&, quint32, QVector<SearchResult>&) { return false; }
+
+#endif
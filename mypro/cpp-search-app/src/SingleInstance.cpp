@@ -0,0 +1,91 @@
+#include "SingleInstance.h"
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QDebug>
+
+namespace {
+const QByteArray kShowRequest = "show";
+const QByteArray kSearchRequest = "search ";
+const QByteArray kAck = "ok\n";
+}
+
+SingleInstance::SingleInstance(QObject *parent)
+    : QObject(parent)
+    , m_server(new QLocalServer(this))
+{
+    // Only the owning user may talk to the resident instance
+    m_server->setSocketOptions(QLocalServer::UserAccessOption);
+    connect(m_server, &QLocalServer::newConnection, this, &SingleInstance::onNewConnection);
+}
+
+QString SingleInstance::serverName() {
+    QString user = qEnvironmentVariable("USER");
+    if (user.isEmpty()) user = qEnvironmentVariable("USERNAME");
+    // The name itself, not a hash of it: qHash differs between Qt builds, and
+    // instances built against different Qt versions must still find each other
+    QString name;
+    for (const QChar c : user.left(64)) {
+        const bool safe = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')
+                          || c == '-' || c == '_';
+        name += safe ? c : QChar('_');
+    }
+    return QString("imilya-minds-%1").arg(name);
+}
+
+bool SingleInstance::listen() {
+    const QString name = serverName();
+    if (m_server->listen(name)) return true;
+
+    // A socket left behind by a crashed instance refuses connections
+    QLocalSocket probe;
+    probe.connectToServer(name);
+    if (probe.waitForConnected(100)) {
+        return false;
+    }
+    QLocalServer::removeServer(name);
+    if (!m_server->listen(name)) {
+        qWarning() << "SingleInstance: cannot listen on" << name << m_server->errorString();
+    }
+    // Either way this process carries on as a normal, full instance
+    return true;
+}
+
+bool SingleInstance::forward(const QString& query, int timeoutMs) {
+    QLocalSocket socket;
+    socket.connectToServer(serverName());
+    if (!socket.waitForConnected(timeoutMs)) return false;
+
+    QByteArray request = query.isEmpty() ? kShowRequest : kSearchRequest + query.simplified().toUtf8();
+    request += '\n';
+    socket.write(request);
+    if (!socket.waitForBytesWritten(timeoutMs)) return false;
+
+    while (!socket.canReadLine()) {
+        if (!socket.waitForReadyRead(timeoutMs)) return false;
+    }
+    return socket.readLine() == kAck;
+}
+
+void SingleInstance::onNewConnection() {
+    while (QLocalSocket* socket = m_server->nextPendingConnection()) {
+        connect(socket, &QLocalSocket::disconnected, socket, &QObject::deleteLater);
+        connect(socket, &QLocalSocket::readyRead, this, [this, socket]() {
+            if (!socket->canReadLine()) {
+                // Requests are a single short line; drop anything else
+                if (socket->bytesAvailable() > 4096) socket->abort();
+                return;
+            }
+            const QByteArray request = socket->readLine().trimmed();
+            // Acknowledge first so the launching process can exit right away
+            socket->write(kAck);
+            socket->flush();
+            socket->disconnectFromServer();
+
+            if (request.startsWith(kSearchRequest)) {
+                emit searchRequested(QString::fromUtf8(request.mid(kSearchRequest.size())));
+            } else if (request == kShowRequest) {
+                emit showRequested();
+            }
+        });
+    }
+}
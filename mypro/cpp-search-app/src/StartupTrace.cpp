@@ -0,0 +1,76 @@
+#include "StartupTrace.h"
+#include "Tracer.h"
+#include <QEvent>
+#include <QTimer>
+#include <QWidget>
+#include <QTextStream>
+#include <cstdio>
+
+StartupTrace* StartupTrace::instance() {
+    // Lives for the whole process; used before QApplication exists
+    static StartupTrace* trace = new StartupTrace;
+    return trace;
+}
+
+qint64 StartupTrace::elapsedNs() const {
+    // Same clock as --trace, so phases and spans line up
+    return Tracer::nowNs();
+}
+
+void StartupTrace::mark(const QString& phase) {
+    const qint64 now = elapsedNs();
+    Tracer::complete(phase, m_phases.isEmpty() ? 0 : m_phases.last().endNs, now);
+    m_phases.append({phase, now});
+}
+
+void StartupTrace::watch(QWidget* window) {
+    m_window = window;
+    window->installEventFilter(this);
+}
+
+bool StartupTrace::eventFilter(QObject* watched, QEvent* event) {
+    if (watched == m_window && event->type() == QEvent::Paint && !m_painted) {
+        m_painted = true;
+        m_window->removeEventFilter(this);
+        // The frame is on screen once the current repaint has been flushed
+        QTimer::singleShot(0, this, [this]() {
+            mark("first paint");
+            // ...and input is served once everything queued behind it has run
+            QTimer::singleShot(0, this, [this]() {
+                mark("first interactive");
+                m_interactiveNs = m_phases.last().endNs;
+                m_interactive = true;
+                // Deferred construction runs here and shows up after the milestone
+                emit interactive();
+                if (m_reportOnInteractive) {
+                    std::fputs(report().toLocal8Bit().constData(), stderr);
+                    std::fflush(stderr);
+                }
+            });
+        });
+    }
+    return QObject::eventFilter(watched, event);
+}
+
+QString StartupTrace::report() const {
+    QString text;
+    QTextStream out(&text);
+    out << "Startup trace (ms since process start)\n";
+    qint64 previous = 0;
+    for (const Phase& phase : m_phases) {
+        out << QString("  %1 %2 %3\n")
+                   .arg(phase.name, -24)
+                   .arg((phase.endNs - previous) / 1e6, 8, 'f', 2)
+                   .arg(phase.endNs / 1e6, 9, 'f', 2);
+        previous = phase.endNs;
+    }
+    if (m_interactive) {
+        const qint64 interactiveMs = m_interactiveNs / 1000000;
+        out << QString("  interactive in %1 ms (budget %2 ms, %3)\n")
+                   .arg(interactiveMs)
+                   .arg(kInteractiveBudgetMs)
+                   .arg(interactiveMs <= kInteractiveBudgetMs ? "ok" : "over budget");
+    }
+    out.flush();
+    return text;
+}
@@ -0,0 +1,98 @@
+#include "SuggestionEngine.h"
+#include "Metrics.h"
+#include "OfflineQADatabase.h"
+#include "SearchHistory.h"
+#include <QMetaObject>
+#include <QSet>
+#include <algorithm>
+
+namespace {
+// History entries are the user's own queries, so they outrank catalog matches
+constexpr double kHistoryBaseScore = 1.5;
+constexpr double kHistoryRecencyStep = 0.01;
+}
+
+SuggestionEngine::SuggestionEngine(OfflineQADatabase* database, SearchHistory* history, QObject *parent)
+    : QObject(parent)
+    , m_database(database)
+    , m_history(history)
+    , m_generation(0)
+    , m_maxSuggestions(10)
+{
+    // One worker is enough: newer passes supersede older ones anyway
+    m_pool.setMaxThreadCount(1);
+}
+
+SuggestionEngine::~SuggestionEngine() {
+    cancel();
+    m_pool.clear();
+    m_pool.waitForDone();
+}
+
+void SuggestionEngine::requestSuggestions(const QString& text) {
+    const quint64 generation = m_generation.fetchAndAddOrdered(1) + 1;
+    const QString query = text.trimmed();
+    if (query.isEmpty()) {
+        emit suggestionsReady(query, {});
+        return;
+    }
+
+    // History lives on the GUI thread and answers a prefix in one pass over
+    // its entries; only the database lookup goes to the worker
+    const int limit = m_maxSuggestions;
+    const QStringList historyCandidates = m_history ? m_history->getSuggestions(query, limit) : QStringList();
+
+    // Drop queued passes that never started; only the newest one matters
+    m_pool.clear();
+    m_pool.start([this, generation, query, historyCandidates, limit]() {
+        if (m_generation.loadAcquire() != generation) return;
+        static Metrics::Histogram& suggestTime = Metrics::instance()->histogram(
+            "suggestion_seconds", "Database lookup and merge for one suggestion pass");
+        Metrics::ScopedTimer timer(suggestTime);
+
+        QVector<QPair<QString, double>> databaseCandidates;
+        if (m_database) {
+            databaseCandidates = m_database->getScoredSuggestions(query, limit);
+        }
+        if (m_generation.loadAcquire() != generation) return;
+
+        const QStringList merged = mergeCandidates(databaseCandidates, historyCandidates, limit);
+        QMetaObject::invokeMethod(this, [this, generation, query, merged]() {
+            if (m_generation.loadAcquire() != generation) return;
+            emit suggestionsReady(query, merged);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void SuggestionEngine::cancel() {
+    m_generation.fetchAndAddOrdered(1);
+}
+
+QStringList SuggestionEngine::mergeCandidates(const QVector<QPair<QString, double>>& databaseCandidates,
+                                              const QStringList& historyCandidates,
+                                              int limit) {
+    QVector<QPair<QString, double>> scored;
+    scored.reserve(databaseCandidates.size() + historyCandidates.size());
+
+    for (int i = 0; i < historyCandidates.size(); ++i) {
+        scored.append({historyCandidates.at(i), kHistoryBaseScore - i * kHistoryRecencyStep});
+    }
+    scored += databaseCandidates;
+
+    // Stable sort keeps catalog order among equal scores
+    std::stable_sort(scored.begin(), scored.end(),
+                     [](const QPair<QString, double>& a, const QPair<QString, double>& b) {
+                         return a.second > b.second;
+                     });
+
+    QStringList result;
+    QSet<QString> seen;
+    for (const auto& candidate : scored) {
+        const QString key = candidate.first.toLower();
+        if (seen.contains(key)) continue;
+        seen.insert(key);
+        result.append(candidate.first);
+        if (result.size() >= limit) break;
+    }
+    return result;
+}
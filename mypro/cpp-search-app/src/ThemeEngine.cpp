@@ -0,0 +1,151 @@
+#include "ThemeEngine.h"
+#include <QApplication>
+#include <QStyleFactory>
+#include <QStyleOption>
+#include <QPainter>
+#include <QLinearGradient>
+
+ImilyaStyle::ImilyaStyle()
+    : QProxyStyle(QStyleFactory::create("Fusion"))
+{
+}
+
+void ImilyaStyle::drawPrimitive(PrimitiveElement element, const QStyleOption* option,
+                                QPainter* painter, const QWidget* widget) const {
+    switch (element) {
+    case PE_PanelButtonCommand: {
+        // Vertical accent gradient, lighter on hover and darker when pressed
+        const QColor accent = option->palette.color(QPalette::Button);
+        QColor top = accent;
+        QColor bottom = accent.darker(125);
+        if (!(option->state & State_Enabled)) {
+            top = bottom = option->palette.color(QPalette::Disabled, QPalette::Button);
+        } else if (option->state & (State_Sunken | State_On)) {
+            top = accent.darker(125);
+            bottom = accent.darker(150);
+        } else if (option->state & State_MouseOver) {
+            top = accent.lighter(110);
+            bottom = accent.darker(110);
+        }
+        QLinearGradient gradient(option->rect.topLeft(), option->rect.bottomLeft());
+        gradient.setColorAt(0, top);
+        gradient.setColorAt(1, bottom);
+
+        painter->save();
+        painter->setRenderHint(QPainter::Antialiasing);
+        painter->setPen(Qt::NoPen);
+        painter->setBrush(gradient);
+        painter->drawRoundedRect(QRectF(option->rect), 10, 10);
+        painter->restore();
+        return;
+    }
+    case PE_PanelLineEdit: {
+        // Rounded field with a 2px border that takes the accent on focus
+        const bool focused = option->state & State_HasFocus;
+        painter->save();
+        painter->setRenderHint(QPainter::Antialiasing);
+        painter->setPen(QPen(option->palette.color(focused ? QPalette::Highlight : QPalette::Mid), 2));
+        painter->setBrush(option->palette.brush(QPalette::Base));
+        painter->drawRoundedRect(QRectF(option->rect).adjusted(1, 1, -1, -1), 8, 8);
+        painter->restore();
+        return;
+    }
+    case PE_FrameFocusRect:
+        // Focus is shown by the line edit border instead
+        return;
+    default:
+        break;
+    }
+    QProxyStyle::drawPrimitive(element, option, painter, widget);
+}
+
+QSize ImilyaStyle::sizeFromContents(ContentsType type, const QStyleOption* option,
+                                    const QSize& size, const QWidget* widget) const {
+    QSize result = QProxyStyle::sizeFromContents(type, option, size, widget);
+    switch (type) {
+    case CT_PushButton:
+        // Matches the former "padding: 10px 18px" button look
+        return result + QSize(20, 8);
+    case CT_LineEdit:
+        return result + QSize(16, 8);
+    default:
+        return result;
+    }
+}
+
+ThemeEngine* ThemeEngine::instance() {
+    static ThemeEngine* engine = new ThemeEngine(qApp);
+    return engine;
+}
+
+ThemeEngine::ThemeEngine(QObject *parent)
+    : QObject(parent)
+    , m_installed(false)
+{
+    m_palettes.insert("Beast", buildBeastPalette());
+    m_palettes.insert("Best", buildBestPalette());
+}
+
+void ThemeEngine::install() {
+    if (m_installed) return;
+    m_installed = true;
+    QApplication::setStyle(new ImilyaStyle);
+}
+
+void ThemeEngine::applyTheme(const QString& name) {
+    auto it = m_palettes.constFind(name);
+    if (it == m_palettes.constEnd() || name == m_current) return;
+    m_current = name;
+    // One palette swap: widgets repaint with the new roles, nothing is re-polished
+    QApplication::setPalette(it.value());
+    emit themeChanged(name);
+}
+
+QPalette ThemeEngine::buildBeastPalette() {
+    QLinearGradient background(0, 0, 0, 1);
+    background.setCoordinateMode(QGradient::ObjectBoundingMode);
+    background.setColorAt(0, QColor(0x1a, 0x1a, 0x1a));
+    background.setColorAt(1, QColor(0x0a, 0x0a, 0x0a));
+
+    QPalette palette;
+    palette.setBrush(QPalette::Window, background);
+    palette.setColor(QPalette::WindowText, QColor(0xcc, 0xcc, 0xcc));
+    palette.setColor(QPalette::Base, QColor(0x2a, 0x2a, 0x2a));
+    palette.setColor(QPalette::AlternateBase, QColor(0x14, 0x14, 0x14));
+    palette.setColor(QPalette::ToolTipBase, QColor(0x2a, 0x2a, 0x2a));
+    palette.setColor(QPalette::ToolTipText, Qt::white);
+    palette.setColor(QPalette::PlaceholderText, QColor(0x88, 0x88, 0x88));
+    palette.setColor(QPalette::Text, Qt::white);
+    palette.setColor(QPalette::Button, QColor(0x00, 0xd4, 0xff));
+    palette.setColor(QPalette::ButtonText, Qt::white);
+    palette.setColor(QPalette::BrightText, QColor(0x00, 0xff, 0xff));
+    palette.setColor(QPalette::Mid, QColor(0x33, 0x33, 0x33));
+    palette.setColor(QPalette::Link, QColor(0x00, 0xd4, 0xff));
+    palette.setColor(QPalette::Highlight, QColor(0x00, 0xd4, 0xff));
+    palette.setColor(QPalette::HighlightedText, Qt::black);
+    palette.setColor(QPalette::Disabled, QPalette::Button, QColor(0x55, 0x55, 0x55));
+    palette.setColor(QPalette::Disabled, QPalette::ButtonText, QColor(0x88, 0x88, 0x88));
+    return palette;
+}
+
+QPalette ThemeEngine::buildBestPalette() {
+    QPalette palette;
+    palette.setColor(QPalette::Window, QColor(0xf6, 0xf7, 0xfb));
+    palette.setColor(QPalette::WindowText, QColor(0x33, 0x33, 0x33));
+    palette.setColor(QPalette::Base, Qt::white);
+    palette.setColor(QPalette::AlternateBase, Qt::white);
+    palette.setColor(QPalette::ToolTipBase, Qt::white);
+    palette.setColor(QPalette::ToolTipText, QColor(0x11, 0x11, 0x11));
+    palette.setColor(QPalette::PlaceholderText, QColor(0x8c, 0x96, 0xa8));
+    palette.setColor(QPalette::Text, QColor(0x11, 0x11, 0x11));
+    palette.setColor(QPalette::Button, QColor(0x4a, 0x90, 0xe2));
+    palette.setColor(QPalette::ButtonText, Qt::white);
+    palette.setColor(QPalette::BrightText, QColor(0x35, 0x7a, 0xb8));
+    palette.setColor(QPalette::Mid, QColor(0xe1, 0xe4, 0xea));
+    palette.setColor(QPalette::Link, QColor(0x4a, 0x90, 0xe2));
+    palette.setColor(QPalette::Highlight, QColor(0x4a, 0x90, 0xe2));
+    palette.setColor(QPalette::HighlightedText, Qt::white);
+    palette.setColor(QPalette::Disabled, QPalette::Button, QColor(0xc9, 0xce, 0xd8));
+    palette.setColor(QPalette::Disabled, QPalette::ButtonText, QColor(0x8c, 0x96, 0xa8));
+    return palette;
+}
@@ -0,0 +1,169 @@
+#include "Tracer.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QVector>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+std::atomic<bool> Tracer::s_enabled{false};
+
+namespace {
+// Started by static initialization so the trace also covers pre-main work
+const QElapsedTimer s_processClock = []() {
+    QElapsedTimer clock;
+    clock.start();
+    return clock;
+}();
+
+struct Event {
+    const char* name;
+    QByteArray ownedName;   // for names built at run time; empty otherwise
+    qint64 startNs;
+    qint64 endNs;
+};
+
+struct ThreadBuffer {
+    int tid;
+    QString threadName;
+    QMutex mutex;           // uncontended except while the file is written
+    QVector<Event> events;
+};
+
+struct Registry {
+    QMutex mutex;
+    QString filePath;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;  // outlive their threads
+};
+
+Registry& registry() {
+    static Registry* instance = new Registry;
+    return *instance;
+}
+
+ThreadBuffer& threadBuffer() {
+    thread_local ThreadBuffer* buffer = nullptr;
+    if (!buffer) {
+        Registry& reg = registry();
+        QMutexLocker locker(&reg.mutex);
+        auto owned = std::make_unique<ThreadBuffer>();
+        owned->tid = int(reg.buffers.size()) + 1;
+        const QString objectName = QThread::currentThread()->objectName();
+        owned->threadName = objectName.isEmpty() ? QString("thread %1").arg(owned->tid) : objectName;
+        owned->events.reserve(1024);
+        buffer = owned.get();
+        reg.buffers.push_back(std::move(owned));
+    }
+    return *buffer;
+}
+
+void appendEscaped(QByteArray& out, const QByteArray& text) {
+    out += '"';
+    for (const char c : text) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (uchar(c) < 0x20) {
+            out += ' ';
+        } else {
+            out += c;
+        }
+    }
+    out += '"';
+}
+
+void appendMicros(QByteArray& out, qint64 nanos) {
+    out += QByteArray::number(double(nanos) / 1000.0, 'f', 3);
+}
+}
+
+qint64 Tracer::nowNs() {
+    return s_processClock.nsecsElapsed();
+}
+
+void Tracer::complete(const char* name, qint64 startNs, qint64 endNs) {
+    if (!isEnabled()) return;
+    ThreadBuffer& buffer = threadBuffer();
+    QMutexLocker locker(&buffer.mutex);
+    buffer.events.append({name, QByteArray(), startNs, endNs});
+}
+
+void Tracer::complete(const QString& name, qint64 startNs, qint64 endNs) {
+    if (!isEnabled()) return;
+    ThreadBuffer& buffer = threadBuffer();
+    QMutexLocker locker(&buffer.mutex);
+    buffer.events.append({nullptr, name.toUtf8(), startNs, endNs});
+}
+
+void Tracer::start(const QString& filePath) {
+    Registry& reg = registry();
+    {
+        QMutexLocker locker(&reg.mutex);
+        reg.filePath = filePath;
+    }
+    // The thread that starts the trace is the one running main()
+    threadBuffer().threadName = "main";
+    s_enabled.store(true, std::memory_order_relaxed);
+}
+
+bool Tracer::finish() {
+    if (!isEnabled()) return false;
+    s_enabled.store(false, std::memory_order_relaxed);
+
+    Registry& reg = registry();
+    QMutexLocker locker(&reg.mutex);
+    const QByteArray pid = QByteArray::number(QCoreApplication::applicationPid());
+    QByteArray out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    auto separate = [&]() {
+        if (!first) out += ",\n";
+        first = false;
+    };
+    for (const auto& buffer : reg.buffers) {
+        QMutexLocker bufferLocker(&buffer->mutex);
+        const QByteArray tid = QByteArray::number(buffer->tid);
+        separate();
+        out += "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":" + pid + ",\"tid\":" + tid + ",\"args\":{\"name\":";
+        appendEscaped(out, buffer->threadName.toUtf8());
+        out += "}}";
+        for (const Event& event : buffer->events) {
+            separate();
+            out += "{\"ph\":\"X\",\"name\":";
+            appendEscaped(out, event.name ? QByteArray(event.name) : event.ownedName);
+            out += ",\"pid\":" + pid + ",\"tid\":" + tid + ",\"ts\":";
+            appendMicros(out, event.startNs);
+            out += ",\"dur\":";
+            appendMicros(out, event.endNs - event.startNs);
+            out += '}';
+        }
+        buffer->events.clear();
+    }
+    out += "\n]}\n";
+
+    QFile file(reg.filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(out) != out.size()) {
+        std::fprintf(stderr, "cannot write trace to %s\n", qPrintable(reg.filePath));
+        return false;
+    }
+    return true;
+}
+
+QString Tracer::fileFromArguments(int argc, char* argv[]) {
+    for (int i = 1; i < argc; ++i) {
+        if (qstrncmp(argv[i], "--trace=", 8) == 0) return QString::fromLocal8Bit(argv[i] + 8);
+        if (qstrcmp(argv[i], "--trace") == 0 && i + 1 < argc) return QString::fromLocal8Bit(argv[i + 1]);
+    }
+    return QString();
+}
+
+TraceSession::TraceSession(const QString& filePath) {
+    if (!filePath.isEmpty()) Tracer::start(filePath);
+}
+
+TraceSession::~TraceSession() {
+    Tracer::finish();
+}
@@ -0,0 +1,202 @@
+#include "UiProfiler.h"
+#include <QWidget>
+#include <QWindow>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+#include <algorithm>
+
+UiProfiler* UiProfiler::s_active = nullptr;
+
+UiProfiler* UiProfiler::instance() {
+    static UiProfiler* profiler = new UiProfiler(qApp);
+    return profiler;
+}
+
+UiProfiler::UiProfiler(QObject *parent)
+    : QObject(parent)
+    , m_frameStart(-1)
+    , m_lastFrameEnd(-1)
+    , m_pendingKeyPress(-1)
+    , m_registryFrameTimes(Metrics::instance()->histogram(
+          "ui_frame_seconds", "Top-level repaint time, while the UI profiler is on"))
+    , m_registryInputLatency(Metrics::instance()->histogram(
+          "ui_key_to_paint_seconds", "Key press to the next completed repaint, while the UI profiler is on"))
+{
+    m_clock.start();
+}
+
+void UiProfiler::setEnabled(bool enabled) {
+    if (enabled) {
+        s_active = this;
+    } else if (s_active == this) {
+        s_active = nullptr;
+        m_paintStack.clear();
+        m_frameStart = -1;
+        m_pendingKeyPress = -1;
+    }
+}
+
+void UiProfiler::reset() {
+    m_frameTimes = Metrics::Histogram();
+    m_frameIntervals = Metrics::Histogram();
+    m_inputLatency = Metrics::Histogram();
+    m_widgetCosts.clear();
+    m_lastFrameEnd = -1;
+    m_pendingKeyPress = -1;
+}
+
+static bool isFrameRequest(QObject* receiver, QEvent* event) {
+    if (event->type() != QEvent::UpdateRequest) return false;
+    if (receiver->isWindowType()) return true;
+    return receiver->isWidgetType() && static_cast<QWidget*>(receiver)->isWindow();
+}
+
+void UiProfiler::beginEvent(QObject* receiver, QEvent* event) {
+    const qint64 now = m_clock.nsecsElapsed();
+    switch (event->type()) {
+    case QEvent::KeyPress:
+        // Latency is measured from the first unanswered keystroke
+        if (m_pendingKeyPress < 0) m_pendingKeyPress = now;
+        break;
+    case QEvent::Paint:
+        m_paintStack.append({now, 0});
+        break;
+    case QEvent::UpdateRequest:
+        // Only the outermost request is a frame (window and widget may both see it)
+        if (isFrameRequest(receiver, event) && m_frameStart < 0) m_frameStart = now;
+        break;
+    default:
+        break;
+    }
+}
+
+void UiProfiler::endEvent(QObject* receiver, QEvent* event) {
+    const qint64 now = m_clock.nsecsElapsed();
+    switch (event->type()) {
+    case QEvent::Paint: {
+        if (m_paintStack.isEmpty()) break;
+        const OpenPaint open = m_paintStack.takeLast();
+        const qint64 inclusive = now - open.start;
+        if (!m_paintStack.isEmpty()) m_paintStack.last().childTime += inclusive;
+
+        QString name = QString::fromLatin1(receiver->metaObject()->className());
+        if (!receiver->objectName().isEmpty()) name += '#' + receiver->objectName();
+        WidgetCost& cost = m_widgetCosts[name];
+        cost.name = name;
+        cost.histogram.record(inclusive - open.childTime);
+        break;
+    }
+    case QEvent::UpdateRequest: {
+        if (!isFrameRequest(receiver, event) || m_frameStart < 0 || !m_paintStack.isEmpty()) break;
+        m_frameTimes.record(now - m_frameStart);
+        m_registryFrameTimes.record(now - m_frameStart);
+        if (m_lastFrameEnd >= 0) m_frameIntervals.record(now - m_lastFrameEnd);
+        if (m_pendingKeyPress >= 0) {
+            m_inputLatency.record(now - m_pendingKeyPress);
+            m_registryInputLatency.record(now - m_pendingKeyPress);
+            m_pendingKeyPress = -1;
+        }
+        m_lastFrameEnd = now;
+        m_frameStart = -1;
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+QVector<const UiProfiler::WidgetCost*> UiProfiler::widgetCostsByTotal() const {
+    QVector<const WidgetCost*> costs;
+    costs.reserve(m_widgetCosts.size());
+    for (const WidgetCost& cost : m_widgetCosts) {
+        costs.append(&cost);
+    }
+    std::sort(costs.begin(), costs.end(), [](const WidgetCost* a, const WidgetCost* b) {
+        return a->histogram.totalNs() > b->histogram.totalNs();
+    });
+    return costs;
+}
+
+static QJsonObject histogramToJson(const Metrics::Histogram& histogram) {
+    QJsonObject object;
+    object["count"] = double(histogram.count());
+    object["mean_us"] = histogram.meanNs() / 1000.0;
+    object["p50_us"] = histogram.percentileNs(50) / 1000.0;
+    object["p90_us"] = histogram.percentileNs(90) / 1000.0;
+    object["p99_us"] = histogram.percentileNs(99) / 1000.0;
+    object["max_us"] = histogram.maxNs() / 1000.0;
+
+    QJsonArray buckets;
+    for (int i = 0; i < Metrics::Histogram::kBuckets; ++i) {
+        if (histogram.bucketCount(i) == 0) continue;
+        QJsonObject bucket;
+        bucket["le_us"] = Metrics::Histogram::bucketUpperBound(i) / 1000.0;
+        bucket["count"] = double(histogram.bucketCount(i));
+        buckets.append(bucket);
+    }
+    object["buckets"] = buckets;
+    return object;
+}
+
+QByteArray UiProfiler::exportJson() const {
+    QJsonObject root;
+    root["frame_time"] = histogramToJson(m_frameTimes);
+    root["frame_interval"] = histogramToJson(m_frameIntervals);
+    root["key_to_paint"] = histogramToJson(m_inputLatency);
+
+    QJsonObject widgets;
+    for (const WidgetCost* cost : widgetCostsByTotal()) {
+        widgets[cost->name] = histogramToJson(cost->histogram);
+    }
+    root["paint_cost"] = widgets;
+    return QJsonDocument(root).toJson(QJsonDocument::Indented);
+}
+
+QByteArray UiProfiler::exportCsv() const {
+    QByteArray csv;
+    QTextStream out(&csv);
+    out << "metric,le_us,count\n";
+    auto writeHistogram = [&out](const QString& metric, const Metrics::Histogram& histogram) {
+        for (int i = 0; i < Metrics::Histogram::kBuckets; ++i) {
+            if (histogram.bucketCount(i) == 0) continue;
+            out << metric << ',' << Metrics::Histogram::bucketUpperBound(i) / 1000.0 << ','
+                << histogram.bucketCount(i) << '\n';
+        }
+    };
+    writeHistogram("frame_time", m_frameTimes);
+    writeHistogram("frame_interval", m_frameIntervals);
+    writeHistogram("key_to_paint", m_inputLatency);
+    for (const WidgetCost* cost : widgetCostsByTotal()) {
+        writeHistogram("paint:" + cost->name, cost->histogram);
+    }
+    out.flush();
+    return csv;
+}
+
+bool UiProfiler::exportToFile(const QString& filePath) const {
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+    const bool csv = filePath.endsWith(".csv", Qt::CaseInsensitive);
+    return file.write(csv ? exportCsv() : exportJson()) >= 0;
+}
+
+bool ImilyaApplication::notify(QObject* receiver, QEvent* event) {
+    UiProfiler* profiler = UiProfiler::active();
+    if (!profiler) return QApplication::notify(receiver, event);
+
+    const QEvent::Type type = event->type();
+    if (type != QEvent::Paint && type != QEvent::UpdateRequest && type != QEvent::KeyPress) {
+        return QApplication::notify(receiver, event);
+    }
+    if (receiver->thread() != thread()) {
+        return QApplication::notify(receiver, event);
+    }
+
+    profiler->beginEvent(receiver, event);
+    const bool handled = QApplication::notify(receiver, event);
+    profiler->endEvent(receiver, event);
+    return handled;
+}
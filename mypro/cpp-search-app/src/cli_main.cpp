@@ -0,0 +1,10 @@
+#include "HeadlessCli.h"
+#include "Tracer.h"
+
+// Headless front end linked only against imilya_core (QtCore), so it never
+// loads QtWidgets. Same as running CPPSearchApp --no-gui.
+int main(int argc, char *argv[]) {
+    // --trace=<file>, written as main() returns (as in CPPSearchApp)
+    const TraceSession traceSession(Tracer::fileFromArguments(argc, argv));
+    return HeadlessCli::run(argc, argv);
+}
@@ -1,5 +1,4 @@
 #include <QApplication>
-#include <QStyleFactory>
 #include <QDir>
 #include <QStandardPaths>
 #include <QCommandLineParser>
@@ -8,27 +7,27 @@
 #include <QFontDatabase>
 
 #include "MainWindow.h"
+#include "ThemeEngine.h"
+#include "UiProfiler.h"
+#include "StartupTrace.h"
+#include "SingleInstance.h"
+#include "HeadlessCli.h"
+#include "Tracer.h"
 
 void setupApplicationStyle() {
-    // Set a modern dark theme
-    qApp->setStyle(QStyleFactory::create("Fusion"));
-    
-    QPalette darkPalette;
-    darkPalette.setColor(QPalette::Window, QColor(26, 26, 26));
-    darkPalette.setColor(QPalette::WindowText, Qt::white);
-    darkPalette.setColor(QPalette::Base, QColor(10, 10, 10));
-    darkPalette.setColor(QPalette::AlternateBase, QColor(42, 42, 42));
-    darkPalette.setColor(QPalette::ToolTipBase, QColor(42, 42, 42));
-    darkPalette.setColor(QPalette::ToolTipText, Qt::white);
-    darkPalette.setColor(QPalette::Text, Qt::white);
-    darkPalette.setColor(QPalette::Button, QColor(0, 212, 255));
-    darkPalette.setColor(QPalette::ButtonText, Qt::black);
-    darkPalette.setColor(QPalette::BrightText, QColor(0, 255, 255));
-    darkPalette.setColor(QPalette::Link, QColor(0, 212, 255));
-    darkPalette.setColor(QPalette::Highlight, QColor(0, 212, 255));
-    darkPalette.setColor(QPalette::HighlightedText, Qt::black);
-    
-    qApp->setPalette(darkPalette);
+    // Palette-driven style and prebuilt themes; MainWindow switches between them
+    ThemeEngine::instance()->install();
+    ThemeEngine::instance()->applyTheme("Beast");
+}
+
+void loadApplicationFonts() {
+    // Load custom fonts if available
+    QString fontDir = QApplication::applicationDirPath() + "/resources/fonts/";
+    if (QDir(fontDir).exists()) {
+        QFontDatabase::addApplicationFont(fontDir + "OpenSans-Regular.ttf");
+        QFontDatabase::addApplicationFont(fontDir + "OpenSans-Bold.ttf");
+        QApplication::setFont(QFont("Open Sans", 10));
+    }
 }
 
 void ensureDataDirectory() {
@@ -39,8 +38,51 @@ void ensureDataDirectory() {
     }
 }
 
+// Hands a plain launch (optionally with -s <query>) to the resident instance.
+// Runs before QApplication exists so forwarding never pays for GUI start-up.
+bool forwardToResidentInstance(int argc, char *argv[]) {
+    QString query;
+    for (int i = 1; i < argc; ++i) {
+        const QString arg = QString::fromLocal8Bit(argv[i]);
+        if ((arg == "-s" || arg == "--search") && i + 1 < argc) {
+            query = QString::fromLocal8Bit(argv[++i]);
+        } else if (arg.startsWith("--search=")) {
+            query = arg.mid(int(qstrlen("--search=")));
+        } else if ((arg == "-e" || arg == "--engine") && i + 1 < argc) {
+            ++i; // offline-only: the engine is ignored
+        } else {
+            // Any other option (--help, --no-gui, --new-instance, profiling...) needs this process
+            return false;
+        }
+    }
+    QCoreApplication probe(argc, argv);
+    return SingleInstance::forward(query);
+}
+
 int main(int argc, char *argv[]) {
-    QApplication app(argc, argv);
+    // --trace=<file>: Chrome trace of the whole run, headless or not, written as main() returns
+    const TraceSession traceSession(Tracer::fileFromArguments(argc, argv));
+    StartupTrace* trace = StartupTrace::instance();
+    trace->mark("pre-main");
+    
+    // Headless runs never construct a QApplication (or need a display)
+    for (int i = 1; i < argc; ++i) {
+        for (const char* mode : {"--no-gui", "--serve", "--http", "--shard", "--shards"}) {
+            const uint length = qstrlen(mode);
+            if (qstrncmp(argv[i], mode, length) == 0 && (argv[i][length] == '\0' || argv[i][length] == '=')) {
+                return HeadlessCli::run(argc, argv);
+            }
+        }
+    }
+    
+    if (forwardToResidentInstance(argc, argv)) {
+        return 0;
+    }
+    trace->mark("instance check");
+    
+    // Routes paint/key events through UiProfiler when profiling is on
+    ImilyaApplication app(argc, argv);
+    trace->mark("QApplication");
     
     // Set application properties
     app.setApplicationName("Imilya Minds");
@@ -56,7 +98,7 @@ int main(int argc, char *argv[]) {
     parser.addVersionOption();
     
     QCommandLineOption searchOption(QStringList() << "s" << "search",
-                                   "Perform search and exit", "query");
+                                   "Search for query on startup (with --no-gui: print JSON results and exit)", "query");
     parser.addOption(searchOption);
     
     QCommandLineOption engineOption(QStringList() << "e" << "engine", 
@@ -64,40 +106,47 @@ int main(int argc, char *argv[]) {
     parser.addOption(engineOption);
     
     QCommandLineOption noGuiOption(QStringList() << "no-gui",
-                                  "Run without GUI (command line only)");
+                                  "Answer queries from stdin as JSON Lines without a GUI (see --no-gui --help)");
     parser.addOption(noGuiOption);
     
+    QCommandLineOption profileUiOption(QStringList() << "profile-ui",
+                                      "Show the frame-time and input-latency profiler overlay");
+    parser.addOption(profileUiOption);
+    
+    QCommandLineOption profileUiOutOption(QStringList() << "profile-ui-out",
+                                         "Write UI profiler histograms (JSON, or CSV by extension) on exit", "file");
+    parser.addOption(profileUiOutOption);
+    
+    QCommandLineOption startupProfileOption(QStringList() << "startup-profile",
+                                           "Print time spent per startup phase up to an interactive window");
+    parser.addOption(startupProfileOption);
+    
+    // Handled before the parser runs (see TraceSession above)
+    QCommandLineOption traceOption(QStringList() << "trace",
+                                  "Write a Chrome trace (chrome://tracing, ui.perfetto.dev) of startup and searches", "file");
+    parser.addOption(traceOption);
+    
+    QCommandLineOption trayOption(QStringList() << "tray",
+                                 "Start hidden in the system tray, ready for later launches");
+    parser.addOption(trayOption);
+    
+    QCommandLineOption newInstanceOption(QStringList() << "new-instance",
+                                        "Do not hand over to or act as the resident instance");
+    parser.addOption(newInstanceOption);
+    
     parser.process(app);
+    trace->setReportOnInteractive(parser.isSet(startupProfileOption));
     
     // Ensure data directory exists
     ensureDataDirectory();
     
-    // Handle command line search
-    if (parser.isSet(searchOption)) {
-        QString query = parser.value(searchOption);
-        QString engine = parser.value(engineOption);
-        
-        // TODO: Implement command line search
-        qDebug() << "Command line search:" << query << "using" << engine;
-        
-        if (parser.isSet(noGuiOption)) {
-            return 0; // Exit after search
-        }
-    }
-    
     // Setup application style
     setupApplicationStyle();
-    
-    // Load custom fonts if available
-    QString fontDir = QApplication::applicationDirPath() + "/resources/fonts/";
-    if (QDir(fontDir).exists()) {
-        QFontDatabase::addApplicationFont(fontDir + "OpenSans-Regular.ttf");
-        QFontDatabase::addApplicationFont(fontDir + "OpenSans-Bold.ttf");
-        app.setFont(QFont("Open Sans", 10));
-    }
+    trace->mark("style");
     
     // Create and show main window
     MainWindow window;
+    trace->mark("MainWindow");
     
     // Center window on screen
     QScreen *screen = QGuiApplication::primaryScreen();
@@ -108,14 +157,47 @@ int main(int argc, char *argv[]) {
         window.move(x, y);
     }
     
-    window.show();
+    // Custom fonts are a nicety; registering them is kept off the first frame
+    QObject::connect(trace, &StartupTrace::interactive, &app, [trace]() {
+        loadApplicationFonts();
+        trace->mark("deferred: fonts");
+    });
+    trace->watch(&window);
+    
+    // The first instance stays resident in the tray and serves later launches
+    SingleInstance instance;
+    const bool resident = !parser.isSet(newInstanceOption) && instance.listen();
+    if (resident) {
+        QObject::connect(&instance, &SingleInstance::showRequested, &window, &MainWindow::showAndActivate);
+        QObject::connect(&instance, &SingleInstance::searchRequested, &window, &MainWindow::runSearch);
+        app.setQuitOnLastWindowClosed(false);
+    } else {
+        window.setResident(false);
+    }
+    
+    if (resident && parser.isSet(trayOption)) {
+        window.setResident(true);
+    } else {
+        window.show();
+    }
+    trace->mark("show");
+    
+    if (parser.isSet(profileUiOption)) {
+        window.setProfilerOverlayVisible(true);
+    } else if (parser.isSet(profileUiOutOption)) {
+        // Collect without showing the overlay
+        UiProfiler::instance()->setEnabled(true);
+    }
     
     // If search query was provided, perform it in the GUI
     if (parser.isSet(searchOption)) {
-        // TODO: Trigger search in the main window
-        QString query = parser.value(searchOption);
-        // window.performSearch(query);
+        window.runSearch(parser.value(searchOption));
     }
     
-    return app.exec();
+    const int exitCode = app.exec();
+    
+    if (parser.isSet(profileUiOutOption)) {
+        UiProfiler::instance()->exportToFile(parser.value(profileUiOutOption));
+    }
+    return exitCode;
 }